@@ -18,15 +18,36 @@
     - adding new line for log message if user forget. 
     - different level of logging available for user.
     - available to add timestamp and thread id into logs.
-    - for fatal level problems the backtrace will be save. Use flag -rdynamic to compilation to get full backtrace.
+    - for fatal level problems the backtrace will be save. Use flag -rdynamic to compilation to get full backtrace
+      or save raw addresses and resolve them offline by dlogger_symbolize.
     - functionlike macro for logging could be use in the same way like any printf.
     - turn off all (with/without FATAL) log functionslike macros for release version.
+    - change level and additional options in run-time without restart (API, signals or watched configuration file).
+    - enable or disable logging per call-site (file, function) in run-time.
+    - long messages of any length (in chunks of record arena) and logging of raw buffers without intermediate copy.
+    - suppression of repeated messages (e.g. from retry loops) per descriptor.
+    - asynchronous logging by writer thread with configurable policy for full queue.
+    - low-latency wake-up, batching and CPU/NUMA placement of writer thread.
+    - scoped trace spans written as records or as Chrome/Perfetto trace file.
+    - aggregated metrics (counter, gauge, histogram) written periodically instead of per-event records.
+    - per-thread log files merged by timestamps with dlogger_merge.
+    - torn-write-resistant framed log files with CRC32C, validated and recovered by dlogger_verify.
+    - configurable durability: fdatasync of critical records or group commit, FATAL waits until it is on disk.
+    - fork-safe logging and multi-process mode: forked processes publish records into shared ring, parent writes them.
+    - header-only C++17 front-end (dlogger.hpp): format checked at compile time, std::string_view and any integers.
+    - allocation-free hot path: long records use chunks of arena preallocated by dlogger_create, FATAL backtraces own stack buffer.
+    - arguments of records disabled by level or call-site are not evaluated, disabled record costs one branch.
 */
 
 
 #include "dlogger_priv.h"
 
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
 /*
  * Available levels of logging in DLogger library. Remember that logging level set in constuctor will save only these messages which level 
  * is smaller or equal (all level <= level set in constructor).
@@ -85,15 +106,98 @@
  * DLOGGER_OPTION_MARK_TIMESTAMP - save for each log timestamp which contain hourse, minuts, seconds and microseconds.
  *
  * DLOGGER_OPTION_MARK_THREADID  - save for each log thread id. Very useful information for multi-thread code.
+ *
+ * DLOGGER_OPTION_MARK_RAW_BACKTRACE - save for fatal level only raw return addresses instead of symbols. Symbol lookup
+ *                                     is not done in application, so -rdynamic is not needed. Load addresses and build IDs
+ *                                     of modules are saved once, then tool dlogger_symbolize resolves addresses offline.
+ *
+ * DLOGGER_OPTION_MARK_SUPPRESS_REPEATED - identical consecutive messages from the same call-site are not written.
+ *                                         Instead of them record "last message repeated N times" is written when
+ *                                         other message comes, every few seconds during long series and in dlogger_destroy.
+ *                                         Writer thread of asynchronous logging and metrics reporter write it also when
+ *                                         series ends without next record. Fatal level is never suppressed.
+ *
+ * DLOGGER_OPTION_MARK_PER_THREAD_FILE   - only for DLOGGER_OPTION_WRITE_TO_FILE. Each thread writes records into own
+ *                                         file <unique file name>.<thread id>.log, so threads do not share file offset.
+ *                                         Unique file keeps only list of modules and records of threads whose file
+ *                                         could not be opened or which started when all 1024 preallocated files of
+ *                                         threads were used. Files are merged by timestamps with tool dlogger_merge.
+ *
+ * DLOGGER_OPTION_MARK_FRAMED            - only for DLOGGER_OPTION_WRITE_TO_FILE. Each record is written as frame with length,
+ *                                         sequence number and CRC32C (see dlogger_frame.h), so half-written records after
+ *                                         crash are detected and skipped. Use dlogger_verify to validate files or to print
+ *                                         records as text for other tools. Format of file is chosen in dlogger_create,
+ *                                         changes of this mark in run-time are ignored.
+ */
+#define DLOGGER_OPTION_MARK_TIMESTAMP         DLOGGER_PRIV_OPTION_MARK_TIMESTAMP
+#define DLOGGER_OPTION_MARK_THREADID          DLOGGER_PRIV_OPTION_MARK_THREADID
+#define DLOGGER_OPTION_MARK_RAW_BACKTRACE     DLOGGER_PRIV_OPTION_MARK_RAW_BACKTRACE
+#define DLOGGER_OPTION_MARK_SUPPRESS_REPEATED DLOGGER_PRIV_OPTION_MARK_SUPPRESS_REPEATED
+#define DLOGGER_OPTION_MARK_PER_THREAD_FILE   DLOGGER_PRIV_OPTION_MARK_PER_THREAD_FILE
+#define DLOGGER_OPTION_MARK_FRAMED            DLOGGER_PRIV_OPTION_MARK_FRAMED
+
+
+/*
+ * Available policies for full queue of asynchronous logging. FATAL and CRITICAL records are never dropped,
+ * when there is no space for them producer waits for writer thread. Dropped records are counted per level
+ * and notice "N messages dropped" is written periodically.
+ *
+ * DLOGGER_BACKPRESSURE_BLOCK            - producer waits until writer thread releases space in queue.
+ *
+ * DLOGGER_BACKPRESSURE_DROP_NEW         - new record is dropped.
+ *
+ * DLOGGER_BACKPRESSURE_DROP_BY_PRIORITY - queued records with less important level (DEBUG first) are dropped to make
+ *                                         space for new record. If there are no such records, new record is dropped.
+ *
+ * DLOGGER_BACKPRESSURE_OVERWRITE_OLDEST - the oldest queued records are dropped to make space for new record.
+ */
+#define DLOGGER_BACKPRESSURE_BLOCK            DLOGGER_PRIV_BACKPRESSURE_BLOCK
+#define DLOGGER_BACKPRESSURE_DROP_NEW         DLOGGER_PRIV_BACKPRESSURE_DROP_NEW
+#define DLOGGER_BACKPRESSURE_DROP_BY_PRIORITY DLOGGER_PRIV_BACKPRESSURE_DROP_BY_PRIORITY
+#define DLOGGER_BACKPRESSURE_OVERWRITE_OLDEST DLOGGER_PRIV_BACKPRESSURE_OVERWRITE_OLDEST
+
+
+/*
+ * Available durability of log file (unique file and files of threads). FATAL record is durable in all modes except
+ * DLOGGER_DURABILITY_NONE: caller of FATAL returns when record is on disk. dlogger_destroy synchronizes files
+ * before they are closed in all modes except DLOGGER_DURABILITY_NONE.
+ *
+ * DLOGGER_DURABILITY_NONE         - records are never synchronized with disk by DLogger (default).
+ *
+ * DLOGGER_DURABILITY_CRITICAL     - fdatasync after each FATAL and CRITICAL record. Other records are not synchronized.
+ *
+ * DLOGGER_DURABILITY_GROUP_COMMIT - background thread calls fdatasync once for all records written in period or when
+ *                                   limit of not synchronized bytes is reached. FATAL caller requests commit and waits
+ *                                   for it, concurrent FATAL records share one fdatasync.
  */
-#define DLOGGER_OPTION_MARK_TIMESTAMP DLOGGER_PRIV_OPTION_MARK_TIMESTAMP
-#define DLOGGER_OPTION_MARK_THREADID  DLOGGER_PRIV_OPTION_MARK_THREADID
+#define DLOGGER_DURABILITY_NONE               DLOGGER_PRIV_DURABILITY_NONE
+#define DLOGGER_DURABILITY_CRITICAL           DLOGGER_PRIV_DURABILITY_CRITICAL
+#define DLOGGER_DURABILITY_GROUP_COMMIT       DLOGGER_PRIV_DURABILITY_GROUP_COMMIT
+
+
+/*
+ * Available states of call-site. Each logging functionlike macro is registered as call-site (file, line, function, level)
+ * and its state can be changed in run-time by dlogger_callsite_set.
+ *
+ * DLOGGER_CALLSITE_DEFAULT - call-site is filtered by level of descriptors.
+ *
+ * DLOGGER_CALLSITE_ON      - call-site is written to all descriptors regardless of their level.
+ *
+ * DLOGGER_CALLSITE_OFF     - call-site is never written. Arguments of functionlike macro are not evaluated.
+ */
+#define DLOGGER_CALLSITE_DEFAULT DLOGGER_PRIV_CALLSITE_DEFAULT
+#define DLOGGER_CALLSITE_ON      DLOGGER_PRIV_CALLSITE_ON
+#define DLOGGER_CALLSITE_OFF     DLOGGER_PRIV_CALLSITE_OFF
 
 
 /* Structure which contain options set by user by dedicated API. */
 typedef struct DLogger_user_optionsS DLogger_user_optionsS;
 
 
+/* Metric (counter, gauge or histogram) registered by dlogger_metric_* functions. */
+typedef struct DLogger_metricS DLogger_metricS;
+
+
 /* 
  * This function create DLogger user options. Should be called only once and before any DLogger functions.
  *
@@ -104,9 +208,9 @@ typedef struct DLogger_user_optionsS DLogger_user_optionsS;
 DLogger_user_optionsS* dlogger_create_user_options(void);
 
 
-/* 
- * This function destroy DLogger user options. Should be called after creating of DLogger to free memory 
- * becuase in run-time we cannot change any option of DLogger.
+/*
+ * This function destroy DLogger user options. Should be called after creating of DLogger to free memory.
+ * In run-time level and additional options can be changed by dlogger_set_runtime_options.
  *
  * @param[in] user_options_p - pointer to options specified by user.
  * 
@@ -131,6 +235,130 @@ void dlogger_set_user_options(DLogger_user_optionsS* user_options_p,
                               DLogger_options_markE additional_options);
 
 
+/*
+ * This function enable asynchronous logging. Records are formatted by caller, copied into preallocated queue and
+ * written by writer thread, so caller does not wait for I/O. FATAL record waits until it is written.
+ * Queue is released in dlogger_destroy after all records are written.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] queue_size     - size of queue in bytes, 0 means synchronous logging (default).
+ * @param[in] backpressure   - policy when queue is full (DLOGGER_BACKPRESSURE_*).
+ *
+ * @return - void.
+ */
+void dlogger_set_async_options(DLogger_user_optionsS* user_options_p, size_t queue_size, DLogger_backpressureE backpressure);
+
+
+/*
+ * This function tune how writer thread of asynchronous logging waits for records. Writer spins @spin_usec before
+ * it sleeps, so records are noticed without system call. When @batch_size is not 0, writer takes at most @batch_size
+ * records at once and waits up to @linger_usec for full batch. Default is 0 for all, writer sleeps immediately and
+ * takes whole queue.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] spin_usec      - time of busy waiting before sleep in microseconds.
+ * @param[in] batch_size     - maximal number of records written at once, 0 means not limited.
+ * @param[in] linger_usec    - maximal time of waiting for full batch in microseconds.
+ *
+ * @return - void.
+ */
+void dlogger_set_writer_options(DLogger_user_optionsS* user_options_p, unsigned int spin_usec, size_t batch_size,
+                                unsigned int linger_usec);
+
+
+/*
+ * This function pin writer thread of asynchronous logging to CPU or NUMA node and set its scheduling policy.
+ * Errors are reported on stderr and writer thread runs without them.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] cpu            - CPU of writer thread, -1 means not pinned (default).
+ * @param[in] numa_node      - NUMA node of writer thread, used when @cpu is -1, -1 means not pinned (default).
+ * @param[in] sched_policy   - scheduling policy (SCHED_OTHER (default), SCHED_FIFO, SCHED_RR, ...).
+ * @param[in] sched_priority - priority for @sched_policy, 0 for SCHED_OTHER.
+ *
+ * @return - void.
+ */
+void dlogger_set_writer_placement(DLogger_user_optionsS* user_options_p, int cpu, int numa_node, int sched_policy,
+                                  int sched_priority);
+
+
+/*
+ * This function set where spans of dlogger_trace_scope, dlogger_trace_begin and dlogger_trace_end are written.
+ * By default span is written as DEBUG record with its duration and depth, filtered like other records. With
+ * @trace_path_p spans are written into Chrome trace-event JSON file instead (chrome://tracing, ui.perfetto.dev),
+ * each thread has own track with nested spans. Span is not recorded only when its call-site is DLOGGER_CALLSITE_OFF.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] trace_path_p   - path to trace file (truncated in dlogger_create), NULL means records in log (default).
+ *
+ * @return - void.
+ */
+void dlogger_set_trace_options(DLogger_user_optionsS* user_options_p, const char* trace_path_p);
+
+
+/*
+ * This function start reporter thread which writes all metrics every @period_sec as INFO records:
+ * metric requests: total 120000, +20000 (4000/s)
+ * metric latency_us: count 20000 (4000/s), mean 48, p50 39, p99 319, max 1204
+ * Metrics without change in period are not written. Metrics are written also by dlogger_destroy.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] period_sec     - period of reports in seconds, 0 means only dlogger_metrics_report (default).
+ *
+ * @return - void.
+ */
+void dlogger_set_metrics_options(DLogger_user_optionsS* user_options_p, unsigned int period_sec);
+
+
+/*
+ * This function set when records of log file are synchronized with disk (DLOGGER_DURABILITY_*).
+ * With asynchronous logging fdatasync is called by writer thread, not by caller.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] durability     - durability of log file, DLOGGER_DURABILITY_NONE by default.
+ * @param[in] period_msec    - DLOGGER_DURABILITY_GROUP_COMMIT: commit at least every @period_msec, 0 means no period.
+ * @param[in] max_bytes      - DLOGGER_DURABILITY_GROUP_COMMIT: commit when @max_bytes are not synchronized, 0 means no limit.
+ *
+ * @return - void.
+ */
+void dlogger_set_durability_options(DLogger_user_optionsS* user_options_p, DLogger_durabilityE durability,
+                                    unsigned int period_msec, size_t max_bytes);
+
+
+/*
+ * This function enable multi-process logging. dlogger_create maps ring of @ring_size bytes shared with processes
+ * forked later and starts collector thread in calling process. Each process (also the parent) formats record and
+ * publishes it into the ring without lock, collector writes records of all processes in order of publication.
+ * Ring replaces asynchronous queue, records are never dropped: process waits when ring is full. FATAL record waits
+ * until collector writes it. Record bigger than ring is written directly by caller.
+ * Only the parent writes files, so children do not open files of threads and fdatasync is called by the parent.
+ * Parent must call dlogger_destroy after children exit, records published later are lost. Slots reserved by process
+ * killed before it published record are skipped with notice.
+ *
+ * @param[in] user_options_p - pointer to options specified by user.
+ * @param[in] ring_size      - size of shared ring in bytes, 0 means every process writes by itself (default).
+ *
+ * @return - void.
+ */
+void dlogger_set_multiprocess_options(DLogger_user_optionsS* user_options_p, size_t ring_size);
+
+
+/*
+ * This function set size of record arena. Arena is mapped by dlogger_create and gives chunks for per-record storage
+ * which does not fit into per-thread buffer (32 KiB): long messages and list of modules for raw backtraces. So no
+ * record allocates memory after dlogger_create. Long message takes run of adjacent chunks big enough for it, chunks
+ * are returned right after record is written (or queued). When no such run is free, thread waits for it. Message
+ * longer than whole arena is formatted into temporary mapping. Text of FATAL backtrace has own buffer on stack and does not use arena.
+ *
+ * @param[in] user_options_p   - pointer to options specified by user.
+ * @param[in] number_of_chunks - number of chunks, it limits long records formatted at once, 0 means 8 (default).
+ * @param[in] chunk_size       - size of chunk in bytes, 0 means 1 MiB (default).
+ *
+ * @return - void.
+ */
+void dlogger_set_arena_options(DLogger_user_optionsS* user_options_p, size_t number_of_chunks, size_t chunk_size);
+
+
 /*
  * This function create and initialize DLogger. Should be called only once and before any DLogger functions.
  *
@@ -151,6 +379,158 @@ int dlogger_create(const DLogger_user_optionsS* user_options_p);
 void dlogger_destroy(void);
 
 
+/*
+ * This function change level and additional options of descriptor in run-time, without restart of application.
+ * Descriptor must be specified in dlogger_create (or created by default). New options are visible for all
+ * threads from next logging functionlike macro. Lock is not taken for this operation.
+ *
+ * @param[in] descriptor_to_write - which descriptor options @level_of_logging and @additional_options will be changed.
+ * @param[in] level_of_logging    - new level of logging for above @descriptor_to_write.
+ * @param[in] additional_options  - new additional options for above @descriptor_to_write.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+int dlogger_set_runtime_options(DLogger_options_writeE descriptor_to_write,
+                                DLogger_levelE level_of_logging,
+                                DLogger_options_markE additional_options);
+
+
+/*
+ * This function install signal handlers which step level of logging for all descriptors in run-time.
+ * Good choice are SIGUSR1 and SIGUSR2. Previous handlers will be restored in dlogger_destroy.
+ *
+ * Example:
+ * $kill -USR1 <pid> - next level (e.g. from DLOGGER_LEVEL_INFO to DLOGGER_LEVEL_DEBUG).
+ * $kill -USR2 <pid> - previous level (e.g. from DLOGGER_LEVEL_INFO to DLOGGER_LEVEL_WARNING).
+ *
+ * @param[in] signal_more_verbose - signal number which increase level of logging, 0 if not used.
+ * @param[in] signal_less_verbose - signal number which decrease level of logging, 0 if not used.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+int dlogger_install_signal_handlers(int signal_more_verbose, int signal_less_verbose);
+
+
+/*
+ * This function load configuration file and then watch it (by inotify) in separated thread. Every time when file
+ * is saved, new options are applied. Watching is stopped in dlogger_destroy. If environment variable
+ * DLOGGER_CONFIG_FILE is set, dlogger_create will call this function for the path from variable.
+ *
+ * Each line of configuration file contains descriptor, level and additional options. Lines started by # are skipped.
+ * Additional options: timestamp, threadid, rawbacktrace, suppressrepeated, perthreadfile.
+ *
+ * Example:
+ * # descriptor = level, additional options
+ * file   = debug, timestamp, threadid
+ * stdout = warning, timestamp
+ * stderr = fatal
+ *
+ * State of call-sites can be changed by line: callsite file_pattern function_pattern on|off|default.
+ * callsite *network.c parse_* on
+ *
+ * @param[in] path_p - path to configuration file.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+int dlogger_watch_config_file(const char* path_p);
+
+
+/*
+ * This function return number of records dropped by asynchronous queue since dlogger_create.
+ *
+ * @param[in] level - level of dropped records.
+ *
+ * @return - number of dropped records, 0 for synchronous logging.
+ */
+size_t dlogger_dropped_messages(DLogger_levelE level);
+
+
+/*
+ * This function return number of records truncated since dlogger_create, because message was longer than record
+ * arena and its temporary mapping failed (see dlogger_set_arena_options).
+ *
+ * @param[in] - void.
+ *
+ * @return - number of truncated records.
+ */
+size_t dlogger_truncated_messages(void);
+
+
+/*
+ * This function change state of all call-sites which match patterns. Patterns use shell wildcards (fnmatch),
+ * e.g. dlogger_callsite_set("*network.c", "parse_*", DLOGGER_CALLSITE_ON). Can be called at any time. Patterns are
+ * also kept for C++ call-sites registered later (at their first execution) until dlogger_destroy.
+ *
+ * @param[in] file_pattern_p - pattern for file name of call-site, NULL matches all files.
+ * @param[in] func_pattern_p - pattern for function name of call-site, NULL matches all functions.
+ * @param[in] state          - new state of matched call-sites.
+ *
+ * @return - number of matched call-sites.
+ */
+size_t dlogger_callsite_set(const char* file_pattern_p, const char* func_pattern_p, DLogger_callsite_stateE state);
+
+
+/*
+ * This function call @callback_p for all call-sites which match patterns. Useful to list available call-sites.
+ *
+ * @param[in] file_pattern_p - pattern for file name of call-site, NULL matches all files.
+ * @param[in] func_pattern_p - pattern for function name of call-site, NULL matches all functions.
+ * @param[in] callback_p     - function called for each matched call-site.
+ * @param[in] arg_p          - argument passed to @callback_p.
+ *
+ * @return - number of matched call-sites.
+ */
+size_t dlogger_callsite_query(const char* file_pattern_p,
+                              const char* func_pattern_p,
+                              void (*callback_p)(const DLogger_callsiteS* callsite_p, void* arg_p),
+                              void* arg_p);
+
+
+/*
+ * These functions register metric or return already registered metric with the same name. Metrics are
+ * updated without lock (each thread updates own shard) and released by dlogger_destroy.
+ *
+ * Counter   - sum of added values, reported with increase and rate in period.
+ * Gauge     - the last set value, written only when it changed.
+ * Histogram - distribution of values in period (log-linear buckets, error <= 12.5%): count, rate, mean, p50, p99, max.
+ *
+ * @param[in] name_p - name of metric, copied.
+ *
+ * @return pointer to metric if success, otherwise NULL (also if metric exists with other type).
+ */
+DLogger_metricS* dlogger_metric_counter(const char* name_p);
+DLogger_metricS* dlogger_metric_gauge(const char* name_p);
+DLogger_metricS* dlogger_metric_histogram(const char* name_p);
+
+
+/*
+ * These functions update metric: add to counter, set gauge and record value in histogram. Update of metric
+ * with other type is ignored, so they can be called with NULL returned by registration.
+ *
+ * @param[in] metric_p - pointer to metric.
+ * @param[in] value    - value.
+ *
+ * @return - void.
+ */
+void dlogger_metric_add(DLogger_metricS* metric_p, uint64_t value);
+void dlogger_metric_set(DLogger_metricS* metric_p, int64_t value);
+void dlogger_metric_record(DLogger_metricS* metric_p, uint64_t value);
+
+
+/*
+ * This function write all metrics now, like reporter thread does every period.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+void dlogger_metrics_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+
 /* 
  * This define works in the same way like NDEBUG introduced for macro assert from assert.h. If you want to 
  * compile your application to release version, use this define to turn-off functionlike macros for logging. 
@@ -162,6 +542,7 @@ void dlogger_destroy(void);
 
 /* 
  * This functionlike macro is responsible for logging messages into file. Can be use in the same way like printf.
+ * Arguments are evaluated only if record is enabled (by level of any descriptor or by call-site state).
  *
  * @param[in] - variadic arguments.
  * 
@@ -174,6 +555,39 @@ void dlogger_destroy(void);
 #define dlogger_log_info(...)     dlogger_priv_log_info(__VA_ARGS__)
 #define dlogger_log_debug(...)    dlogger_priv_log_debug(__VA_ARGS__)
 
+/* 
+ * This functionlike macro is responsible for logging caller-owned buffer (e.g. hex dump of packet) with standard prefix.
+ * Buffer is written directly without intermediate copy. Newline is added if buffer does not end with it.
+ *
+ * @param[in] level  - level of logging, must be one of DLOGGER_LEVEL_* constants.
+ * @param[in] data_p - pointer to buffer.
+ * @param[in] size   - size of buffer in bytes.
+ * 
+ * @return - void
+ */
+#define dlogger_log_raw(level, data_p, size) dlogger_priv_log_raw(level, data_p, size)
+
+/* 
+ * This functionlike macro open span of trace which ends when current scope ends. Start, end and thread id are
+ * recorded, nested spans are shown inside their parents. Requires GCC or Clang (cleanup attribute).
+ *
+ * @param[in] name - name of span, must be valid until span ends (string literal is the best).
+ * 
+ * @return - void
+ */
+#define dlogger_trace_scope(name) dlogger_priv_trace_scope(name)
+
+/* 
+ * These functionlike macros open and close span of trace explicitly, e.g. when span does not match scope.
+ * Each thread has own stack of spans, dlogger_trace_end closes span opened by the last dlogger_trace_begin.
+ *
+ * @param[in] name - name of span, must be valid until span ends (string literal is the best).
+ * 
+ * @return - void
+ */
+#define dlogger_trace_begin(name) dlogger_priv_trace_begin(name)
+#define dlogger_trace_end()       dlogger_priv_trace_end()
+
 #else
 
 #ifndef DLOGGER_SILENT_FATAL 
@@ -191,6 +605,10 @@ void dlogger_destroy(void);
 #define dlogger_log_warning(...)
 #define dlogger_log_info(...)
 #define dlogger_log_debug(...)
+#define dlogger_log_raw(level, data_p, size)
+#define dlogger_trace_scope(name)
+#define dlogger_trace_begin(name)
+#define dlogger_trace_end()
 
 #endif /* NDEBUG */
 
@@ -0,0 +1,872 @@
+#ifndef DLOGGER_HPP
+#define DLOGGER_HPP
+
+
+/*
+    This is the C++ front-end for DLogger library (header only, C++17 or newer). Include it instead of dlogger.h.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Logging macros have the same names and meaning like in dlogger.h, but:
+    - format string is parsed and validated at compile time (number and types of arguments, unknown conversions, %n),
+      so bad format is compilation error instead of undefined behaviour.
+    - arguments are captured by type (variadic template), without va_list and default argument promotions.
+    - each call-site gets own formatting code generated from parsed format: literal parts are copied by memcpy,
+      simple integer and string conversions are written directly, only conversions with flags, width, precision,
+      floating point numbers and pointers are formatted by snprintf with conversion prepared at compile time.
+    - std::string, std::string_view and integral types of any size are accepted without conversions
+      (%d prints int64_t, %s prints std::string_view). Length modifiers are not needed, but if present they
+      are respected like by printf (%hhd prints value converted to signed char).
+    - output is identical to C macros, formatted message goes through the same path like dlogger_log_raw.
+    - message is built in per-thread buffer, long message in chunks of record arena, so logging does not allocate.
+
+    Format has to be string literal (or other constant expression). Positional arguments (%1$d), wide characters
+    (%lc, %ls) and %n are not supported. Precision is not supported for std::string and std::string_view,
+    use substr instead.
+*/
+
+
+#include "dlogger.h"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace dlogger::priv
+{
+
+/* Size of per-thread buffer for message, longer messages are formatted again into chunks of record arena. */
+inline constexpr std::size_t DLOGGER_MESSAGE_BUFFER_SIZE = 1 << 15;
+
+/* The longest conversion prepared for snprintf (with added length modifier and terminating null). */
+inline constexpr std::size_t DLOGGER_CONVERSION_MAX_SIZE = 32;
+
+/* Place for the longest integer written by std::to_chars (128 bits in octal with sign). */
+inline constexpr std::size_t DLOGGER_INTEGER_MAX_SIZE = 48;
+
+
+/* Kind of argument, conversion of format decides which kinds are accepted. */
+enum class DLogger_argumentE : unsigned char
+{
+    INTEGER,      /* integral types (bool and characters too) and enums. */
+    FLOATING,
+    C_STRING,     /* char*, const char* and char arrays. */
+    STRING,       /* std::string and std::string_view. */
+    POINTER,
+    UNSUPPORTED,
+};
+
+
+enum class DLogger_format_errorE : unsigned char
+{
+    NONE,
+    UNFINISHED_CONVERSION,
+    UNKNOWN_CONVERSION,
+    WRITEBACK_CONVERSION,
+    POSITIONAL_ARGUMENT,
+    TOO_LONG_CONVERSION,
+    NUMBER_OF_ARGUMENTS,
+    STAR_NOT_INTEGER,
+    UNSUPPORTED_TYPE,
+    INTEGER_EXPECTED,
+    FLOATING_EXPECTED,
+    STRING_EXPECTED,
+    POINTER_EXPECTED,
+    STRING_PRECISION,
+};
+
+
+/* One conversion of format, offsets are indexes in format string. */
+struct DLogger_conversionS
+{
+    std::size_t literal_begin;     /* literal text between previous conversion and this one starts here. */
+    std::size_t begin;             /* '%'. */
+    std::size_t precision_begin;   /* '.' of precision, equal to precision_end if precision is not used. */
+    std::size_t precision_end;
+    std::size_t modifier_begin;    /* length modifier is not copied into conversion prepared for snprintf. */
+    std::size_t end;               /* after conversion character. */
+    std::size_t first_argument;    /* index of the first argument ('*' width and precision go before value). */
+    unsigned int number_of_stars;
+    char modifier[2];              /* hh, h, l, ll, j, z, t, L, q or zeros. */
+    char conversion;
+    bool is_simple;                /* without flags, width and precision. */
+};
+
+
+template <std::size_t N>
+struct DLogger_formatS
+{
+    std::array<DLogger_conversionS, N> conversions;
+    std::size_t number_of_conversions;
+    std::size_t number_of_arguments;
+    std::size_t tail_begin;        /* literal text after the last conversion. */
+    DLogger_format_errorE error;
+};
+
+
+/*
+ * Message is built in per-thread buffer, so formatting does not allocate. When it does not fit, the rest is only
+ * counted and whole message is formatted again into buffer of record arena with exact size.
+ */
+struct DLogger_messageS
+{
+    char* data_p;
+    std::size_t size;       /* bytes written into data_p. */
+    std::size_t capacity;
+    std::size_t full_size;  /* length of whole message, bigger than size when message does not fit into data_p. */
+
+    bool reserve(std::size_t bytes);
+    void append(const char* data_p, std::size_t bytes);
+};
+
+
+/*
+ * Each '%' starts one conversion (%% too, it prints '%' without argument). Character after '%' is skipped,
+ * so %% is counted once. For valid format the result is exact number of conversions.
+ */
+constexpr std::size_t __dlogger_count_conversions(const std::string_view format)
+{
+    std::size_t number_of_conversions = 0;
+
+    for (std::size_t i = 0; i < format.size(); ++i)
+    {
+        if (format[i] == '%')
+        {
+            ++number_of_conversions;
+            ++i;
+        }
+    }
+
+    return number_of_conversions;
+}
+
+
+constexpr bool __dlogger_is_digit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+
+constexpr bool __dlogger_is_flag(const char c)
+{
+    return c == '-' || c == '+' || c == ' ' || c == '#' || c == '0' || c == '\'';
+}
+
+
+constexpr bool __dlogger_is_modifier(const char c)
+{
+    return c == 'h' || c == 'l' || c == 'j' || c == 'z' || c == 't' || c == 'L' || c == 'q';
+}
+
+
+constexpr bool __dlogger_is_integer_conversion(const char c)
+{
+    return c == 'd' || c == 'i' || c == 'u' || c == 'o' || c == 'x' || c == 'X' || c == 'c';
+}
+
+
+constexpr bool __dlogger_is_floating_conversion(const char c)
+{
+    return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+
+/* Parse format like printf does, but at compile time. Parsing stops on the first error. */
+template <std::size_t N>
+constexpr DLogger_formatS<N> __dlogger_parse_format(const std::string_view format)
+{
+    DLogger_formatS<N> result{};
+    std::size_t literal_begin = 0;
+    std::size_t i = 0;
+
+    while (i < format.size())
+    {
+        if (format[i] != '%')
+        {
+            ++i;
+            continue;
+        }
+
+        DLogger_conversionS conversion{};
+        conversion.literal_begin = literal_begin;
+        conversion.begin = i++;
+        conversion.first_argument = result.number_of_arguments;
+        conversion.is_simple = true;
+
+        if (i < format.size() && format[i] == '%')
+        {
+            conversion.precision_begin = conversion.precision_end = conversion.modifier_begin = i;
+            conversion.conversion = format[i++];
+            conversion.end = i;
+        }
+        else
+        {
+            while (i < format.size() && __dlogger_is_flag(format[i]))
+            {
+                conversion.is_simple = false;
+                ++i;
+            }
+
+            if (i < format.size() && format[i] == '*')
+            {
+                conversion.is_simple = false;
+                ++conversion.number_of_stars;
+                ++i;
+            }
+
+            while (i < format.size() && __dlogger_is_digit(format[i]))
+            {
+                conversion.is_simple = false;
+                ++i;
+            }
+
+            if (i < format.size() && format[i] == '$')
+            {
+                result.error = DLogger_format_errorE::POSITIONAL_ARGUMENT;
+                return result;
+            }
+
+            conversion.precision_begin = i;
+
+            if (i < format.size() && format[i] == '.')
+            {
+                conversion.is_simple = false;
+                ++i;
+
+                if (i < format.size() && format[i] == '*')
+                {
+                    ++conversion.number_of_stars;
+                    ++i;
+                }
+
+                while (i < format.size() && __dlogger_is_digit(format[i]))
+                {
+                    ++i;
+                }
+            }
+
+            conversion.precision_end = i;
+            conversion.modifier_begin = i;
+
+            if (i < format.size() && __dlogger_is_modifier(format[i]))
+            {
+                conversion.modifier[0] = format[i++];
+
+                if ((conversion.modifier[0] == 'h' || conversion.modifier[0] == 'l') &&
+                    i < format.size() && format[i] == conversion.modifier[0])
+                {
+                    conversion.modifier[1] = format[i++];
+                }
+            }
+
+            if (i >= format.size())
+            {
+                result.error = DLogger_format_errorE::UNFINISHED_CONVERSION;
+                return result;
+            }
+
+            conversion.conversion = format[i++];
+            conversion.end = i;
+
+            if (conversion.conversion == 'n')
+            {
+                result.error = DLogger_format_errorE::WRITEBACK_CONVERSION;
+                return result;
+            }
+
+            /* Length modifiers of %c, %s and %p mean wide characters, which are not supported. */
+            const bool is_modifier_valid = conversion.modifier[0] == '\0' ||
+                                           __dlogger_is_integer_conversion(conversion.conversion) ||
+                                           (__dlogger_is_floating_conversion(conversion.conversion) &&
+                                            conversion.modifier[1] == '\0' &&
+                                            (conversion.modifier[0] == 'L' || conversion.modifier[0] == 'l'));
+
+            if ((__dlogger_is_integer_conversion(conversion.conversion) == false &&
+                 __dlogger_is_floating_conversion(conversion.conversion) == false &&
+                 conversion.conversion != 's' && conversion.conversion != 'p') ||
+                (conversion.conversion == 'c' && conversion.modifier[0] != '\0') ||
+                is_modifier_valid == false)
+            {
+                result.error = DLogger_format_errorE::UNKNOWN_CONVERSION;
+                return result;
+            }
+
+            /* Length modifier is replaced by at most 2 characters and terminating null is added. */
+            if (conversion.modifier_begin - conversion.begin + 4 > DLOGGER_CONVERSION_MAX_SIZE)
+            {
+                result.error = DLogger_format_errorE::TOO_LONG_CONVERSION;
+                return result;
+            }
+
+            result.number_of_arguments += conversion.number_of_stars + 1;
+        }
+
+        if (result.number_of_conversions >= N)
+        {
+            result.error = DLogger_format_errorE::UNKNOWN_CONVERSION;
+            return result;
+        }
+
+        result.conversions[result.number_of_conversions++] = conversion;
+        literal_begin = i;
+    }
+
+    result.tail_begin = literal_begin;
+
+    return result;
+}
+
+
+/* Format parsed once per call-site. @FormatT is local type with static constexpr function value(). */
+template <typename FormatT>
+inline constexpr auto __dlogger_parsed_format =
+    __dlogger_parse_format<__dlogger_count_conversions(FormatT::value())>(FormatT::value());
+
+
+template <typename T>
+constexpr DLogger_argumentE __dlogger_argument_kind()
+{
+    using ValueT = std::remove_cv_t<std::remove_reference_t<T>>;
+    using DecayedT = std::decay_t<T>;
+
+    if constexpr (std::is_same_v<DecayedT, char*> || std::is_same_v<DecayedT, const char*>)
+    {
+        return DLogger_argumentE::C_STRING;
+    }
+    else if constexpr (std::is_same_v<ValueT, std::string> || std::is_same_v<ValueT, std::string_view>)
+    {
+        return DLogger_argumentE::STRING;
+    }
+    else if constexpr (std::is_integral_v<ValueT> || std::is_enum_v<ValueT>)
+    {
+        return DLogger_argumentE::INTEGER;
+    }
+    else if constexpr (std::is_floating_point_v<ValueT>)
+    {
+        return DLogger_argumentE::FLOATING;
+    }
+    else if constexpr ((std::is_pointer_v<DecayedT> && std::is_function_v<std::remove_pointer_t<DecayedT>> == false) ||
+                       std::is_null_pointer_v<ValueT>)
+    {
+        return DLogger_argumentE::POINTER;
+    }
+    else
+    {
+        return DLogger_argumentE::UNSUPPORTED;
+    }
+}
+
+
+/* Check types of arguments against parsed format. Result is used by static_assert of the call-site. */
+template <typename FormatT, typename... ArgsT>
+constexpr DLogger_format_errorE __dlogger_check_format()
+{
+    constexpr auto& format = __dlogger_parsed_format<FormatT>;
+
+    if (format.error != DLogger_format_errorE::NONE)
+    {
+        return format.error;
+    }
+
+    if (format.number_of_arguments != sizeof...(ArgsT))
+    {
+        return DLogger_format_errorE::NUMBER_OF_ARGUMENTS;
+    }
+
+    constexpr std::array<DLogger_argumentE, sizeof...(ArgsT)> kinds = { __dlogger_argument_kind<ArgsT>()... };
+
+    for (const DLogger_conversionS& conversion : format.conversions)
+    {
+        if (conversion.conversion == '%')
+        {
+            continue;
+        }
+
+        for (unsigned int i = 0; i < conversion.number_of_stars; ++i)
+        {
+            if (kinds[conversion.first_argument + i] != DLogger_argumentE::INTEGER)
+            {
+                return DLogger_format_errorE::STAR_NOT_INTEGER;
+            }
+        }
+
+        const DLogger_argumentE kind = kinds[conversion.first_argument + conversion.number_of_stars];
+
+        if (kind == DLogger_argumentE::UNSUPPORTED)
+        {
+            return DLogger_format_errorE::UNSUPPORTED_TYPE;
+        }
+
+        if (__dlogger_is_integer_conversion(conversion.conversion) && kind != DLogger_argumentE::INTEGER)
+        {
+            return DLogger_format_errorE::INTEGER_EXPECTED;
+        }
+
+        if (__dlogger_is_floating_conversion(conversion.conversion) && kind != DLogger_argumentE::FLOATING)
+        {
+            return DLogger_format_errorE::FLOATING_EXPECTED;
+        }
+
+        if (conversion.conversion == 's')
+        {
+            if (kind != DLogger_argumentE::C_STRING && kind != DLogger_argumentE::STRING)
+            {
+                return DLogger_format_errorE::STRING_EXPECTED;
+            }
+
+            if (kind == DLogger_argumentE::STRING && conversion.precision_begin != conversion.precision_end)
+            {
+                return DLogger_format_errorE::STRING_PRECISION;
+            }
+        }
+
+        if (conversion.conversion == 'p' && kind != DLogger_argumentE::POINTER && kind != DLogger_argumentE::C_STRING)
+        {
+            return DLogger_format_errorE::POINTER_EXPECTED;
+        }
+    }
+
+    return DLogger_format_errorE::NONE;
+}
+
+
+/*
+ * Conversion for snprintf: flags, width and precision are copied from format, length modifier is chosen for type
+ * passed to snprintf (integers are passed as long long, std::string_view as precision and pointer).
+ */
+template <typename FormatT, std::size_t I, DLogger_argumentE Kind, bool IsLongDouble>
+constexpr std::array<char, DLOGGER_CONVERSION_MAX_SIZE> __dlogger_conversion_text()
+{
+    constexpr std::string_view format = FormatT::value();
+    constexpr DLogger_conversionS conversion = __dlogger_parsed_format<FormatT>.conversions[I];
+
+    std::array<char, DLOGGER_CONVERSION_MAX_SIZE> text{};
+    std::size_t size = 0;
+
+    for (std::size_t i = conversion.begin; i < conversion.modifier_begin; ++i)
+    {
+        text[size++] = format[i];
+    }
+
+    if (Kind == DLogger_argumentE::INTEGER && conversion.conversion != 'c')
+    {
+        text[size++] = 'l';
+        text[size++] = 'l';
+    }
+    else if (Kind == DLogger_argumentE::FLOATING && IsLongDouble)
+    {
+        text[size++] = 'L';
+    }
+    else if (Kind == DLogger_argumentE::STRING)
+    {
+        text[size++] = '.';
+        text[size++] = '*';
+    }
+
+    text[size] = conversion.conversion;
+
+    return text;
+}
+
+
+template <typename ValueT>
+constexpr auto __dlogger_to_integer(const ValueT value)
+{
+    /* Unary plus promotes small types like for variadic arguments of printf. */
+    if constexpr (std::is_enum_v<ValueT>)
+    {
+        return +static_cast<std::underlying_type_t<ValueT>>(value);
+    }
+    else
+    {
+        return +value;
+    }
+}
+
+
+/* Integer is converted to type given by length modifier (like printf does), otherwise its own type is kept. */
+template <char Modifier0, char Modifier1, bool IsSigned, typename IntegerT>
+constexpr auto __dlogger_apply_modifier(const IntegerT value)
+{
+    if constexpr (Modifier0 == 'h' && Modifier1 == 'h')
+    {
+        return static_cast<std::conditional_t<IsSigned, signed char, unsigned char>>(value);
+    }
+    else if constexpr (Modifier0 == 'h')
+    {
+        return static_cast<std::conditional_t<IsSigned, short, unsigned short>>(value);
+    }
+    else if constexpr ((Modifier0 == 'l' && Modifier1 == 'l') || Modifier0 == 'q' || Modifier0 == 'L')
+    {
+        return static_cast<std::conditional_t<IsSigned, long long, unsigned long long>>(value);
+    }
+    else if constexpr (Modifier0 == 'l')
+    {
+        return static_cast<std::conditional_t<IsSigned, long, unsigned long>>(value);
+    }
+    else if constexpr (Modifier0 == 'j')
+    {
+        return static_cast<std::conditional_t<IsSigned, std::intmax_t, std::uintmax_t>>(value);
+    }
+    else if constexpr (Modifier0 == 'z')
+    {
+        return static_cast<std::conditional_t<IsSigned, std::make_signed_t<std::size_t>, std::size_t>>(value);
+    }
+    else if constexpr (Modifier0 == 't')
+    {
+        return static_cast<std::conditional_t<IsSigned, std::ptrdiff_t, std::make_unsigned_t<std::ptrdiff_t>>>(value);
+    }
+    else
+    {
+        return static_cast<std::conditional_t<IsSigned, std::make_signed_t<IntegerT>, std::make_unsigned_t<IntegerT>>>(value);
+    }
+}
+
+
+inline char* __dlogger_thread_buffer()
+{
+    static thread_local char buffer[DLOGGER_MESSAGE_BUFFER_SIZE];
+
+    return &buffer[0];
+}
+
+
+/* Return true if @bytes fit after message. Nothing is written after the first part which did not fit. */
+inline bool DLogger_messageS::reserve(const std::size_t bytes)
+{
+    return full_size == size && capacity - size >= bytes;
+}
+
+
+inline void DLogger_messageS::append(const char* const string_p, const std::size_t bytes)
+{
+    if (reserve(bytes))
+    {
+        std::memcpy(data_p + size, string_p, bytes);
+        size += bytes;
+    }
+
+    full_size += bytes;
+}
+
+
+template <int Base, bool IsUpper, typename IntegerT>
+inline void __dlogger_append_integer(DLogger_messageS& message, const IntegerT value)
+{
+    /* Integer is written in place, only at the end of full buffer it is written aside and counted by append. */
+    char digits[DLOGGER_INTEGER_MAX_SIZE];
+    const bool is_in_place = message.reserve(DLOGGER_INTEGER_MAX_SIZE);
+
+    char* const begin_p = is_in_place ? message.data_p + message.size : &digits[0];
+    char* const end_p = std::to_chars(begin_p, begin_p + DLOGGER_INTEGER_MAX_SIZE, value, Base).ptr;
+
+    if constexpr (IsUpper)
+    {
+        for (char* p = begin_p; p != end_p; ++p)
+        {
+            if (*p >= 'a' && *p <= 'f')
+            {
+                *p = static_cast<char>(*p - 'a' + 'A');
+            }
+        }
+    }
+
+    if (is_in_place)
+    {
+        message.size += static_cast<std::size_t>(end_p - begin_p);
+        message.full_size += static_cast<std::size_t>(end_p - begin_p);
+    }
+    else
+    {
+        message.append(begin_p, static_cast<std::size_t>(end_p - begin_p));
+    }
+}
+
+
+template <typename... ValuesT>
+inline void __dlogger_append_formatted(DLogger_messageS& message, const char* const conversion_p, const ValuesT... values)
+{
+    /* After the first part which did not fit snprintf only counts length of output. */
+    const std::size_t available = message.reserve(1) ? message.capacity - message.size : 0;
+    const int ret = std::snprintf(available > 0 ? message.data_p + message.size : nullptr, available, conversion_p, values...);
+
+    if (ret < 0)
+    {
+        return;
+    }
+
+    const std::size_t bytes = static_cast<std::size_t>(ret);
+
+    /* Terminating null is not part of message, but snprintf needs place for it. */
+    if (bytes < available)
+    {
+        message.size += bytes;
+    }
+
+    message.full_size += bytes;
+}
+
+
+/* Format one value, @stars are already converted width and precision given by '*'. */
+template <typename FormatT, std::size_t I, typename ValueT, typename... StarsT>
+inline void __dlogger_format_value(DLogger_messageS& message, const ValueT& value, const StarsT... stars)
+{
+    constexpr DLogger_conversionS conversion = __dlogger_parsed_format<FormatT>.conversions[I];
+    constexpr DLogger_argumentE kind = __dlogger_argument_kind<ValueT>();
+
+    if constexpr (kind == DLogger_argumentE::INTEGER)
+    {
+        constexpr bool is_signed = (conversion.conversion == 'd' || conversion.conversion == 'i');
+        const auto integer =
+            __dlogger_apply_modifier<conversion.modifier[0], conversion.modifier[1], is_signed>(__dlogger_to_integer(value));
+
+        if constexpr (conversion.conversion == 'c')
+        {
+            const char character = static_cast<char>(static_cast<unsigned char>(integer));
+
+            if constexpr (conversion.is_simple)
+            {
+                message.append(&character, 1);
+            }
+            else
+            {
+                static constexpr auto text = __dlogger_conversion_text<FormatT, I, kind, false>();
+                __dlogger_append_formatted(message, text.data(), stars...,
+                                           static_cast<int>(static_cast<unsigned char>(character)));
+            }
+        }
+        else if constexpr (conversion.is_simple)
+        {
+            constexpr int base = conversion.conversion == 'o' ? 8 :
+                                 (conversion.conversion == 'x' || conversion.conversion == 'X') ? 16 : 10;
+            __dlogger_append_integer<base, conversion.conversion == 'X'>(message, integer);
+        }
+        else
+        {
+            static constexpr auto text = __dlogger_conversion_text<FormatT, I, kind, false>();
+            __dlogger_append_formatted(message, text.data(), stars...,
+                                       static_cast<std::conditional_t<is_signed, long long, unsigned long long>>(integer));
+        }
+    }
+    else if constexpr (kind == DLogger_argumentE::FLOATING)
+    {
+        constexpr bool is_long_double =
+            std::is_same_v<std::remove_cv_t<ValueT>, long double> || conversion.modifier[0] == 'L';
+        static constexpr auto text = __dlogger_conversion_text<FormatT, I, kind, is_long_double>();
+
+        __dlogger_append_formatted(message, text.data(), stars...,
+                                   static_cast<std::conditional_t<is_long_double, long double, double>>(value));
+    }
+    else if constexpr (kind == DLogger_argumentE::C_STRING && conversion.conversion == 's')
+    {
+        const char* string_p = value;
+
+        if constexpr (conversion.is_simple)
+        {
+            /* The same like glibc prints NULL string. */
+            if (string_p == nullptr)
+            {
+                string_p = "(null)";
+            }
+
+            message.append(string_p, std::strlen(string_p));
+        }
+        else
+        {
+            static constexpr auto text = __dlogger_conversion_text<FormatT, I, kind, false>();
+            __dlogger_append_formatted(message, text.data(), stars..., string_p);
+        }
+    }
+    else if constexpr (kind == DLogger_argumentE::STRING)
+    {
+        const std::string_view string = value;
+
+        if constexpr (conversion.is_simple)
+        {
+            message.append(string.data(), string.size());
+        }
+        else
+        {
+            static constexpr auto text = __dlogger_conversion_text<FormatT, I, kind, false>();
+            __dlogger_append_formatted(message, text.data(), stars..., static_cast<int>(string.size()), string.data());
+        }
+    }
+    else
+    {
+        static constexpr auto text = __dlogger_conversion_text<FormatT, I, DLogger_argumentE::POINTER, false>();
+        __dlogger_append_formatted(message, text.data(), stars..., static_cast<const void*>(value));
+    }
+}
+
+
+/* Copy literal text before conversion @I and format its argument. */
+template <typename FormatT, std::size_t I, typename TupleT>
+inline void __dlogger_format_conversion(DLogger_messageS& message, const TupleT& arguments)
+{
+    constexpr std::string_view format = FormatT::value();
+    constexpr DLogger_conversionS conversion = __dlogger_parsed_format<FormatT>.conversions[I];
+    constexpr std::size_t first = conversion.first_argument;
+
+    if constexpr (conversion.begin > conversion.literal_begin)
+    {
+        message.append(format.data() + conversion.literal_begin, conversion.begin - conversion.literal_begin);
+    }
+
+    if constexpr (conversion.conversion == '%')
+    {
+        message.append("%", 1);
+    }
+    else if constexpr (conversion.number_of_stars == 0)
+    {
+        __dlogger_format_value<FormatT, I>(message, std::get<first>(arguments));
+    }
+    else if constexpr (conversion.number_of_stars == 1)
+    {
+        __dlogger_format_value<FormatT, I>(message, std::get<first + 1>(arguments),
+                                           static_cast<int>(std::get<first>(arguments)));
+    }
+    else
+    {
+        __dlogger_format_value<FormatT, I>(message, std::get<first + 2>(arguments),
+                                           static_cast<int>(std::get<first>(arguments)),
+                                           static_cast<int>(std::get<first + 1>(arguments)));
+    }
+}
+
+
+template <typename FormatT, std::size_t... I, typename... ArgsT>
+inline void __dlogger_format_message(DLogger_messageS& message, std::index_sequence<I...>, const ArgsT&... args)
+{
+    constexpr std::string_view format = FormatT::value();
+    constexpr std::size_t tail_begin = __dlogger_parsed_format<FormatT>.tail_begin;
+
+    const std::tuple<const ArgsT&...> arguments(args...);
+    (void)arguments;
+
+    (__dlogger_format_conversion<FormatT, I>(message, arguments), ...);
+
+    if constexpr (tail_begin < format.size())
+    {
+        message.append(format.data() + tail_begin, format.size() - tail_begin);
+    }
+}
+
+
+/* Call-site is registered at the first execution, so dlogger_callsite_set works like for call-sites of C. */
+inline DLogger_callsiteS& __dlogger_get_callsite(DLogger_callsite_nodeS& node)
+{
+    if (__atomic_load_n(&node.is_registered, __ATOMIC_ACQUIRE) == 0)
+    {
+        __dlogger_register_callsite(&node);
+    }
+
+    return node.callsite;
+}
+
+
+/*
+ * Called by logging macros. Format is validated for types of @args at compile time, message is formatted only
+ * if it will be written by any descriptor. The first argument repeats format (it is the first argument of macro).
+ */
+template <typename FormatT, typename FirstT, typename... ArgsT>
+inline void __dlogger_print_message(const DLogger_callsiteS* const callsite_p, FormatT, const FirstT&, const ArgsT&... args)
+{
+    constexpr DLogger_format_errorE error = __dlogger_check_format<FormatT, ArgsT...>();
+
+    static_assert(error != DLogger_format_errorE::UNFINISHED_CONVERSION, "DLogger: format ends inside conversion");
+    static_assert(error != DLogger_format_errorE::UNKNOWN_CONVERSION, "DLogger: unknown conversion in format");
+    static_assert(error != DLogger_format_errorE::WRITEBACK_CONVERSION, "DLogger: %n is not supported");
+    static_assert(error != DLogger_format_errorE::POSITIONAL_ARGUMENT, "DLogger: positional arguments are not supported");
+    static_assert(error != DLogger_format_errorE::TOO_LONG_CONVERSION, "DLogger: too long conversion in format");
+    static_assert(error != DLogger_format_errorE::NUMBER_OF_ARGUMENTS, "DLogger: number of arguments does not match format");
+    static_assert(error != DLogger_format_errorE::STAR_NOT_INTEGER, "DLogger: '*' width or precision must be integer");
+    static_assert(error != DLogger_format_errorE::UNSUPPORTED_TYPE, "DLogger: type of argument is not supported");
+    static_assert(error != DLogger_format_errorE::INTEGER_EXPECTED, "DLogger: integer expected for conversion");
+    static_assert(error != DLogger_format_errorE::FLOATING_EXPECTED, "DLogger: floating point expected for conversion");
+    static_assert(error != DLogger_format_errorE::STRING_EXPECTED, "DLogger: string expected for %s");
+    static_assert(error != DLogger_format_errorE::POINTER_EXPECTED, "DLogger: pointer expected for %p");
+    static_assert(error != DLogger_format_errorE::STRING_PRECISION, "DLogger: precision of std::string is not supported");
+
+    if constexpr (error == DLogger_format_errorE::NONE)
+    {
+        if (__dlogger_is_callsite_enabled(callsite_p) == 0)
+        {
+            return;
+        }
+
+        constexpr std::size_t number_of_conversions = __dlogger_parsed_format<FormatT>.number_of_conversions;
+
+        DLogger_messageS message = { __dlogger_thread_buffer(), 0, DLOGGER_MESSAGE_BUFFER_SIZE, 0 };
+        __dlogger_format_message<FormatT>(message, std::make_index_sequence<number_of_conversions>{}, args...);
+
+        if (message.full_size == message.size)
+        {
+            __dlogger_print_raw(callsite_p, message.data_p, message.size);
+            return;
+        }
+
+        /* Long message is formatted again into run of record arena chunks, snprintf needs place for terminating null. */
+        const std::size_t long_buffer_size = message.full_size + 1;
+        char* const long_buffer_p = __dlogger_arena_take(long_buffer_size);
+
+        if (long_buffer_p == nullptr)
+        {
+            __dlogger_arena_count_truncated();
+            __dlogger_print_raw(callsite_p, message.data_p, message.size);
+            return;
+        }
+
+        DLogger_messageS long_message = { long_buffer_p, 0, long_buffer_size, 0 };
+        __dlogger_format_message<FormatT>(long_message, std::make_index_sequence<number_of_conversions>{}, args...);
+
+        __dlogger_print_raw(callsite_p, long_message.data_p, long_message.size);
+        __dlogger_arena_release(long_buffer_p, long_buffer_size);
+    }
+}
+
+} /* namespace dlogger::priv */
+
+
+#define DLOGGER_PRIV_FIRST_ARGUMENT(first, ...) first
+
+/*
+ * GCC ignores section of statics in templates and does not allow statics of inline functions (member functions
+ * defined in class) with other statics in one section. Call-sites of C++ are registered in run-time instead.
+ */
+#undef dlogger_priv_define_callsite
+#define dlogger_priv_define_callsite(variable, log_level) \
+    static DLogger_callsite_nodeS DLOGGER_PRIV_CONCAT(variable, _node) = \
+        { { __FILE__, __func__, __LINE__, log_level, DLOGGER_PRIV_CALLSITE_DEFAULT, 1 }, nullptr, 0 }; \
+    DLogger_callsiteS& variable = ::dlogger::priv::__dlogger_get_callsite(DLOGGER_PRIV_CONCAT(variable, _node))
+
+/* Format is wrapped into local type, so it can be parsed at compile time by templates. */
+#define dlogger_priv_cpp_format(format) \
+    [] \
+    { \
+        struct DLogger_format_literalS \
+        { \
+            static constexpr std::string_view value() { return format; } \
+        }; \
+        return DLogger_format_literalS{}; \
+    }()
+
+/* Macros of dlogger.h expand dlogger_priv_log_general at use, so all of them use C++ front-end now. */
+#undef dlogger_priv_log_general
+#define dlogger_priv_log_general(log_level, ...) \
+    dlogger_priv_log_callsite(log_level, \
+                              ::dlogger::priv::__dlogger_print_message(&__dlogger_callsite, \
+                                  dlogger_priv_cpp_format(DLOGGER_PRIV_FIRST_ARGUMENT(__VA_ARGS__, ~)), __VA_ARGS__))
+
+#endif /* DLOGGER_HPP */
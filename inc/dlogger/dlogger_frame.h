@@ -0,0 +1,109 @@
+#ifndef DLOGGER_FRAME_H
+#define DLOGGER_FRAME_H
+
+
+/*
+    This is the header of framed file format of DLogger library (DLOGGER_OPTION_MARK_FRAMED).
+    Use it to read framed log files without DLogger tools.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Each record is written as one frame: header followed by text of record (the same text as in not framed file).
+    Record longer than DLOGGER_FRAME_MAX_LENGTH is split into consecutive frames, their payloads give whole text.
+    All fields are little-endian.
+
+    +--------+--------+----------+-------------+------------+----------------------+
+    | magic  | length | sequence | payload_crc | header_crc | payload (length B)   |
+    | 4 B    | 4 B    | 8 B      | 4 B         | 4 B        |                      |
+    +--------+--------+----------+-------------+------------+----------------------+
+
+    header_crc covers first 20 bytes of header, so length is validated in O(1) before payload is touched.
+    payload_crc covers payload. Both are CRC32C (Castagnoli). Torn write after crash or power loss leaves
+    frame whose header or payload does not match CRC. Reader skips it and searches next magic.
+*/
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+#define DLOGGER_FRAME_MAGIC        (0x46474c44U) /* "DLGF" in file. */
+#define DLOGGER_FRAME_HEADER_SIZE  (24U)
+#define DLOGGER_FRAME_MAX_LENGTH   (1U << 30)    /* longer length is treated as corrupted header. */
+
+
+typedef struct DLogger_frame_headerS
+{
+    uint32_t magic;       /* DLOGGER_FRAME_MAGIC. */
+    uint32_t length;      /* size of payload in bytes. */
+    uint64_t sequence;    /* number of frame, increasing in order of logging calls of one thread, unique in file. */
+    uint32_t payload_crc; /* CRC32C of payload. */
+    uint32_t header_crc;  /* CRC32C of magic, length, sequence and payload_crc. */
+} DLogger_frame_headerS;
+
+
+typedef enum DLogger_frame_statusE
+{
+    DLOGGER_FRAME_VALID,     /* frame is correct. */
+    DLOGGER_FRAME_END,       /* no more data. */
+    DLOGGER_FRAME_TRUNCATED, /* header is correct, but file ends before end of payload (torn tail). */
+    DLOGGER_FRAME_CORRUPTED, /* header or payload does not match CRC. */
+} DLogger_frame_statusE;
+
+
+/*
+ * This function calculate CRC32C. Instruction crc32 from SSE4.2 is used if CPU supports it, otherwise table.
+ *
+ * @param[in] crc    - CRC of previous data or 0 for first part.
+ * @param[in] data_p - data.
+ * @param[in] size   - size of data.
+ *
+ * @return - CRC32C of previous data and @data_p.
+ */
+uint32_t dlogger_frame_crc32c(uint32_t crc, const void* data_p, size_t size);
+
+
+/*
+ * This function fill header of frame.
+ *
+ * @param[out] header_p    - header to fill, ready to be written before payload.
+ * @param[in]  length      - size of payload.
+ * @param[in]  sequence    - number of record.
+ * @param[in]  payload_crc - CRC32C of payload.
+ *
+ * @return - void.
+ */
+void dlogger_frame_make_header(DLogger_frame_headerS* header_p, uint32_t length, uint64_t sequence, uint32_t payload_crc);
+
+
+/*
+ * This function read frame which starts at @begin_p.
+ *
+ * @param[in]  begin_p    - first byte of frame.
+ * @param[in]  end_p      - end of data.
+ * @param[out] header_p   - header of frame, filled if status is DLOGGER_FRAME_VALID or DLOGGER_FRAME_TRUNCATED.
+ * @param[out] payload_pp - payload of frame, set if status is DLOGGER_FRAME_VALID.
+ *
+ * @return - status of frame.
+ */
+DLogger_frame_statusE dlogger_frame_read(const char* begin_p, const char* end_p, DLogger_frame_headerS* header_p,
+                                         const char** payload_pp);
+
+
+/*
+ * This function find next frame with correct header after corrupted data.
+ *
+ * @param[in] begin_p - first byte to search.
+ * @param[in] end_p   - end of data.
+ *
+ * @return - first byte of next frame with correct header, @end_p if there is not such frame.
+ */
+const char* dlogger_frame_resync(const char* begin_p, const char* end_p);
+
+
+#endif /* DLOGGER_FRAME_H */
@@ -2,6 +2,7 @@
 #define DLOGGER_PRIV_H
 
 
+#include <stddef.h>
 #include <stdint.h>
 
 
@@ -37,28 +38,235 @@ typedef enum DLogger_options_writeE
 typedef uint32_t DLogger_options_markE;
 #define DLOGGER_PRIV_OPTION_MARK_TIMESTAMP (1 << 0)
 #define DLOGGER_PRIV_OPTION_MARK_THREADID  (1 << 1)
+#define DLOGGER_PRIV_OPTION_MARK_RAW_BACKTRACE (1 << 2)
+#define DLOGGER_PRIV_OPTION_MARK_SUPPRESS_REPEATED (1 << 3)
+#define DLOGGER_PRIV_OPTION_MARK_PER_THREAD_FILE (1 << 4)
+#define DLOGGER_PRIV_OPTION_MARK_FRAMED (1 << 5)
 
 
+typedef enum DLogger_backpressureE
+{
+    DLOGGER_PRIV_BACKPRESSURE_BLOCK,
+    DLOGGER_PRIV_BACKPRESSURE_DROP_NEW,
+    DLOGGER_PRIV_BACKPRESSURE_DROP_BY_PRIORITY,
+    DLOGGER_PRIV_BACKPRESSURE_OVERWRITE_OLDEST,
+} DLogger_backpressureE;
+
+
+typedef enum DLogger_durabilityE
+{
+    DLOGGER_PRIV_DURABILITY_NONE,
+    DLOGGER_PRIV_DURABILITY_CRITICAL,
+    DLOGGER_PRIV_DURABILITY_GROUP_COMMIT,
+} DLogger_durabilityE;
+
+
+/* Positional initializer (order of DLogger_levelE), so header can be included from C++ too. */
 static const char* const dlogger_priv_level_strings[] = { 
-                                                          [DLOGGER_PRIV_LEVEL_FATAL]     = "FATAL", 
-                                                          [DLOGGER_PRIV_LEVEL_CRITICAL]  = "CRITICAL", 
-                                                          [DLOGGER_PRIV_LEVEL_ERROR]     = "ERROR", 
-                                                          [DLOGGER_PRIV_LEVEL_WARNING]   = "WARNING", 
-                                                          [DLOGGER_PRIV_LEVEL_INFO]      = "INFO", 
-                                                          [DLOGGER_PRIV_LEVEL_DEBUG]     = "DEBUG",
+                                                          "FATAL",      /* DLOGGER_PRIV_LEVEL_FATAL */
+                                                          "CRITICAL",   /* DLOGGER_PRIV_LEVEL_CRITICAL */
+                                                          "ERROR",      /* DLOGGER_PRIV_LEVEL_ERROR */
+                                                          "WARNING",    /* DLOGGER_PRIV_LEVEL_WARNING */
+                                                          "INFO",       /* DLOGGER_PRIV_LEVEL_INFO */
+                                                          "DEBUG",      /* DLOGGER_PRIV_LEVEL_DEBUG */
                                                         };
 
 
 
-void __attribute__(( __format__ (__printf__, 5, 6)) ) __dlogger_print(const char* restrict file_p, 
-                                                                      int line,
-                                                                      const char* restrict func_p, 
-                                                                      DLogger_levelE level,
-                                                                      const char * restrict format_p,
+typedef enum DLogger_callsite_stateE
+{
+    DLOGGER_PRIV_CALLSITE_DEFAULT,
+    DLOGGER_PRIV_CALLSITE_ON,
+    DLOGGER_PRIV_CALLSITE_OFF,
+} DLogger_callsite_stateE;
+
+
+/*
+ * Each expansion of logging functionlike macro register one call-site record in dedicated ELF section. Linker
+ * provides symbols __start_dlogger_callsites and __stop_dlogger_callsites, so library can iterate over all of them.
+ * Fields state and enabled are accessed only by atomic builtins (DLogger_callsite_stateE stored as unsigned char).
+ * Field enabled is computed from state and level of the most verbose descriptor, so logging macros test one byte.
+ */
+typedef struct DLogger_callsiteS
+{
+    const char* file_p;
+    const char* func_p;
+    int line;
+    DLogger_levelE level;
+    unsigned char state;
+    unsigned char enabled;
+} DLogger_callsiteS;
+
+
+/*
+ * Call-site registered in run-time, at the first execution. It is used by C++ front-end, because GCC ignores
+ * section of statics in templates and does not allow statics of inline functions and other statics in one section.
+ */
+typedef struct DLogger_callsite_nodeS
+{
+    DLogger_callsiteS callsite;
+    struct DLogger_callsite_nodeS* next_p;
+    unsigned char is_registered;
+} DLogger_callsite_nodeS;
+
+
+#define DLOGGER_PRIV_CALLSITE_SECTION dlogger_callsites
+#define DLOGGER_PRIV_STRINGIFY_HELPER(x) #x
+#define DLOGGER_PRIV_STRINGIFY(x) DLOGGER_PRIV_STRINGIFY_HELPER(x)
+
+#define DLOGGER_PRIV_CONCAT_HELPER(x, y) x##y
+#define DLOGGER_PRIV_CONCAT(x, y) DLOGGER_PRIV_CONCAT_HELPER(x, y)
+
+/* C++ has no restrict keyword, but GCC and Clang understand __restrict in both languages. */
+#ifdef __cplusplus
+#define DLOGGER_PRIV_RESTRICT __restrict
+#else
+#define DLOGGER_PRIV_RESTRICT restrict
+#endif
+
+
+/*
+ * Span of trace started by dlogger_trace_scope or dlogger_trace_begin. Lives on stack of caller (or in per-thread
+ * stack of library for begin/end pair), so starting of span does not allocate and does not take any lock.
+ */
+typedef struct DLogger_trace_spanS
+{
+    const DLogger_callsiteS* callsite_p;
+    const char* name_p;
+    uint64_t start_nsec;   /* monotonic time of start. */
+    unsigned int depth;    /* number of spans opened by thread before this one. */
+    unsigned char is_recorded;
+} DLogger_trace_spanS;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void __attribute__(( __format__ (__printf__, 2, 3)) ) __dlogger_print(const DLogger_callsiteS* DLOGGER_PRIV_RESTRICT callsite_p,
+                                                                      const char * DLOGGER_PRIV_RESTRICT format_p,
                                                                       ...);
 
 
-#define dlogger_priv_log_general(level, ...) __dlogger_print(__FILE__, __LINE__, __func__, level, __VA_ARGS__)
+void __dlogger_print_raw(const DLogger_callsiteS* DLOGGER_PRIV_RESTRICT callsite_p,
+                         const void* DLOGGER_PRIV_RESTRICT data_p,
+                         size_t size);
+
+DLogger_trace_spanS __dlogger_trace_begin(const DLogger_callsiteS* DLOGGER_PRIV_RESTRICT callsite_p,
+                                          const char* DLOGGER_PRIV_RESTRICT name_p);
+
+void __dlogger_trace_end(DLogger_trace_spanS* span_p);
+
+void __dlogger_trace_push(const DLogger_callsiteS* DLOGGER_PRIV_RESTRICT callsite_p,
+                          const char* DLOGGER_PRIV_RESTRICT name_p);
+
+void __dlogger_trace_pop(void);
+
+/* Metrics are implemented in separate translation unit, started and stopped by dlogger_create and dlogger_destroy. */
+int __dlogger_metrics_start(unsigned int period_sec);
+
+void __dlogger_metrics_stop(void);
+
+/* Handlers of fork called by pthread_atfork handlers of dlogger.c. Child starts without reporter thread. */
+void __dlogger_metrics_fork_prepare(void);
+
+void __dlogger_metrics_fork_parent(void);
+
+void __dlogger_metrics_fork_child(void);
+
+/*
+ * Write summaries of repeated messages whose period has passed. Called periodically by metrics reporter and writer
+ * thread of asynchronous logging, so summary does not wait for next record of descriptor.
+ */
+void __dlogger_flush_expired_repeated(void);
+
+/* Register call-site defined outside of section. State is set by the last matching dlogger_callsite_set. */
+void __dlogger_register_callsite(DLogger_callsite_nodeS* node_p);
+
+void __dlogger_callsite_fork_prepare(void);
+
+void __dlogger_callsite_fork_parent(void);
+
+void __dlogger_callsite_fork_child(void);
+
+/* Free rules saved by dlogger_callsite_set. Called by dlogger_destroy, states of call-sites are kept. */
+void __dlogger_callsite_destroy(void);
+
+/*
+ * Recompute field enabled of all call-sites after change of __dlogger_max_level. Only atomic operations are used,
+ * so it can be called by signal handler.
+ */
+void __dlogger_callsite_refresh_all(void);
+
+
+/* Used by C++ front-end to skip formatting of message, which would not be written anyway. */
+int __dlogger_is_callsite_enabled(const DLogger_callsiteS* callsite_p);
+
+/*
+ * Record arena mapped by dlogger_create. Buffer of at least @size bytes keeps long message only until record is
+ * written, caller waits while chunks are taken by other records. NULL means that arena is not mapped or memory for
+ * record bigger than arena could not be mapped, then record should be truncated.
+ */
+char* __dlogger_arena_take(size_t size);
+
+void __dlogger_arena_release(char* buffer_p, size_t size);
+
+void __dlogger_arena_count_truncated(void);
+
+/*
+ * Level of the most verbose descriptor, -1 without descriptors. Updated by dlogger.c whenever level of any
+ * descriptor changes, field enabled of call-sites is recomputed from it.
+ */
+extern int __dlogger_max_level;
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * Define static call-site record @variable in dedicated section.
+ * Alignment is forced to keep records as an array in section (compiler might increase alignment of big objects).
+ */
+#define dlogger_priv_define_callsite(variable, log_level) \
+    static DLogger_callsiteS variable \
+        __attribute__(( section(DLOGGER_PRIV_STRINGIFY(DLOGGER_PRIV_CALLSITE_SECTION)), used, aligned(8) )) = \
+        { \
+            .file_p = __FILE__, \
+            .func_p = __func__, \
+            .line = __LINE__, \
+            .level = log_level, \
+            .state = DLOGGER_PRIV_CALLSITE_DEFAULT, \
+            .enabled = 1, \
+        }
+
+/*
+ * Is record of @callsite written by any descriptor? Field enabled is recomputed whenever level of the most verbose
+ * descriptor or state of call-site changes. It is only a fast filter, descriptors are checked one by one later.
+ */
+#define dlogger_priv_is_callsite_active(callsite) \
+    (__atomic_load_n(&(callsite).enabled, __ATOMIC_RELAXED) != 0)
+
+/*
+ * Register call-site and execute @call only if call-site is active. @call can use __dlogger_callsite.
+ * Arguments of record are part of @call, so disabled record costs one branch and its arguments are not evaluated.
+ * Logging is expected to be rare on hot path, so @call is placed out of line.
+ */
+#define dlogger_priv_log_callsite(log_level, call) \
+    do \
+    { \
+        dlogger_priv_define_callsite(__dlogger_callsite, log_level); \
+        \
+        if (__builtin_expect(dlogger_priv_is_callsite_active(__dlogger_callsite), 0)) \
+        { \
+            call; \
+        } \
+    } while (0)
+
+#define dlogger_priv_log_general(log_level, ...) \
+    dlogger_priv_log_callsite(log_level, __dlogger_print(&__dlogger_callsite, __VA_ARGS__))
+
+#define dlogger_priv_log_raw(log_level, data_p, size) \
+    dlogger_priv_log_callsite(log_level, __dlogger_print_raw(&__dlogger_callsite, data_p, size))
 
 #define dlogger_priv_log_fatal(...)    dlogger_priv_log_general(DLOGGER_PRIV_LEVEL_FATAL, __VA_ARGS__)
 #define dlogger_priv_log_critical(...) dlogger_priv_log_general(DLOGGER_PRIV_LEVEL_CRITICAL, __VA_ARGS__)
@@ -67,4 +275,25 @@ void __attribute__(( __format__ (__printf__, 5, 6)) ) __dlogger_print(const char
 #define dlogger_priv_log_info(...)     dlogger_priv_log_general(DLOGGER_PRIV_LEVEL_INFO, __VA_ARGS__)
 #define dlogger_priv_log_debug(...)    dlogger_priv_log_general(DLOGGER_PRIV_LEVEL_DEBUG, __VA_ARGS__)
 
+/*
+ * Span ends by cleanup attribute when variable goes out of scope (return, break, goto too). __COUNTER__ gives
+ * unique names, so more spans can be opened in one scope.
+ */
+#define dlogger_priv_trace_scope_helper(name, id) \
+    dlogger_priv_define_callsite(DLOGGER_PRIV_CONCAT(__dlogger_trace_callsite_, id), DLOGGER_PRIV_LEVEL_DEBUG); \
+    DLogger_trace_spanS DLOGGER_PRIV_CONCAT(__dlogger_trace_span_, id) __attribute__(( cleanup(__dlogger_trace_end) )) = \
+        __dlogger_trace_begin(&DLOGGER_PRIV_CONCAT(__dlogger_trace_callsite_, id), name)
+
+#define dlogger_priv_trace_scope(name) dlogger_priv_trace_scope_helper(name, __COUNTER__)
+
+/* Begin is pushed even for disabled call-site, so every end pops its own begin. */
+#define dlogger_priv_trace_begin(name) \
+    do \
+    { \
+        dlogger_priv_define_callsite(__dlogger_callsite, DLOGGER_PRIV_LEVEL_DEBUG); \
+        __dlogger_trace_push(&__dlogger_callsite, name); \
+    } while (0)
+
+#define dlogger_priv_trace_end() __dlogger_trace_pop()
+
 #endif /* DLOGGER_PRIV_H */
@@ -1,35 +1,319 @@
+#define _GNU_SOURCE /* dl_iterate_phdr, dladdr1, pthread_setaffinity_np */
+
 #include <dlogger/dlogger.h>
+#include <dlogger/dlogger_frame.h>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
 #include <sys/syscall.h>
+#include <sys/mman.h>
+#include <linux/futex.h>
+#include <sys/uio.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <stdatomic.h>
+#include <stdalign.h>
 #include <execinfo.h>
+#include <link.h>
+#include <dlfcn.h>
 #include <stdbool.h>
 #include <threads.h>
+#include <time.h>
+#include <strings.h>
 #include <string.h>
+#include <signal.h>
 #include <stdarg.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
 
 
 #define DLOGGER_MAX_NR_OF_FD (3ULL)
 
+/* During long series of repeated messages summary is written at least once per this period. */
+#define DLOGGER_REPEATED_SUMMARY_PERIOD_SEC (5)
+
+/* Size of data in one block of asynchronous queue. Record takes as many blocks as it needs. */
+#define DLOGGER_ASYNC_BLOCK_SIZE (256ULL)
+
+/* Notice about records dropped by asynchronous queue is written at most once per this period. */
+#define DLOGGER_DROPPED_NOTICE_PERIOD_SEC (1)
+
+/* Maximum number of spans opened by dlogger_trace_begin in one thread, deeper spans are not recorded. */
+#define DLOGGER_TRACE_MAX_DEPTH (64U)
+
+/* Size of data in one slot of shared ring of multi-process logging. Record takes as many slots as it needs. */
+#define DLOGGER_SHARED_SLOT_SIZE (256ULL)
+
+/* Maximum number of slots written by collector in one system call. */
+#define DLOGGER_SHARED_MAX_IOV (256)
+
+/* Files of threads for DLOGGER_OPTION_MARK_PER_THREAD_FILE are preallocated, further threads write into unique file. */
+#define DLOGGER_MAX_THREAD_FILES (1024U)
+
+/* Sleep on futex of shared ring is limited, so stop or death of collector is noticed. */
+#define DLOGGER_SHARED_WAIT_NSEC (100000000L)
+
+/* Record reserved and not published for this time is skipped if its producer is unknown or collector is stopping. */
+#define DLOGGER_SHARED_RESERVATION_TIMEOUT_NSEC (1000000000LL)
+
+/* Default record arena: chunks for messages longer than per-thread buffer and for list of loaded modules. */
+#define DLOGGER_ARENA_DEFAULT_CHUNKS     (8ULL)
+#define DLOGGER_ARENA_DEFAULT_CHUNK_SIZE (1ULL << 20)
+
+#define DLOGGER_CACHE_LINE (64U)
+
+
+/* Options of one descriptor. */
+typedef struct DLogger_descriptor_optionsS
+{
+    bool is_filled : 1;          /* Are we able to use this these options for this file descriptor? */
+
+    int file_descriptor;         /* Available file descriptors: stdout, stderr, unique file. */
+
+    DLogger_levelE level;        /* Level of logging. */
+
+    DLogger_options_markE marks; /* Additional options (timestamp, thread id) combined by bitwise OR. */
+} DLogger_descriptor_optionsS;
+
+
+/* Options of writer thread of asynchronous logging. */
+typedef struct DLogger_writer_optionsS
+{
+    unsigned int spin_usec;   /* How long writer spins on empty queue before it sleeps on futex. */
+    size_t batch_size;        /* Maximum number of records written at once, 0 means whole queue. */
+    unsigned int linger_usec; /* How long writer waits for full batch before it writes smaller one. */
+
+    int cpu;                  /* CPU for writer thread, -1 means any. */
+    int numa_node;            /* NUMA node for writer thread (all its CPUs), -1 means any. */
+    int sched_policy;         /* Scheduling policy of writer thread (SCHED_OTHER, SCHED_FIFO, ...). */
+    int sched_priority;       /* Scheduling priority for real-time policies. */
+} DLogger_writer_optionsS;
+
+
+typedef struct DLogger_durability_optionsS
+{
+    DLogger_durabilityE durability; /* When records of file are synchronized with disk. */
+    unsigned int period_msec;       /* DLOGGER_DURABILITY_GROUP_COMMIT: synchronize at least every period, 0 means never. */
+    size_t max_bytes;               /* DLOGGER_DURABILITY_GROUP_COMMIT: synchronize when so many bytes are not synced, 0 means never. */
+} DLogger_durability_optionsS;
+
 
 struct DLogger_user_optionsS
 {
-    bool is_filled : 1;   /* Are we able to use this these options for this file descriptor? */
+    DLogger_descriptor_optionsS descriptors[DLOGGER_MAX_NR_OF_FD]; /* Options for each descriptor. */
 
-    int file_descriptor;  /* Available file descriptors: stdout, stderr, unique file. */
+    size_t queue_size;                  /* Size of asynchronous queue in bytes, 0 means synchronous logging. */
+
+    DLogger_backpressureE backpressure; /* Policy when asynchronous queue is full. */
+
+    DLogger_writer_optionsS writer;     /* Options of writer thread. */
 
-    DLogger_levelE level; /* Level of logging. */
+    char trace_path[PATH_MAX];          /* Path to Chrome trace file, empty means spans are written as records. */
 
-    bool timestamp : 1;   /* Timestamp should be collected for messages? */
-    bool threadid : 1;    /* Thread ID should be collected for messages? */
+    unsigned int metrics_period_sec;    /* Period of metrics reports, 0 means no reporter thread. */
+
+    DLogger_durability_optionsS durability; /* When records of file are synchronized with disk. */
+
+    size_t shared_ring_size;            /* Size of ring shared by processes in bytes, 0 means multi-process mode is disabled. */
+
+    size_t arena_chunks;                /* Number of chunks of record arena, 0 means default. */
+    size_t arena_chunk_size;            /* Size of one chunk of record arena in bytes, 0 means default. */
 };
 
 
+/* Block of asynchronous queue. Blocks are preallocated, record is linked list of blocks. */
+typedef struct DLogger_async_blockS
+{
+    struct DLogger_async_blockS* next_p; /* next block of the same record or next free block. */
+    size_t size;                         /* number of used bytes in data. */
+    char data[DLOGGER_ASYNC_BLOCK_SIZE];
+} DLogger_async_blockS;
+
+
+/* Record in asynchronous queue. Header of record is stored in table at index of its first block. */
+typedef struct DLogger_async_recordS
+{
+    struct DLogger_async_recordS* older_p;       /* previous record in queue. */
+    struct DLogger_async_recordS* newer_p;       /* next record in queue. */
+    struct DLogger_async_recordS* level_older_p; /* previous record with the same level. */
+    struct DLogger_async_recordS* level_newer_p; /* next record with the same level. */
+
+    DLogger_async_blockS* first_block_p;         /* data of record. */
+    size_t number_of_blocks;
+
+    int file_descriptor;                         /* where record will be written. */
+    DLogger_levelE level;
+    uint64_t sequence;                           /* number of record, used to wait for FATAL records. */
+    bool is_log_file;                            /* is record written into log file, so durability applies? */
+} DLogger_async_recordS;
+
+
+/* Descriptor used in run-time. Level and marks are atomics to allow changing them without lock. */
+typedef struct DLogger_descriptorS
+{
+    bool is_filled;       /* Are we able to use this descriptor? */
+
+    int file_descriptor;  /* Available file descriptors: stdout, stderr, unique file. */
+
+    atomic_int level;     /* Level of logging (DLogger_levelE). */
+
+    atomic_uint marks;    /* Additional options (DLogger_options_markE). */
+
+    struct
+    {
+        const DLogger_callsiteS* callsite_p; /* call-site of last written message, NULL if there is no such message. */
+        uint64_t hash;                       /* hash of last written message. */
+        size_t message_size;                 /* size of last written message. */
+        size_t counter;                      /* number of suppressed copies since last summary. */
+        time_t first_suppressed_sec;         /* monotonic time of first suppressed copy since last summary. */
+    } repeated;           /* State of DLOGGER_OPTION_MARK_SUPPRESS_REPEATED, protected by main mutex. */
+} DLogger_descriptorS;
+
+
+/* Queue of asynchronous logging with writer thread. */
+typedef struct DLogger_async_queueS
+{
+    bool is_running;                     /* is asynchronous logging enabled and writer thread running? */
+    DLogger_backpressureE backpressure;  /* policy when queue is full. */
+    DLogger_writer_optionsS options;     /* options of writer thread. */
+    thrd_t thread;                       /* writer thread. */
+
+    /*
+     * Futex word, incremented on every push. Writer spins on it and then sleeps on it by futex. Producers call
+     * futex wake only when writer really sleeps, so there is no system call per record when writer is busy.
+     */
+    atomic_uint wakeup;
+
+    mtx_t mutex;                         /* protects all fields below. */
+    bool is_stopping;                    /* writer thread should write all records and exit. */
+    bool is_parked;                      /* is writer thread sleeping on futex? */
+    cnd_t not_full;                      /* signaled when blocks are released. */
+    cnd_t written;                       /* signaled when records are written. */
+
+    DLogger_async_blockS* blocks_p;      /* preallocated blocks. */
+    DLogger_async_recordS* records_p;    /* headers of records, one per block. */
+    DLogger_async_blockS* free_blocks_p; /* list of free blocks. */
+    size_t number_of_blocks;
+    size_t number_of_free_blocks;
+
+    DLogger_async_recordS* oldest_p;     /* queue of records waiting for writer thread. */
+    DLogger_async_recordS* newest_p;
+    size_t number_of_records;
+    DLogger_async_recordS* level_oldest_p[DLOGGER_LEVEL_MAX + 1]; /* the same records per level, for eviction. */
+    DLogger_async_recordS* level_newest_p[DLOGGER_LEVEL_MAX + 1];
+
+    uint64_t pushed_sequence;            /* sequence of the newest pushed record. */
+    uint64_t written_sequence;           /* all records up to this sequence are written. */
+
+    size_t dropped[DLOGGER_LEVEL_MAX + 1];       /* dropped records since last notice. */
+    size_t total_dropped[DLOGGER_LEVEL_MAX + 1]; /* dropped records since dlogger_create. */
+    time_t next_notice_sec;                      /* monotonic time when notice can be written. */
+} DLogger_async_queueS;
+
+
+/* Synchronization of log files with disk. */
+typedef struct DLogger_durabilityS
+{
+    DLogger_durability_optionsS options;
+    atomic_size_t unsynced_bytes; /* bytes written into log files since last group commit. */
+
+    bool is_running;              /* is group commit thread running? */
+    thrd_t thread;                /* thread which calls fdatasync for all records written in period. */
+    mtx_t mutex;                  /* protects all fields below. */
+    cnd_t wake_up;                /* signaled when group commit is requested or thread should exit. */
+    cnd_t synced;                 /* signaled after each group commit. */
+    bool is_stopping;             /* group commit thread should exit. */
+    uint64_t requested_commit;    /* number of the newest requested group commit. */
+    uint64_t finished_commit;     /* all group commits up to this number are finished. */
+} DLogger_durabilityS;
+
+
+/* Slot of ring shared by processes. Fields after size are valid only in the first slot of record. */
+typedef struct DLogger_shared_slotS
+{
+    atomic_uint_fast64_t sequence;    /* position of record + 1 when record is published, set in the first slot. */
+    atomic_uint_fast64_t reservation; /* position of record + 1 right after reservation, set in the first slot. */
+    uint32_t size;                    /* number of used bytes in data. */
+    pid_t process_id;                 /* producer of record, collector skips record of killed process. */
+    uint32_t number_of_slots;         /* number of slots of record, set before reservation. */
+    int32_t descriptor_index;         /* DLogger_options_writeE of descriptor where record is written. */
+    int32_t level;                    /* DLogger_levelE of record. */
+    char data[DLOGGER_SHARED_SLOT_SIZE];
+} DLogger_shared_slotS;
+
+
+/*
+ * Ring shared by processes (MAP_SHARED mapping inherited by fork). Producers of all processes reserve consecutive
+ * positions by CAS, single collector writes records in order of positions. Position p is stored in slot
+ * p % number_of_slots, positions are never wrapped. Futex words are not private, waiters are in other processes.
+ */
+typedef struct DLogger_shared_ringS
+{
+    alignas(DLOGGER_CACHE_LINE) atomic_uint_fast64_t reserved_position; /* first position not reserved by producers. */
+
+    alignas(DLOGGER_CACHE_LINE) atomic_uint_fast64_t written_position;  /* all records before this position are written. */
+    atomic_uint released;                 /* futex word, incremented when collector frees slots. */
+    atomic_uint number_of_waiters;        /* producers sleeping on released, futex wake is called only for them. */
+
+    alignas(DLOGGER_CACHE_LINE) atomic_uint published; /* futex word, incremented when producer publishes record. */
+    atomic_uint is_collector_parked;                   /* is collector sleeping on published? */
+
+    alignas(DLOGGER_CACHE_LINE) atomic_uint_fast64_t frame_sequence; /* number of last frame of all processes. */
+
+    atomic_bool is_collecting;            /* false when collector is stopped, producers write records directly. */
+    pid_t collector_process_id;           /* checked by waiting producers, collector might be killed. */
+    size_t number_of_slots;
+    DLogger_shared_slotS slots[];
+} DLogger_shared_ringS;
+
+
+/* Records taken from shared ring by collector and written by one system call. */
+typedef struct DLogger_shared_batchS
+{
+    struct iovec iov[DLOGGER_SHARED_MAX_IOV];
+    int iovcnt;
+    size_t descriptor_index; /* all records of batch are written into the same descriptor. */
+    DLogger_levelE level;    /* the most important level of records in batch. */
+    size_t size;
+} DLogger_shared_batchS;
+
+
+/* Own file of thread for DLOGGER_OPTION_MARK_PER_THREAD_FILE. Slots are preallocated in DLogger_dataS. */
+typedef struct DLogger_thread_fileS
+{
+    struct DLogger_thread_fileS* next_p; /* next opened file of other thread or next free slot. */
+    int file_descriptor;                 /* -1 if file could not be opened, then unique file is used. */
+} DLogger_thread_fileS;
+
+
+/*
+ * Arena of chunks for per-record storage which does not fit into per-thread buffer: long messages and list of loaded
+ * modules. Chunks are mapped in dlogger_create, so records never call malloc. Long message takes run of adjacent chunks, which is one
+ * buffer for vsnprintf. When no run is free, caller waits until other record releases its run.
+ * Every thread holds at most one run and never waits while holding it, so waiting cannot deadlock.
+ */
+typedef struct DLogger_arenaS
+{
+    char* memory_p;           /* chunks followed by flags of taken chunks, NULL if arena is not mapped. */
+    size_t mapping_size;
+    size_t chunk_size;
+    size_t number_of_chunks;
+    bool* is_taken_p;         /* flag of each chunk, true if chunk belongs to run of some record. */
+    mtx_t mutex;              /* protects flags, held only to find or release run, never while formatting. */
+    cnd_t released;           /* signaled when run is released. */
+    atomic_size_t truncated;  /* records truncated since dlogger_create, because memory could not be mapped. */
+} DLogger_arenaS;
+
+
 typedef struct DLogger_dataS
 {
     struct
@@ -40,15 +324,124 @@ typedef struct DLogger_dataS
 
     struct
     {
-        /* user options for logging */
-        DLogger_user_optionsS user_options[DLOGGER_MAX_NR_OF_FD];
+        /* descriptors for logging created from user options */
+        DLogger_descriptorS descriptors[DLOGGER_MAX_NR_OF_FD];
     };
+
+    struct
+    {
+        int signal_more_verbose;                 /* signal which increase level of logging, 0 if not installed. */
+        int signal_less_verbose;                 /* signal which decrease level of logging, 0 if not installed. */
+        struct sigaction old_more_verbose_action; /* handler to restore in dlogger_destroy. */
+        struct sigaction old_less_verbose_action; /* handler to restore in dlogger_destroy. */
+    } signals;
+
+    struct
+    {
+        bool is_watching;             /* is watcher thread running? */
+        thrd_t thread;                /* thread which wait for changes of configuration file. */
+        int inotify_fd;               /* inotify instance which watch directory of configuration file. */
+        int stop_fd;                  /* eventfd used to wake up and stop watcher thread. */
+        char path[PATH_MAX];          /* path to configuration file. */
+    } watcher;
+
+    DLogger_async_queueS async; /* queue of asynchronous logging. */
+
+    DLogger_durabilityS durability; /* synchronization of log files with disk. */
+
+    struct
+    {
+        bool is_filled;        /* are spans written into Chrome trace file? */
+        int file_descriptor;   /* trace file opened with O_APPEND, each event is written by one write. */
+        uint64_t origin_nsec;  /* monotonic time of dlogger_create, timestamps of events are relative to it. */
+        pid_t process_id;
+        bool is_owner;         /* only process which created trace file closes JSON array, forked children do not. */
+    } trace;
+
+    struct
+    {
+        char file_stem[1 << 6];        /* name of unique file without extension, base of names of thread files. */
+        bool is_key_created;           /* is key created correctly? */
+        tss_t key;                     /* key for DLogger_thread_fileS of calling thread, file is closed when thread exits. */
+        mtx_t mutex;                   /* protects lists of files, never held while waiting for other lock. */
+        DLogger_thread_fileS* files_p; /* all opened thread files. */
+        DLogger_thread_fileS* free_p;  /* slots not used by any thread. */
+        DLogger_thread_fileS missing;  /* shared by threads without free slot, they write into unique file. */
+        DLogger_thread_fileS slots[DLOGGER_MAX_THREAD_FILES];
+    } thread_files;
+
+    struct
+    {
+        bool is_enabled;               /* are records of file written as frames? Fixed in dlogger_create. */
+        atomic_uint_fast64_t sequence; /* number of last frame, in multi-process mode counter of shared ring is used. */
+    } frame;
+
+    struct
+    {
+        DLogger_shared_ringS* ring_p; /* ring of multi-process logging, NULL if records are written by caller process. */
+        size_t mapping_size;
+        bool is_collector;            /* is collector thread running in this process? False in forked children. */
+        pid_t process_id;             /* cached id of this process, written into reserved slots. */
+        atomic_bool is_stopping;      /* collector thread should write all reserved records and exit. */
+        thrd_t thread;                /* collector thread. */
+    } shared;
+
+    DLogger_arenaS arena; /* preallocated storage of long records and backtraces. */
 } DLogger_dataS;
 
 
+/* Backtrace of FATAL record. Only variants needed by enabled descriptors are formatted. */
+typedef struct DLogger_backtraceS
+{
+    const char* symbols_p; /* backtrace with symbols resolved by dladdr1. */
+    size_t symbols_size;
+
+    const char* raw_p;     /* backtrace with raw return addresses. */
+    size_t raw_size;
+} DLogger_backtraceS;
+
+
+/* Buffer used by callback of dl_iterate_phdr to save list of modules. */
+typedef struct DLogger_modules_bufferS
+{
+    char* buffer_p;
+    size_t buffer_size;
+    size_t buffer_index;
+} DLogger_modules_bufferS;
+
+
 static DLogger_dataS dlogger_priv_data;
 
 
+/* Logging macros are not filtered before dlogger_create, so they can report that DLogger is not initialized. */
+int __dlogger_max_level = DLOGGER_PRIV_LEVEL_MAX;
+
+
+static struct
+{
+    once_flag once; /* pthread_atfork is called only once for whole process, handlers cannot be unregistered. */
+    bool is_locked; /* have mutexes been locked by prepare handler? */
+} dlogger_priv_fork = { .once = ONCE_FLAG_INIT };
+
+
+/* State of trace spans of each thread. */
+static thread_local struct
+{
+    unsigned int depth;                               /* number of opened spans, also by dlogger_trace_scope. */
+    pid_t thread_id;                                  /* cached thread id, 0 if not read yet. */
+    size_t number_of_spans;                           /* number of spans opened by dlogger_trace_begin. */
+    DLogger_trace_spanS spans[DLOGGER_TRACE_MAX_DEPTH];
+} dlogger_priv_trace_thread;
+
+
+/* Set only in writer thread of asynchronous logging, which cannot wait for free space in own queue. */
+static thread_local bool dlogger_priv_is_async_writer;
+
+
+/* Set only in collector thread of multi-process logging, which writes own records directly between batches. */
+static thread_local bool dlogger_priv_is_shared_collector;
+
+
 /* 
  * This function generate timestamp and save into @buffer. 
  * There is one not available option: write date + microseconds, without hours, minuts, seconds. All other options are available.
@@ -108,494 +501,5105 @@ static size_t __dlogger_write_thread_id(size_t buffer_index, size_t buffer_size,
 
 
 /* 
- * This function save into @buffer backtrace from application.
+ * This function save into @buffer backtrace from application in format of backtrace_symbols. Symbols are resolved
+ * by dladdr1, so function does not allocate memory like backtrace_symbols does.
+ *
+ * @param[in]     buffer_index     - current buffer index where new data could be written.
+ * @param[in]     buffer_size      - size of buffer.
+ * @param[in/out] buffer           - pointer to first element of buffer.
+ * @param[in]     frames           - return addresses collected by backtrace.
+ * @param[in]     number_of_frames - number of return addresses.
+ * 
+ * @return - number of bytes written into @buffer.
+ */
+static size_t __dlogger_write_backtrace(size_t buffer_index, size_t buffer_size, char buffer[static 1],
+                                        void* const frames[static 1], int number_of_frames);
+
+
+/* 
+ * This function save into @buffer raw return addresses, one per line. Symbols are not resolved, so function
+ * is much faster than __dlogger_write_backtrace.
+ *
+ * @param[in]     buffer_index     - current buffer index where new data could be written.
+ * @param[in]     buffer_size      - size of buffer.
+ * @param[in/out] buffer           - pointer to first element of buffer.
+ * @param[in]     frames           - return addresses collected by backtrace.
+ * @param[in]     number_of_frames - number of return addresses.
+ * 
+ * @return - number of bytes written into @buffer.
+ */
+static size_t __dlogger_write_raw_backtrace(size_t buffer_index, size_t buffer_size, char buffer[static 1],
+                                            void* const frames[static 1], int number_of_frames);
+
+
+/*
+ * This function is callback for dl_iterate_phdr. Save into buffer one line per module: load bias, first and last
+ * address of loaded segments, build ID and path. These lines are needed by dlogger_symbolize.
+ *
+ * @param[in]     info_p - information about module.
+ * @param[in]     size   - size of @info_p.
+ * @param[in/out] data_p - pointer to DLogger_modules_bufferS.
+ *
+ * @return - always 0 to continue iteration.
+ */
+static int __dlogger_write_module(struct dl_phdr_info* info_p, size_t size, void* data_p);
+
+
+/*
+ * This function write list of loaded modules into descriptor. Called once for descriptor when raw backtrace is enabled.
+ *
+ * @param[in] descriptor_p - pointer to descriptor.
+ *
+ * @return - void.
+ */
+static void __dlogger_write_modules(const DLogger_descriptorS* descriptor_p);
+
+
+/*
+ * This function convert value returned by snprintf family into number of bytes really written into buffer.
+ * These functions return length of whole output even if it was truncated, so buffer index could pass end of buffer.
+ *
+ * @param[in] ret              - value returned by snprintf family.
+ * @param[in] buffer_size_left - size of buffer which has been passed to snprintf family.
+ *
+ * @return - number of bytes written into buffer (without null-terminated character).
+ */
+static size_t __dlogger_written_bytes(int ret, size_t buffer_size_left);
+
+
+/*
+ * This function save into @buffer null-terminated string.
  *
  * @param[in]     buffer_index - current buffer index where new data could be written.
  * @param[in]     buffer_size  - size of buffer.
  * @param[in/out] buffer       - pointer to first element of buffer.
- * 
+ * @param[in]     string_p     - pointer to string.
+ *
  * @return - number of bytes written into @buffer.
  */
-static size_t __dlogger_write_backtrace(size_t buffer_index, size_t buffer_size, char buffer[static 1]);
+static size_t __dlogger_write_string(size_t buffer_index, size_t buffer_size, char buffer[static 1], const char* restrict string_p);
 
 
 /*
- * This function will add into @buffer additional newline if user forget.
+ * This function save into @buffer prefix of record: level, timestamp, thread id, filename, line and function.
  *
  * @param[in]     buffer_index - current buffer index where new data could be written.
  * @param[in]     buffer_size  - size of buffer.
  * @param[in/out] buffer       - pointer to first element of buffer.
- * 
- * @return - void.
+ * @param[in]     callsite_p   - pointer to call-site of logging functionlike macro.
+ * @param[in]     marks        - additional options of descriptor.
+ *
+ * @return - number of bytes written into @buffer.
  */
-static void __dlogger_add_newline(size_t buffer_index, size_t buffer_size, char buffer[static 1]);
+static size_t __dlogger_write_prefix(size_t buffer_index, size_t buffer_size, char buffer[static 1],
+                                     const DLogger_callsiteS* restrict callsite_p, DLogger_options_markE marks);
 
 
 /*
- * This function will parse user options by using compund literals.
+ * This function map record arena and mark all its chunks as free.
  *
- * @param[in] descriptor_to_write - which descriptor options @level_of_logging and @additional_options will be written.
- * @param[in] level_of_logging    - level of logging for above @descriptor_to_write.
- * @param[in] additional_options  - additional options available in DLogger.
+ * @param[in] number_of_chunks - number of chunks, 0 means DLOGGER_ARENA_DEFAULT_CHUNKS.
+ * @param[in] chunk_size       - size of one chunk in bytes, 0 means DLOGGER_ARENA_DEFAULT_CHUNK_SIZE.
  *
- * @return - parsed input into DLogger_user_optionsS.
+ * @return 0 on succes, non-zero value on failure.
  */
-static inline DLogger_user_optionsS __dlogger_parse_user_option(DLogger_options_writeE descriptor_to_write,
-                                                                DLogger_levelE level_of_logging,
-                                                                DLogger_options_markE additional_options);
+static int __dlogger_arena_start(size_t number_of_chunks, size_t chunk_size);
 
 
-static size_t __dlogger_write_timestamp(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
-                                        const bool with_date, const bool with_h_min_sec, const bool with_usec)
-{
-    if (buffer_index >= buffer_size)
-    {
-        perror("DLogger: end of internal buffer");
-        return 0;
-    }
+/*
+ * This function mark all chunks of record arena as free. Used by dlogger_create and in forked child, where runs taken
+ * by threads of parent would be lost.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_arena_reset(void);
 
-    struct timeval timeval_now = {0};
-    register const int ret = gettimeofday(&timeval_now, NULL);
 
-    if (ret == -1)
-    {
-        perror("DLogger: error with function gettimeofday");
-        return 0;
-    }
+/*
+ * This function unmap record arena. Called when no record can use it anymore.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_arena_stop(void);
 
-    const struct tm *const restrict datetime_now_p = localtime(&timeval_now.tv_sec);
 
-    if (datetime_now_p == NULL)
-    {
-        perror("DLogger: error with function localtime");
-        return 0;
-    }
+/*
+ * This function write all parts of record by writev. Partial writes and interrupted calls are continued.
+ *
+ * @param[in]     file_descriptor - where record will be written.
+ * @param[in/out] iov             - parts of record, will be modified in case of partial write.
+ * @param[in]     iovcnt          - number of parts of record.
+ *
+ * @return - void.
+ */
+static void __dlogger_write_iov(int file_descriptor, struct iovec iov[static 1], int iovcnt);
 
-    register size_t written_bytes = buffer_index;
 
-    if (with_date == true)
-    {
-        register const char *const restrict fmt_date_p = "%Y:%m:%d";
-        written_bytes += strftime(&buffer[written_bytes], buffer_size - written_bytes, fmt_date_p, datetime_now_p);
-    }
+/*
+ * This function return file descriptor where record for descriptor should be written. For unique file with
+ * DLOGGER_OPTION_MARK_PER_THREAD_FILE it is own file of calling thread, opened at first record of thread.
+ *
+ * @param[in] descriptor_p - pointer to descriptor.
+ *
+ * @return - file descriptor.
+ */
+static int __dlogger_file_descriptor(const DLogger_descriptorS* descriptor_p);
 
-    if (with_h_min_sec == true)
-    {
-        register const char *const restrict fmt_h_min_sec_p = (with_date == true) ? "-%H:%M:%S" : "%H:%M:%S";
-        written_bytes += strftime(&buffer[written_bytes], buffer_size - written_bytes, fmt_h_min_sec_p, datetime_now_p);
 
-        if (with_usec == true)
-        {
-            register const char *const restrict fmt_usec_p = ".%ld";
-            written_bytes += (size_t)snprintf(&buffer[written_bytes], buffer_size - written_bytes, fmt_usec_p, (long)timeval_now.tv_usec);
-        }
-    }
+/*
+ * This function put all slots of thread files on list of free slots. Used by dlogger_create and in forked child,
+ * where files of parent threads are closed.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_reset_thread_files(void);
 
-    return written_bytes - buffer_index;
-}
 
+/*
+ * This function create own file of calling thread in free slot and register it, so dlogger_destroy can close it.
+ *
+ * @param[in] - void.
+ *
+ * @return pointer to registered file (its descriptor is -1 on failure or without free slot), NULL if it cannot be registered.
+ */
+static DLogger_thread_fileS* __dlogger_open_thread_file(void);
 
-static size_t __dlogger_write_level(const size_t buffer_index, const size_t buffer_size,
-                                    char buffer[const static 1], const DLogger_levelE level)
-{
-    if (buffer_index >= buffer_size)
-    {
-        perror("DLogger: end of internal buffer");
-        return 0;
-    }
 
-    /* 
-     * This aligment with spaces is necessary to start saving logger messages with proper offset. This is why we need to calculate 
-     * different between the longest level which is "CRITICAL" and the current level. 
-     *
-     * Example:
-     * [FATAL]    log message1
-     * [CRITICAL] log message2
-     * [ERROR]    log message3
-     * [WARNING]  log message4
-     */
-    register const size_t length_level_critical = strlen(dlogger_priv_level_strings[DLOGGER_LEVEL_CRITICAL]) + 1;
-    register const size_t length_level_current = strlen(dlogger_priv_level_strings[level]) + 1;
+/*
+ * This function close own file of exiting thread. Destructor of key for thread files.
+ *
+ * @param[in] file_p - pointer to DLogger_thread_fileS.
+ *
+ * @return - void.
+ */
+static void __dlogger_close_thread_file(void* file_p);
 
-    /* "+2" means - additional space after square bracket and for null-terminated character. */
-    register const size_t size = length_level_critical - length_level_current + 2;
-    char spaces_to_fill[size];
+
+/*
+ * This function close all thread files and delete key for them. Called by dlogger_destroy.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_close_thread_files(void);
+
+
+/*
+ * This function write whole record into descriptor by one writev call. Only this step is serialized: unique file
+ * is opened with O_APPEND so kernel keeps records from different threads separated, for standard streams
+ * main mutex is taken only for time of write. In asynchronous mode record is pushed into queue.
+ *
+ * @param[in]     descriptor_p - pointer to descriptor where record will be written.
+ * @param[in]     level        - level of record, used by policy of asynchronous queue.
+ * @param[in]     iov          - parts of record.
+ * @param[in]     iovcnt       - number of parts of record.
+ * @param[in]     with_lock    - should main mutex be taken for standard streams? False if caller already holds it.
+ *
+ * @return - void.
+ */
+static void __dlogger_write_record(const DLogger_descriptorS* descriptor_p, DLogger_levelE level, struct iovec iov[static 1], int iovcnt,
+                                   bool with_lock);
+
+
+/*
+ * This function return number of frames needed by record. Record longer than DLOGGER_FRAME_MAX_LENGTH is split.
+ *
+ * @param[in] descriptor_p - pointer to descriptor where record will be written.
+ * @param[in] size         - size of record.
+ *
+ * @return - number of frames, 1 if records of descriptor are not framed.
+ */
+static size_t __dlogger_number_of_frames(const DLogger_descriptorS* descriptor_p, size_t size);
+
+
+/*
+ * This function put record into frames if records of descriptor are framed (DLOGGER_OPTION_MARK_FRAMED).
+ *
+ * @param[in]  descriptor_p - pointer to descriptor where record will be written.
+ * @param[out] headers      - headers of frames, place for __dlogger_number_of_frames headers, must live until
+ *                            record is written.
+ * @param[out] framed_iov   - headers and parts of record, place for @iovcnt + 2 * number of frames parts.
+ * @param[in]  iov          - parts of record.
+ * @param[in]  iovcnt       - number of parts of record.
+ *
+ * @return - number of parts in @framed_iov.
+ */
+static int __dlogger_frame_record(const DLogger_descriptorS* descriptor_p, DLogger_frame_headerS headers[static 1],
+                                  struct iovec framed_iov[static 1], const struct iovec iov[static 1], int iovcnt);
+
+
+/*
+ * This function start group commit thread if it is needed by durability options.
+ *
+ * @param[in] options_p - durability options specified by user.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_durability_start(const DLogger_durability_optionsS* options_p);
+
+
+/*
+ * This function stop group commit thread and synchronize all log files with disk for the last time.
+ *
+ * @return - void.
+ */
+static void __dlogger_durability_stop(void);
+
+
+/*
+ * This function apply durability after record has been written into log file. Depending on durability
+ * it calls fdatasync, counts bytes for group commit or waits for group commit (FATAL).
+ *
+ * @param[in] file_descriptor - descriptor of log file where record has been written.
+ * @param[in] level           - level of record.
+ * @param[in] size            - size of record in bytes.
+ *
+ * @return - void.
+ */
+static void __dlogger_durability_after_write(int file_descriptor, DLogger_levelE level, size_t size);
+
+
+/*
+ * This function request group commit and wait until it is finished.
+ *
+ * @return - void.
+ */
+static void __dlogger_durability_wait_for_commit(void);
+
+
+/*
+ * This function synchronize unique file and all files of threads with disk by fdatasync.
+ *
+ * @return - void.
+ */
+static void __dlogger_durability_sync_files(void);
+
+
+/*
+ * This function is main function of group commit thread.
+ *
+ * @param[in] arg_p - not used.
+ *
+ * @return - 0.
+ */
+static int __dlogger_durability_thread(void* arg_p);
+
+
+/*
+ * This function calculate size of record.
+ *
+ * @param[in] iov    - parts of record.
+ * @param[in] iovcnt - number of parts of record.
+ *
+ * @return - size of record in bytes.
+ */
+static size_t __dlogger_iov_size(const struct iovec iov[static 1], int iovcnt);
+
+
+/*
+ * This function allocate blocks of asynchronous queue and start writer thread.
+ *
+ * @param[in] queue_size   - size of queue in bytes.
+ * @param[in] backpressure - policy when queue is full.
+ * @param[in] options_p    - options of writer thread.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_async_start(size_t queue_size, DLogger_backpressureE backpressure, const DLogger_writer_optionsS* options_p);
+
+
+/*
+ * This function wake up writer thread if it sleeps. Mutex of queue must be taken by caller.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_wake_up_writer(void);
+
+
+/*
+ * This function wait for new record. Writer spins for time set by user and then sleeps on futex.
+ * Mutex of queue must be taken by caller, it is released for time of waiting.
+ *
+ * @param[in] timeout_nsec - maximum time of waiting.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_wait(int64_t timeout_nsec);
+
+
+/*
+ * This function apply CPU affinity and scheduling policy for calling thread.
+ *
+ * @param[in] options_p - options of writer thread.
+ *
+ * @return - void. Errors are reported, but writer works without them.
+ */
+static void __dlogger_async_place_writer(const DLogger_writer_optionsS* options_p);
+
+
+/*
+ * This function read list of CPUs of NUMA node from sysfs (e.g. "0-3,8-11").
+ *
+ * @param[in]  numa_node - number of NUMA node.
+ * @param[out] cpu_set_p - CPUs of NUMA node.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_read_numa_cpus(int numa_node, cpu_set_t* cpu_set_p);
+
+
+/*
+ * This function return monotonic time in nanoseconds.
+ *
+ * @param[in] - void.
+ *
+ * @return - monotonic time.
+ */
+static inline int64_t __dlogger_monotonic_nsec(void);
+
+
+/*
+ * This function stop writer thread after all queued records are written and release queue.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_stop(void);
+
+
+/*
+ * This function copy record into asynchronous queue. When queue is full, policy chosen by user is applied.
+ * FATAL and CRITICAL records are never dropped, FATAL record waits until it is written.
+ *
+ * @param[in] file_descriptor - where record will be written.
+ * @param[in] is_log_file     - is @file_descriptor log file (unique file or file of thread)?
+ * @param[in] level           - level of record.
+ * @param[in] iov             - parts of record.
+ * @param[in] iovcnt          - number of parts of record.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_push(int file_descriptor, bool is_log_file, DLogger_levelE level,
+                                 const struct iovec iov[static 1], int iovcnt);
+
+
+/*
+ * This function remove record from queue (but blocks are still used). Mutex of queue must be taken by caller.
+ *
+ * @param[in/out] record_p - pointer to record.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_unlink(DLogger_async_recordS* record_p);
+
+
+/*
+ * This function return blocks of record into list of free blocks. Mutex of queue must be taken by caller.
+ *
+ * @param[in/out] record_p - pointer to record.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_release(DLogger_async_recordS* record_p);
+
+
+/*
+ * This function drop one queued record to make space for new record according to policy.
+ * Mutex of queue must be taken by caller.
+ *
+ * @param[in] level - level of new record.
+ *
+ * @return - true if record has been dropped, false if there is no record which could be dropped.
+ */
+static bool __dlogger_async_evict(DLogger_levelE level);
+
+
+/*
+ * This function is main function of writer thread. Takes all queued records at once, writes them without lock
+ * and releases their blocks. Writes also periodic notice about dropped records.
+ *
+ * @param[in] arg_p - not used.
+ *
+ * @return - 0.
+ */
+static int __dlogger_async_writer(void* arg_p);
+
+
+/*
+ * This function write notice about dropped records into descriptors enabled for warnings and reset counters of dropped
+ * records. Mutex of queue must be taken by caller, it is released for time of writing.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_async_write_dropped_notice(void);
+
+
+/*
+ * This function map ring shared with processes forked later and start collector thread.
+ *
+ * @param[in] ring_size - size of ring in bytes.
+ *
+ * @return - 0 on success, -1 on failure.
+ */
+static int __dlogger_shared_start(size_t ring_size);
+
+
+/*
+ * This function stop collector thread after all reserved records are written (only in process which started it)
+ * and unmap ring.
+ *
+ * @return - void.
+ */
+static void __dlogger_shared_stop(void);
+
+
+/*
+ * This function publish record into shared ring. Caller waits when ring is full.
+ *
+ * @param[in] descriptor_index - index of descriptor where record will be written.
+ * @param[in] level            - level of record.
+ * @param[in] iov              - parts of record.
+ * @param[in] iovcnt           - number of parts.
+ *
+ * @return - void.
+ */
+static void __dlogger_shared_push(size_t descriptor_index, DLogger_levelE level, const struct iovec iov[static 1], int iovcnt);
+
+
+/*
+ * This function write record by calling process, when record does not fit into ring or collector is stopped.
+ *
+ * @param[in] descriptor_index - index of descriptor where record will be written.
+ * @param[in] level            - level of record.
+ * @param[in] iov              - parts of record.
+ * @param[in] iovcnt           - number of parts.
+ *
+ * @return - void.
+ */
+static void __dlogger_shared_write_directly(size_t descriptor_index, DLogger_levelE level,
+                                            const struct iovec iov[static 1], int iovcnt);
+
+
+/*
+ * This function wait until collector writes all records before @position.
+ *
+ * @param[in] ring_p   - shared ring.
+ * @param[in] position - position of ring.
+ *
+ * @return - true if records are written, false if collector is stopped or its process does not exist.
+ */
+static bool __dlogger_shared_wait_for_collector(DLogger_shared_ringS* ring_p, uint64_t position);
+
+
+/*
+ * This function write all published records starting from @position and free their slots.
+ *
+ * @param[in] ring_p   - shared ring.
+ * @param[in] position - position of the oldest not written record.
+ *
+ * @return - position after the last written record.
+ */
+static uint64_t __dlogger_shared_collect(DLogger_shared_ringS* ring_p, uint64_t position);
+
+
+/*
+ * This function mark slots before @position as written and wake producers waiting for them.
+ *
+ * @param[in] ring_p   - shared ring.
+ * @param[in] position - position of the oldest not written record.
+ *
+ * @return - void.
+ */
+static void __dlogger_shared_release(DLogger_shared_ringS* ring_p, uint64_t position);
+
+
+/*
+ * This function skip record reserved at @position and never published, because its producer was killed.
+ *
+ * @param[in] ring_p     - shared ring.
+ * @param[in] position   - position of the oldest not written record, which is reserved and not published.
+ * @param[in] is_expired - has record been waited for DLOGGER_SHARED_RESERVATION_TIMEOUT_NSEC?
+ *
+ * @return - position after skipped record, @position if record is not skipped yet.
+ */
+static uint64_t __dlogger_shared_skip_reservation(DLogger_shared_ringS* ring_p, uint64_t position, bool is_expired);
+
+
+/*
+ * This function check if process does not run anymore. Not reaped child of calling process is also dead.
+ *
+ * @param[in] process_id - id of process.
+ *
+ * @return - true if process is dead.
+ */
+static bool __dlogger_is_process_dead(pid_t process_id);
+
+
+/*
+ * This function write collected records by one system call and clear batch.
+ *
+ * @param[in/out] batch_p - records to write.
+ *
+ * @return - void.
+ */
+static void __dlogger_shared_write_batch(DLogger_shared_batchS* batch_p);
+
+
+/*
+ * This function is collector thread of multi-process logging.
+ *
+ * @param[in] arg_p - not used.
+ *
+ * @return - 0.
+ */
+static int __dlogger_shared_collector(void* arg_p);
+
+
+/*
+ * This function register handlers of fork by pthread_atfork.
+ *
+ * @return - void.
+ */
+static void __dlogger_register_fork_handlers(void);
+
+
+/*
+ * This function lock mutexes before fork, so child gets state which is not modified by other threads.
+ *
+ * @return - void.
+ */
+static void __dlogger_fork_prepare(void);
+
+
+/*
+ * This function unlock mutexes in parent after fork.
+ *
+ * @return - void.
+ */
+static void __dlogger_fork_parent(void);
+
+
+/*
+ * This function reset state of child after fork: only calling thread exists, so threads of DLogger are
+ * not running and their resources are released.
+ *
+ * @return - void.
+ */
+static void __dlogger_fork_child(void);
+
+
+/*
+ * This function calculate FNV-1a hash of message. Used to detect repeated messages without keeping their copy.
+ *
+ * @param[in] message_p    - pointer to message.
+ * @param[in] message_size - size of message.
+ *
+ * @return - hash of message.
+ */
+static uint64_t __dlogger_hash_message(const char* message_p, size_t message_size);
+
+
+/*
+ * This function write summary "last message repeated N times" with prefix of repeated call-site and reset counter.
+ * Main mutex must be taken by caller.
+ *
+ * @param[in/out] descriptor_p - pointer to descriptor with suppressed messages.
+ *
+ * @return - void.
+ */
+static void __dlogger_write_repeated_summary(DLogger_descriptorS* descriptor_p);
+
+
+/*
+ * This function check if message is the same as last message written into descriptor. Repeated message is counted,
+ * otherwise pending summary is written and message becomes last message. Main mutex must be taken by caller.
+ *
+ * @param[in/out] descriptor_p - pointer to descriptor with DLOGGER_OPTION_MARK_SUPPRESS_REPEATED.
+ * @param[in]     callsite_p   - pointer to call-site of logging functionlike macro.
+ * @param[in]     hash         - hash of message.
+ * @param[in]     message_size - size of message.
+ *
+ * @return - true if message should be suppressed, otherwise false.
+ */
+static bool __dlogger_suppress_repeated(DLogger_descriptorS* descriptor_p, const DLogger_callsiteS* callsite_p,
+                                        uint64_t hash, size_t message_size);
+
+
+/*
+ * This function write pending summary of repeated messages and forget last message of descriptor.
+ * Main mutex must be taken by caller.
+ *
+ * @param[in/out] descriptor_p - pointer to descriptor.
+ *
+ * @return - void.
+ */
+static void __dlogger_flush_repeated(DLogger_descriptorS* descriptor_p);
+
+
+/*
+ * This function check if record from call-site should be written into descriptor.
+ *
+ * @param[in] descriptor_p - pointer to descriptor.
+ * @param[in] callsite_p   - pointer to call-site of logging functionlike macro.
+ *
+ * @return - true if record should be written, otherwise false.
+ */
+static inline bool __dlogger_is_enabled(const DLogger_descriptorS* descriptor_p, const DLogger_callsiteS* callsite_p);
+
+
+/*
+ * This function check if record from call-site should be written into at least one descriptor.
+ *
+ * @param[in] callsite_p - pointer to call-site of logging functionlike macro.
+ *
+ * @return - true if record should be written, otherwise false.
+ */
+static bool __dlogger_is_any_enabled(const DLogger_callsiteS* callsite_p);
+
+
+/*
+ * This function save string into @buffer as content of JSON string (quotes, backslashes and control characters
+ * are escaped). String is truncated if there is not enough space for it.
+ *
+ * @param[in]     buffer_index - current buffer index where new data could be written.
+ * @param[in]     buffer_size  - size of buffer.
+ * @param[in/out] buffer       - pointer to first element of buffer.
+ * @param[in]     string_p     - pointer to string.
+ *
+ * @return - number of bytes written into @buffer.
+ */
+static size_t __dlogger_write_json_string(size_t buffer_index, size_t buffer_size, char buffer[static 1], const char* restrict string_p);
+
+
+/*
+ * This function create Chrome trace file and write beginning of array of events.
+ *
+ * @param[in] path_p - path to trace file.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_trace_open(const char* path_p);
+
+
+/*
+ * This function write metadata and end of array of events into Chrome trace file and close it.
+ * Called after writer thread is stopped, so there is no queued event.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_trace_close(void);
+
+
+/*
+ * This function write span as complete event ("ph":"X") into Chrome trace file.
+ *
+ * @param[in] span_p   - pointer to ended span.
+ * @param[in] end_nsec - monotonic time of end of span.
+ *
+ * @return - void.
+ */
+static void __dlogger_trace_write_event(const DLogger_trace_spanS* span_p, uint64_t end_nsec);
+
+
+/*
+ * This function write span as DEBUG record with call-site of span. Name is indented by depth of span.
+ *
+ * @param[in] span_p   - pointer to ended span.
+ * @param[in] end_nsec - monotonic time of end of span.
+ *
+ * @return - void.
+ */
+static void __dlogger_trace_write_record(const DLogger_trace_spanS* span_p, uint64_t end_nsec);
+
+
+/*
+ * This function write record (prefix, message, newline if user forget and backtrace) into all enabled descriptors.
+ *
+ * @param[in] callsite_p     - pointer to call-site of logging functionlike macro.
+ * @param[in] message_p      - pointer to message, not copied.
+ * @param[in] message_size   - size of message.
+ * @param[in] backtrace_p    - pointer to backtrace, NULL if not needed.
+ *
+ * @return - void.
+ */
+static void __dlogger_emit_record(const DLogger_callsiteS* restrict callsite_p,
+                                  const char* restrict message_p, size_t message_size,
+                                  const DLogger_backtraceS* restrict backtrace_p);
+
+
+/*
+ * This function collect backtrace on stack and write record with it. Separated to keep big buffer
+ * only on stack of FATAL messages.
+ *
+ * @param[in] callsite_p   - pointer to call-site of logging functionlike macro.
+ * @param[in] message_p    - pointer to message, not copied.
+ * @param[in] message_size - size of message.
+ *
+ * @return - void.
+ */
+static void __dlogger_emit_record_with_backtrace(const DLogger_callsiteS* restrict callsite_p,
+                                                 const char* restrict message_p, size_t message_size);
+
+
+/*
+ * This function write notice of DLogger (prefix and message) into all descriptors enabled for @callsite_p.
+ * Repeated notices are not suppressed, so main mutex is not taken by threads which write queued records.
+ *
+ * @param[in] callsite_p   - pointer to static call-site of notice.
+ * @param[in] message_p    - pointer to message with newline.
+ * @param[in] message_size - size of message.
+ *
+ * @return - void.
+ */
+static void __dlogger_write_notice(const DLogger_callsiteS* restrict callsite_p, const char* restrict message_p,
+                                   size_t message_size);
+
+
+/*
+ * This function will parse user options by using compund literals.
+ *
+ * @param[in] descriptor_to_write - which descriptor options @level_of_logging and @additional_options will be written.
+ * @param[in] level_of_logging    - level of logging for above @descriptor_to_write.
+ * @param[in] additional_options  - additional options available in DLogger.
+ *
+ * @return - parsed input into DLogger_descriptor_optionsS.
+ */
+static inline DLogger_descriptor_optionsS __dlogger_parse_user_option(DLogger_options_writeE descriptor_to_write,
+                                                                      DLogger_levelE level_of_logging,
+                                                                      DLogger_options_markE additional_options);
+
+
+/*
+ * This function return level of the most verbose filled descriptor.
+ *
+ * @param[in] - void.
+ *
+ * @return - the highest level, -1 if no descriptor is filled.
+ */
+static int __dlogger_max_descriptor_level(void);
+
+
+/*
+ * This function publish level of the most verbose descriptor and recompute call-sites tested by logging macros.
+ * Called after any change of level, only atomic operations are used so it can be called by signal handler.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_update_max_level(void);
+
+
+/*
+ * This function is signal handler installed by dlogger_install_signal_handlers. Step level of logging for all descriptors.
+ * Only atomic operations are used so handler is async-signal-safe.
+ *
+ * @param[in] signal_number - number of received signal.
+ *
+ * @return - void.
+ */
+static void __dlogger_signal_handler(int signal_number);
+
+
+/*
+ * This function parse one line of configuration file and apply options for descriptor.
+ * Line format: descriptor = level, mark, mark. Empty lines and lines started by # are skipped.
+ *
+ * @param[in/out] line_p - pointer to null-terminated line. Line will be modified by tokenizer.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_apply_config_line(char line_p[static 1]);
+
+
+/*
+ * This function parse rest of call-site line from configuration file and apply new state for matched call-sites.
+ * Line format: callsite file_pattern function_pattern on|off|default.
+ *
+ * @param[in/out] save_pp - state of tokenizer, positioned after "callsite" keyword.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_apply_config_callsite(char** save_pp);
+
+
+/*
+ * This function read whole configuration file and apply all lines.
+ *
+ * @param[in] path_p - path to configuration file.
+ *
+ * @return 0 on succes, non-zero value on failure.
+ */
+static int __dlogger_load_config_file(const char path_p[static 1]);
+
+
+/*
+ * This function is main function of watcher thread. Wait for inotify events related with configuration file
+ * and reload it. Thread is finished when stop eventfd is signaled.
+ *
+ * @param[in] arg_p - unused.
+ *
+ * @return - always 0.
+ */
+static int __dlogger_config_watcher(void* arg_p);
+
+
+static size_t __dlogger_write_timestamp(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                        const bool with_date, const bool with_h_min_sec, const bool with_usec)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    struct timeval timeval_now = {0};
+    register const int ret = gettimeofday(&timeval_now, NULL);
+
+    if (ret == -1)
+    {
+        perror("DLogger: error with function gettimeofday");
+        return 0;
+    }
+
+    struct tm datetime_now = {0};
+    const struct tm *const restrict datetime_now_p = localtime_r(&timeval_now.tv_sec, &datetime_now);
+
+    if (datetime_now_p == NULL)
+    {
+        perror("DLogger: error with function localtime_r");
+        return 0;
+    }
+
+    register size_t written_bytes = buffer_index;
+
+    if (with_date == true)
+    {
+        register const char *const restrict fmt_date_p = "%Y:%m:%d";
+        written_bytes += strftime(&buffer[written_bytes], buffer_size - written_bytes, fmt_date_p, datetime_now_p);
+    }
+
+    if (with_h_min_sec == true)
+    {
+        register const char *const restrict fmt_h_min_sec_p = (with_date == true) ? "-%H:%M:%S" : "%H:%M:%S";
+        written_bytes += strftime(&buffer[written_bytes], buffer_size - written_bytes, fmt_h_min_sec_p, datetime_now_p);
+
+        if (with_usec == true)
+        {
+            register const char *const restrict fmt_usec_p = ".%ld";
+            register const int ret_usec = snprintf(&buffer[written_bytes], buffer_size - written_bytes, fmt_usec_p, (long)timeval_now.tv_usec);
+            written_bytes += __dlogger_written_bytes(ret_usec, buffer_size - written_bytes);
+        }
+    }
+
+    return written_bytes - buffer_index;
+}
+
+
+static size_t __dlogger_write_level(const size_t buffer_index, const size_t buffer_size,
+                                    char buffer[const static 1], const DLogger_levelE level)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    /* 
+     * This aligment with spaces is necessary to start saving logger messages with proper offset. This is why we need to calculate 
+     * different between the longest level which is "CRITICAL" and the current level. 
+     *
+     * Example:
+     * [FATAL]    log message1
+     * [CRITICAL] log message2
+     * [ERROR]    log message3
+     * [WARNING]  log message4
+     */
+    register const size_t length_level_critical = strlen(dlogger_priv_level_strings[DLOGGER_LEVEL_CRITICAL]) + 1;
+    register const size_t length_level_current = strlen(dlogger_priv_level_strings[level]) + 1;
+
+    /* "+2" means - additional space after square bracket and for null-terminated character. */
+    register const size_t size = length_level_critical - length_level_current + 2;
+    char spaces_to_fill[size];
 
     register const char space = ' ';
     memset(&spaces_to_fill[0], space, sizeof(spaces_to_fill));
     spaces_to_fill[size - 1] = '\0';
 
-    register const char *const restrict fmt_p = "[%s]%s";
+    register const char *const restrict fmt_p = "[%s]%s";
+
+    register const int ret = snprintf(&buffer[buffer_index], buffer_size - buffer_index,
+                                      fmt_p, dlogger_priv_level_strings[level], &spaces_to_fill[0]);
+
+    return __dlogger_written_bytes(ret, buffer_size - buffer_index);
+}
+
+
+static size_t __dlogger_write_file_line_func(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                             const char *const restrict file_p, const int line, const char *const restrict func_p)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register const char* const restrict fmt_p = "[%s:%d %s] ";
+
+    register const int ret = snprintf(&buffer[buffer_index], buffer_size - buffer_index, fmt_p, file_p, line, func_p);
+
+    return __dlogger_written_bytes(ret, buffer_size - buffer_index);
+}
+
+
+static size_t __dlogger_write_thread_id(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1])
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register const pid_t thread_id = (pid_t)syscall(__NR_gettid);
+
+
+    register const char* const restrict fmt_p = "[TID %ld] ";
+
+    register const int ret = snprintf(&buffer[buffer_index], buffer_size - buffer_index, fmt_p, (long)thread_id);
+
+    return __dlogger_written_bytes(ret, buffer_size - buffer_index);
+}
+
+
+static size_t __dlogger_write_backtrace(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                        void* const frames[const static 1], const int number_of_frames)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register size_t bytes_written = buffer_index;
+
+    bytes_written += __dlogger_write_string(bytes_written, buffer_size, &buffer[0], "Backtrace:\n");
+
+    for (size_t i = 0; i < (size_t)number_of_frames; ++i)
+    {
+        Dl_info info;
+        struct link_map* map_p = NULL;
+        register int ret = 0;
+
+        if (dladdr1(frames[i], &info, (void**)&map_p, RTLD_DL_LINKMAP) != 0 && info.dli_fname != NULL && info.dli_fname[0] != '\0')
+        {
+            /* The same rules like in backtrace_symbols: without symbol offset is relative to load address of module. */
+            register const uintptr_t address = (uintptr_t)frames[i];
+            register const uintptr_t symbol = info.dli_sname != NULL ? (uintptr_t)info.dli_saddr :
+                                              (map_p != NULL ? (uintptr_t)map_p->l_addr : 0);
+            const char* const symbol_name_p = info.dli_sname != NULL ? info.dli_sname : "";
+
+            if (info.dli_sname == NULL && symbol == 0)
+            {
+                ret = snprintf(&buffer[bytes_written], buffer_size - bytes_written, "%s() [%p]\n", info.dli_fname, frames[i]);
+            }
+            else
+            {
+                register const char sign = address >= symbol ? '+' : '-';
+                register const uintptr_t offset = address >= symbol ? address - symbol : symbol - address;
+
+                ret = snprintf(&buffer[bytes_written], buffer_size - bytes_written, "%s(%s%c%#" PRIxPTR ") [%p]\n",
+                               info.dli_fname, symbol_name_p, sign, offset, frames[i]);
+            }
+        }
+        else
+        {
+            ret = snprintf(&buffer[bytes_written], buffer_size - bytes_written, "[%p]\n", frames[i]);
+        }
+
+        bytes_written += __dlogger_written_bytes(ret, buffer_size - bytes_written);
+    }
+
+    return bytes_written - buffer_index;
+}
+
+
+static size_t __dlogger_write_raw_backtrace(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                            void* const frames[const static 1], const int number_of_frames)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register size_t bytes_written = buffer_index;
+
+    bytes_written += __dlogger_write_string(bytes_written, buffer_size, &buffer[0], "Raw backtrace:\n");
+
+    for (size_t i = 0; i < (size_t)number_of_frames; ++i)
+    {
+        register const int ret = snprintf(&buffer[bytes_written], buffer_size - bytes_written, "%p\n", frames[i]);
+        bytes_written += __dlogger_written_bytes(ret, buffer_size - bytes_written);
+    }
+
+    return bytes_written - buffer_index;
+}
+
+
+static int __dlogger_write_module(struct dl_phdr_info* const info_p, const size_t size, void* const data_p)
+{
+    (void)size;
+
+    DLogger_modules_bufferS* const modules_p = data_p;
+
+    if (modules_p->buffer_index >= modules_p->buffer_size)
+    {
+        return 0;
+    }
+
+    ElfW(Addr) first_address = (ElfW(Addr))-1;
+    ElfW(Addr) last_address = 0;
+    char build_id[2 * 64 + 1] = "-";
+
+    for (size_t i = 0; i < info_p->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)* const phdr_p = &info_p->dlpi_phdr[i];
+
+        if (phdr_p->p_type == PT_LOAD)
+        {
+            if (phdr_p->p_vaddr < first_address)
+            {
+                first_address = phdr_p->p_vaddr;
+            }
+
+            if (phdr_p->p_vaddr + phdr_p->p_memsz > last_address)
+            {
+                last_address = phdr_p->p_vaddr + phdr_p->p_memsz;
+            }
+        }
+        else if (phdr_p->p_type == PT_NOTE)
+        {
+            /* Notes are aligned to 4 bytes, build ID is note with name "GNU" and type NT_GNU_BUILD_ID. */
+            const char* note_p = (const char*)(info_p->dlpi_addr + phdr_p->p_vaddr);
+            const char* const note_end_p = note_p + phdr_p->p_memsz;
+
+            while (note_p + sizeof(ElfW(Nhdr)) <= note_end_p)
+            {
+                const ElfW(Nhdr)* const nhdr_p = (const ElfW(Nhdr)*)(const void*)note_p;
+                const char* const name_p = note_p + sizeof(*nhdr_p);
+                const unsigned char* const desc_p = (const unsigned char*)name_p + ((nhdr_p->n_namesz + 3) & ~3U);
+
+                if (nhdr_p->n_type == NT_GNU_BUILD_ID && nhdr_p->n_namesz == 4 && memcmp(name_p, "GNU", 4) == 0)
+                {
+                    for (size_t j = 0; j < nhdr_p->n_descsz && j < 64; ++j)
+                    {
+                        snprintf(&build_id[2 * j], sizeof(build_id) - 2 * j, "%02x", desc_p[j]);
+                    }
+                }
+
+                note_p = (const char*)desc_p + ((nhdr_p->n_descsz + 3) & ~3U);
+            }
+        }
+    }
+
+    /* Main executable has empty name. */
+    char path[PATH_MAX] = {0};
+    const char* path_p = info_p->dlpi_name;
+
+    if (path_p == NULL || path_p[0] == '\0')
+    {
+        register const ssize_t ret = readlink("/proc/self/exe", &path[0], sizeof(path) - 1);
+        path_p = (ret > 0) ? &path[0] : "-";
+    }
+
+    register const int ret = snprintf(&modules_p->buffer_p[modules_p->buffer_index], modules_p->buffer_size - modules_p->buffer_index,
+                                      "%#lx %#lx-%#lx %s %s\n",
+                                      (unsigned long)info_p->dlpi_addr,
+                                      (unsigned long)(info_p->dlpi_addr + first_address),
+                                      (unsigned long)(info_p->dlpi_addr + last_address),
+                                      &build_id[0], path_p);
+
+    modules_p->buffer_index += __dlogger_written_bytes(ret, modules_p->buffer_size - modules_p->buffer_index);
+
+    return 0;
+}
+
+
+static void __dlogger_write_modules(const DLogger_descriptorS* const descriptor_p)
+{
+    /* Taken from record arena, list of modules is written also when raw backtraces are enabled in run-time. */
+    DLogger_modules_bufferS modules =
+    {
+        .buffer_p = __dlogger_arena_take(1 << 16),
+        .buffer_size = 1 << 16,
+        .buffer_index = 0,
+    };
+
+    if (modules.buffer_p == NULL)
+    {
+        return;
+    }
+
+    modules.buffer_index += __dlogger_write_string(modules.buffer_index, modules.buffer_size, modules.buffer_p, "Modules:\n");
+    dl_iterate_phdr(__dlogger_write_module, &modules);
+
+    struct iovec iov = { .iov_base = modules.buffer_p, .iov_len = modules.buffer_index };
+    /* List of modules is needed to resolve raw backtraces, so it is never dropped. */
+    __dlogger_write_record(descriptor_p, DLOGGER_LEVEL_CRITICAL, &iov, 1, true);
+
+    __dlogger_arena_release(modules.buffer_p, modules.buffer_size);
+}
+
+
+static size_t __dlogger_written_bytes(const int ret, const size_t buffer_size_left)
+{
+    if (ret < 0 || buffer_size_left == 0)
+    {
+        return 0;
+    }
+
+    /* Output has been truncated, only @buffer_size_left - 1 bytes and null-terminated character are in buffer. */
+    if ((size_t)ret >= buffer_size_left)
+    {
+        return buffer_size_left - 1;
+    }
+
+    return (size_t)ret;
+}
+
+
+static size_t __dlogger_write_string(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                     const char* const restrict string_p)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register const int ret = snprintf(&buffer[buffer_index], buffer_size - buffer_index, "%s", string_p);
+
+    return __dlogger_written_bytes(ret, buffer_size - buffer_index);
+}
+
+
+static size_t __dlogger_write_prefix(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                     const DLogger_callsiteS* const restrict callsite_p, const DLogger_options_markE marks)
+{
+    register size_t written_bytes = buffer_index;
+
+    written_bytes += __dlogger_write_level(written_bytes, buffer_size, &buffer[0], callsite_p->level);
+
+    if (marks & DLOGGER_OPTION_MARK_TIMESTAMP)
+    {
+        register const bool with_date = false;
+        register const bool with_h_min_sec = true;
+        register const bool with_usec = true;
+
+        written_bytes += __dlogger_write_string(written_bytes, buffer_size, &buffer[0], "[");
+        written_bytes += __dlogger_write_timestamp(written_bytes, buffer_size, &buffer[0], with_date, with_h_min_sec, with_usec);
+        written_bytes += __dlogger_write_string(written_bytes, buffer_size, &buffer[0], "] ");
+    }
+
+    if (marks & DLOGGER_OPTION_MARK_THREADID)
+    {
+        written_bytes += __dlogger_write_thread_id(written_bytes, buffer_size, &buffer[0]);
+    }
+
+    written_bytes += __dlogger_write_file_line_func(written_bytes, buffer_size, &buffer[0],
+                                                    callsite_p->file_p, callsite_p->line, callsite_p->func_p);
+
+    return written_bytes - buffer_index;
+}
+
+
+static int __dlogger_arena_start(size_t number_of_chunks, size_t chunk_size)
+{
+    if (number_of_chunks == 0)
+    {
+        number_of_chunks = DLOGGER_ARENA_DEFAULT_CHUNKS;
+    }
+
+    if (chunk_size == 0)
+    {
+        chunk_size = DLOGGER_ARENA_DEFAULT_CHUNK_SIZE;
+    }
+
+    /* Chunks start on cache lines, so threads which format into neighbouring chunks do not share them. */
+    chunk_size = (chunk_size + DLOGGER_CACHE_LINE - 1) & ~((size_t)DLOGGER_CACHE_LINE - 1);
+
+    if (chunk_size > (SIZE_MAX / 2) / number_of_chunks)
+    {
+        fprintf(stderr, "DLogger: wrong size of record arena: %zu chunks of %zu bytes\n", number_of_chunks, chunk_size);
+        return -1;
+    }
+
+    register const size_t chunks_size = number_of_chunks * chunk_size;
+    register const size_t mapping_size = chunks_size + number_of_chunks * sizeof(bool);
+
+    /* Pages are touched by the first records which need them, unused chunks do not take physical memory. */
+    char* const memory_p = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory_p == MAP_FAILED)
+    {
+        perror("DLogger: cannot map record arena");
+        return -1;
+    }
+
+    DLogger_arenaS* const arena_p = &dlogger_priv_data.arena;
+
+    if (mtx_init(&arena_p->mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: cannot initialize mutex of record arena");
+        munmap(memory_p, mapping_size);
+        return -1;
+    }
+
+    if (cnd_init(&arena_p->released) != thrd_success)
+    {
+        perror("DLogger: cannot initialize condition of record arena");
+        mtx_destroy(&arena_p->mutex);
+        munmap(memory_p, mapping_size);
+        return -1;
+    }
+
+    arena_p->memory_p = memory_p;
+    arena_p->mapping_size = mapping_size;
+    arena_p->chunk_size = chunk_size;
+    arena_p->number_of_chunks = number_of_chunks;
+    arena_p->is_taken_p = (bool*)(void*)&memory_p[chunks_size];
+    atomic_init(&arena_p->truncated, 0);
+
+    __dlogger_arena_reset();
+
+    return 0;
+}
+
+
+static void __dlogger_arena_reset(void)
+{
+    DLogger_arenaS* const arena_p = &dlogger_priv_data.arena;
+
+    for (size_t i = 0; i < arena_p->number_of_chunks; ++i)
+    {
+        arena_p->is_taken_p[i] = false;
+    }
+}
+
+
+static void __dlogger_arena_stop(void)
+{
+    DLogger_arenaS* const arena_p = &dlogger_priv_data.arena;
+
+    if (arena_p->memory_p == NULL)
+    {
+        return;
+    }
+
+    if (munmap(arena_p->memory_p, arena_p->mapping_size) == -1)
+    {
+        perror("DLogger: cannot unmap record arena");
+    }
+
+    cnd_destroy(&arena_p->released);
+    mtx_destroy(&arena_p->mutex);
+
+    arena_p->memory_p = NULL;
+}
+
+
+char* __dlogger_arena_take(const size_t size)
+{
+    DLogger_arenaS* const arena_p = &dlogger_priv_data.arena;
+
+    if (arena_p->memory_p == NULL || size == 0)
+    {
+        return NULL;
+    }
+
+    register const size_t run_length = (size - 1) / arena_p->chunk_size + 1;
+
+    /* Record bigger than whole arena is formatted into own temporary mapping, so its tail is never dropped. */
+    if (run_length > arena_p->number_of_chunks)
+    {
+        char* const mapping_p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (mapping_p == MAP_FAILED)
+        {
+            perror("DLogger: cannot map buffer of long record");
+            return NULL;
+        }
+
+        return mapping_p;
+    }
+
+    mtx_lock(&arena_p->mutex);
+
+    while (true)
+    {
+        size_t free_chunks = 0;
+
+        for (size_t i = 0; i < arena_p->number_of_chunks; ++i)
+        {
+            free_chunks = arena_p->is_taken_p[i] == true ? 0 : free_chunks + 1;
+
+            if (free_chunks == run_length)
+            {
+                register const size_t first = i + 1 - run_length;
+
+                for (size_t j = first; j <= i; ++j)
+                {
+                    arena_p->is_taken_p[j] = true;
+                }
+
+                mtx_unlock(&arena_p->mutex);
+
+                return &arena_p->memory_p[first * arena_p->chunk_size];
+            }
+        }
+
+        cnd_wait(&arena_p->released, &arena_p->mutex);
+    }
+}
+
+
+void __dlogger_arena_release(char* const buffer_p, const size_t size)
+{
+    DLogger_arenaS* const arena_p = &dlogger_priv_data.arena;
+
+    if (buffer_p == NULL || arena_p->memory_p == NULL)
+    {
+        return;
+    }
+
+    register const size_t run_length = (size - 1) / arena_p->chunk_size + 1;
+
+    if (run_length > arena_p->number_of_chunks)
+    {
+        if (munmap(buffer_p, size) == -1)
+        {
+            perror("DLogger: cannot unmap buffer of long record");
+        }
+
+        return;
+    }
+
+    register const size_t first = (size_t)(buffer_p - arena_p->memory_p) / arena_p->chunk_size;
+
+    mtx_lock(&arena_p->mutex);
+
+    for (size_t i = first; i < first + run_length; ++i)
+    {
+        arena_p->is_taken_p[i] = false;
+    }
+
+    cnd_broadcast(&arena_p->released);
+    mtx_unlock(&arena_p->mutex);
+}
+
+
+void __dlogger_arena_count_truncated(void)
+{
+    atomic_fetch_add_explicit(&dlogger_priv_data.arena.truncated, 1, memory_order_relaxed);
+}
+
+
+static void __dlogger_write_iov(const int file_descriptor, struct iovec iov[const static 1], const int iovcnt)
+{
+    struct iovec* iov_p = &iov[0];
+    register int iov_left = iovcnt;
+
+    while (iov_left > 0)
+    {
+        register const ssize_t ret = writev(file_descriptor, iov_p, iov_left);
+
+        if (ret == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("DLogger: cannot write record");
+            break;
+        }
+
+        /* Partial write, skip fully written vectors and move to the rest of data. */
+        register size_t bytes_written = (size_t)ret;
+
+        while (iov_left > 0 && bytes_written >= iov_p->iov_len)
+        {
+            bytes_written -= iov_p->iov_len;
+            ++iov_p;
+            --iov_left;
+        }
+
+        if (iov_left > 0)
+        {
+            iov_p->iov_base = (char*)iov_p->iov_base + bytes_written;
+            iov_p->iov_len -= bytes_written;
+        }
+    }
+}
+
+
+static int __dlogger_file_descriptor(const DLogger_descriptorS* const descriptor_p)
+{
+    if (descriptor_p != &dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE] ||
+        !(atomic_load_explicit(&descriptor_p->marks, memory_order_relaxed) & DLOGGER_OPTION_MARK_PER_THREAD_FILE) ||
+        dlogger_priv_data.thread_files.is_key_created == false)
+    {
+        return descriptor_p->file_descriptor;
+    }
+
+    const DLogger_thread_fileS* file_p = tss_get(dlogger_priv_data.thread_files.key);
+
+    if (file_p == NULL)
+    {
+        file_p = __dlogger_open_thread_file();
+    }
+
+    return (file_p == NULL || file_p->file_descriptor == -1) ? descriptor_p->file_descriptor : file_p->file_descriptor;
+}
+
+
+static void __dlogger_reset_thread_files(void)
+{
+    dlogger_priv_data.thread_files.files_p = NULL;
+    dlogger_priv_data.thread_files.free_p = NULL;
+    dlogger_priv_data.thread_files.missing.file_descriptor = -1;
+
+    for (size_t i = DLOGGER_MAX_THREAD_FILES; i > 0; --i)
+    {
+        DLogger_thread_fileS* const file_p = &dlogger_priv_data.thread_files.slots[i - 1];
+
+        file_p->file_descriptor = -1;
+        file_p->next_p = dlogger_priv_data.thread_files.free_p;
+        dlogger_priv_data.thread_files.free_p = file_p;
+    }
+}
+
+
+static DLogger_thread_fileS* __dlogger_open_thread_file(void)
+{
+    char path[1 << 7];
+    snprintf(&path[0], sizeof(path), "%s.%ld.log", &dlogger_priv_data.thread_files.file_stem[0], (long)syscall(__NR_gettid));
+
+    register const mode_t mode = S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH;
+
+    /* Thread id might be reused by new thread, then records are appended to file of previous one. */
+    register const int file_descriptor = open(&path[0], O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, mode);
+
+    /* Failure is remembered, so thread does not try to open file for each record. */
+    if (file_descriptor == -1)
+    {
+        perror("DLogger: cannot open file of thread");
+    }
+
+    if (mtx_lock(&dlogger_priv_data.thread_files.mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+
+        if (file_descriptor != -1)
+        {
+            close(file_descriptor);
+        }
+
+        return NULL;
+    }
+
+    DLogger_thread_fileS* file_p = dlogger_priv_data.thread_files.free_p;
+
+    if (file_p != NULL)
+    {
+        dlogger_priv_data.thread_files.free_p = file_p->next_p;
+
+        file_p->file_descriptor = file_descriptor;
+        file_p->next_p = dlogger_priv_data.thread_files.files_p;
+        dlogger_priv_data.thread_files.files_p = file_p;
+    }
+
+    mtx_unlock(&dlogger_priv_data.thread_files.mutex);
+
+    /* All slots are used by other threads, this thread writes into unique file. */
+    if (file_p == NULL)
+    {
+        fprintf(stderr, "DLogger: all %u files of threads are used, unique file is used instead\n", DLOGGER_MAX_THREAD_FILES);
+
+        if (file_descriptor != -1)
+        {
+            close(file_descriptor);
+        }
+
+        file_p = &dlogger_priv_data.thread_files.missing;
+    }
+
+    tss_set(dlogger_priv_data.thread_files.key, file_p);
+
+    return file_p;
+}
+
+
+static void __dlogger_close_thread_file(void* const file_p)
+{
+    if (file_p == &dlogger_priv_data.thread_files.missing)
+    {
+        return;
+    }
+
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    /* Writer thread might still have records of this thread in queue, file is closed after they are written. */
+    if (async_p->is_running == true && mtx_lock(&async_p->mutex) == thrd_success)
+    {
+        register const uint64_t sequence = async_p->pushed_sequence;
+
+        while (async_p->written_sequence < sequence)
+        {
+            cnd_wait(&async_p->written, &async_p->mutex);
+        }
+
+        mtx_unlock(&async_p->mutex);
+    }
+
+    if (mtx_lock(&dlogger_priv_data.thread_files.mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return;
+    }
+
+    for (DLogger_thread_fileS** link_p = &dlogger_priv_data.thread_files.files_p; *link_p != NULL; link_p = &(*link_p)->next_p)
+    {
+        if (*link_p == file_p)
+        {
+            *link_p = (*link_p)->next_p;
+            break;
+        }
+    }
+
+    /* Descriptor is taken before slot is returned, new thread can get the slot right after unlock. */
+    DLogger_thread_fileS* const thread_file_p = file_p;
+    register const int file_descriptor = thread_file_p->file_descriptor;
+
+    thread_file_p->file_descriptor = -1;
+    thread_file_p->next_p = dlogger_priv_data.thread_files.free_p;
+    dlogger_priv_data.thread_files.free_p = thread_file_p;
+
+    mtx_unlock(&dlogger_priv_data.thread_files.mutex);
+
+    if (file_descriptor != -1)
+    {
+        close(file_descriptor);
+    }
+}
+
+
+static void __dlogger_close_thread_files(void)
+{
+    /* Key is deleted first, so destructor of exiting thread does not touch closed files. */
+    tss_delete(dlogger_priv_data.thread_files.key);
+
+    for (const DLogger_thread_fileS* file_p = dlogger_priv_data.thread_files.files_p; file_p != NULL; file_p = file_p->next_p)
+    {
+        if (file_p->file_descriptor != -1 && close(file_p->file_descriptor) == -1)
+        {
+            perror("DLogger: cannot close file of thread");
+        }
+    }
+
+    dlogger_priv_data.thread_files.files_p = NULL;
+
+    mtx_destroy(&dlogger_priv_data.thread_files.mutex);
+}
+
+
+static size_t __dlogger_number_of_frames(const DLogger_descriptorS* const descriptor_p, const size_t size)
+{
+    if (dlogger_priv_data.frame.is_enabled == false ||
+        descriptor_p != &dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE] || size == 0)
+    {
+        return 1;
+    }
+
+    return (size + DLOGGER_FRAME_MAX_LENGTH - 1) / DLOGGER_FRAME_MAX_LENGTH;
+}
+
+
+static int __dlogger_frame_record(const DLogger_descriptorS* const descriptor_p, DLogger_frame_headerS headers[const static 1],
+                                  struct iovec framed_iov[const static 1], const struct iovec iov[const static 1],
+                                  const int iovcnt)
+{
+    if (dlogger_priv_data.frame.is_enabled == false ||
+        descriptor_p != &dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE])
+    {
+        memcpy(&framed_iov[0], &iov[0], sizeof(*iov) * (size_t)iovcnt);
+        return iovcnt;
+    }
+
+    register const size_t size = __dlogger_iov_size(&iov[0], iovcnt);
+    register const size_t number_of_frames = __dlogger_number_of_frames(descriptor_p, size);
+
+    /* Counter of process is not shared with forked processes, they write frames of one file. */
+    atomic_uint_fast64_t* const sequence_p = (dlogger_priv_data.shared.ring_p != NULL)
+                                             ? &dlogger_priv_data.shared.ring_p->frame_sequence
+                                             : &dlogger_priv_data.frame.sequence;
+
+    /* Reader rejects longer frame as corrupted, so long record is split, payloads of frames give whole record. */
+    register int framed_iovcnt = 0;
+    register int i = 0;
+    register size_t offset = 0;
+    register size_t size_left = size;
+
+    for (size_t frame = 0; frame < number_of_frames; ++frame)
+    {
+        register const size_t length = (size_left < DLOGGER_FRAME_MAX_LENGTH) ? size_left : DLOGGER_FRAME_MAX_LENGTH;
+        register const int header_index = framed_iovcnt++;
+        register uint32_t payload_crc = 0;
+        register size_t length_left = length;
+
+        while (length_left > 0)
+        {
+            register const size_t chunk = (iov[i].iov_len - offset < length_left) ? iov[i].iov_len - offset : length_left;
+            const char* const chunk_p = (const char*)iov[i].iov_base + offset;
+
+            if (chunk > 0)
+            {
+                payload_crc = dlogger_frame_crc32c(payload_crc, chunk_p, chunk);
+                framed_iov[framed_iovcnt++] = (struct iovec){ .iov_base = (void*)(uintptr_t)chunk_p, .iov_len = chunk };
+            }
+
+            offset += chunk;
+            length_left -= chunk;
+
+            if (offset == iov[i].iov_len)
+            {
+                ++i;
+                offset = 0;
+            }
+        }
+
+        register const uint64_t sequence = atomic_fetch_add_explicit(sequence_p, 1, memory_order_relaxed) + 1;
+        dlogger_frame_make_header(&headers[frame], (uint32_t)length, sequence, payload_crc);
+
+        framed_iov[header_index] = (struct iovec){ .iov_base = &headers[frame], .iov_len = sizeof(headers[frame]) };
+        size_left -= length;
+    }
+
+    return framed_iovcnt;
+}
+
+
+static void __dlogger_write_record(const DLogger_descriptorS* const descriptor_p, const DLogger_levelE level,
+                                   struct iovec iov[const static 1], const int iovcnt, const bool with_lock)
+{
+    register const size_t number_of_frames = __dlogger_number_of_frames(descriptor_p, __dlogger_iov_size(&iov[0], iovcnt));
+
+    DLogger_frame_headerS headers[number_of_frames];
+    struct iovec framed_iov[(size_t)iovcnt + 2 * number_of_frames];
+    register const int framed_iovcnt = __dlogger_frame_record(descriptor_p, &headers[0], &framed_iov[0], &iov[0], iovcnt);
+
+    /* Collector of multi-process logging writes all files, so files of threads are not opened. */
+    if (dlogger_priv_data.shared.ring_p != NULL)
+    {
+        __dlogger_shared_push((size_t)(descriptor_p - &dlogger_priv_data.descriptors[0]), level, &framed_iov[0], framed_iovcnt);
+        return;
+    }
+
+    register const int file_descriptor = __dlogger_file_descriptor(descriptor_p);
+    register const bool is_log_file = descriptor_p == &dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE];
+
+    if (dlogger_priv_data.async.is_running == true)
+    {
+        __dlogger_async_push(file_descriptor, is_log_file, level, &framed_iov[0], framed_iovcnt);
+        return;
+    }
+
+    /* Log file is opened with O_APPEND, only standard streams are serialized by main mutex. */
+    register const bool is_locking = with_lock == true && is_log_file == false;
+
+    if (is_locking == true && mtx_lock(&dlogger_priv_data.mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return;
+    }
+
+    register const size_t size = __dlogger_iov_size(&framed_iov[0], framed_iovcnt);
+    __dlogger_write_iov(file_descriptor, &framed_iov[0], framed_iovcnt);
+
+    if (is_locking == true)
+    {
+        mtx_unlock(&dlogger_priv_data.mutex);
+    }
+
+    if (is_log_file == true)
+    {
+        __dlogger_durability_after_write(file_descriptor, level, size);
+    }
+}
+
+
+static size_t __dlogger_iov_size(const struct iovec iov[const static 1], const int iovcnt)
+{
+    register size_t size = 0;
+
+    for (int i = 0; i < iovcnt; ++i)
+    {
+        size += iov[i].iov_len;
+    }
+
+    return size;
+}
+
+
+static int __dlogger_durability_start(const DLogger_durability_optionsS* const options_p)
+{
+    DLogger_durabilityS* const durability_p = &dlogger_priv_data.durability;
+
+    durability_p->options = *options_p;
+    atomic_init(&durability_p->unsynced_bytes, 0);
+
+    if (options_p->durability != DLOGGER_DURABILITY_GROUP_COMMIT)
+    {
+        return 0;
+    }
+
+    if (mtx_init(&durability_p->mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: cannot initialize mutex of group commit");
+        return -1;
+    }
+
+    if (cnd_init(&durability_p->wake_up) != thrd_success)
+    {
+        perror("DLogger: cannot initialize condition variable of group commit");
+        goto error_wake_up;
+    }
+
+    if (cnd_init(&durability_p->synced) != thrd_success)
+    {
+        perror("DLogger: cannot initialize condition variable of group commit");
+        goto error_synced;
+    }
+
+    if (thrd_create(&durability_p->thread, __dlogger_durability_thread, NULL) != thrd_success)
+    {
+        perror("DLogger: cannot create group commit thread");
+        goto error_thread;
+    }
+
+    durability_p->is_running = true;
+
+    return 0;
+
+error_thread:
+    cnd_destroy(&durability_p->synced);
+error_synced:
+    cnd_destroy(&durability_p->wake_up);
+error_wake_up:
+    mtx_destroy(&durability_p->mutex);
+    return -1;
+}
+
+
+static void __dlogger_durability_stop(void)
+{
+    DLogger_durabilityS* const durability_p = &dlogger_priv_data.durability;
+
+    if (durability_p->is_running == true)
+    {
+        mtx_lock(&durability_p->mutex);
+        durability_p->is_stopping = true;
+        cnd_signal(&durability_p->wake_up);
+        mtx_unlock(&durability_p->mutex);
+
+        thrd_join(durability_p->thread, NULL);
+
+        cnd_destroy(&durability_p->synced);
+        cnd_destroy(&durability_p->wake_up);
+        mtx_destroy(&durability_p->mutex);
+        durability_p->is_running = false;
+    }
+
+    if (durability_p->options.durability != DLOGGER_DURABILITY_NONE)
+    {
+        __dlogger_durability_sync_files();
+    }
+}
+
+
+static void __dlogger_durability_after_write(const int file_descriptor, const DLogger_levelE level, const size_t size)
+{
+    DLogger_durabilityS* const durability_p = &dlogger_priv_data.durability;
+
+    switch (durability_p->options.durability)
+    {
+        case DLOGGER_DURABILITY_CRITICAL:
+        {
+            if (level <= DLOGGER_LEVEL_CRITICAL && fdatasync(file_descriptor) == -1)
+            {
+                perror("DLogger: cannot synchronize log file");
+            }
+            break;
+        }
+        case DLOGGER_DURABILITY_GROUP_COMMIT:
+        {
+            if (durability_p->is_running == false)
+            {
+                break;
+            }
+
+            if (level == DLOGGER_LEVEL_FATAL)
+            {
+                __dlogger_durability_wait_for_commit();
+                break;
+            }
+
+            register const size_t max_bytes = durability_p->options.max_bytes;
+            register const size_t unsynced_bytes = atomic_fetch_add_explicit(&durability_p->unsynced_bytes, size, memory_order_relaxed);
+
+            /* Only record which crosses limit wakes up thread, others do not touch mutex. */
+            if (max_bytes > 0 && unsynced_bytes < max_bytes && unsynced_bytes + size >= max_bytes)
+            {
+                mtx_lock(&durability_p->mutex);
+                cnd_signal(&durability_p->wake_up);
+                mtx_unlock(&durability_p->mutex);
+            }
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+
+static void __dlogger_durability_wait_for_commit(void)
+{
+    DLogger_durabilityS* const durability_p = &dlogger_priv_data.durability;
+
+    if (mtx_lock(&durability_p->mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return;
+    }
+
+    /* Commit requested after record is written covers it. Concurrent requests are served by one fdatasync. */
+    register const uint64_t commit = ++durability_p->requested_commit;
+    cnd_signal(&durability_p->wake_up);
+
+    while (durability_p->finished_commit < commit && durability_p->is_stopping == false)
+    {
+        cnd_wait(&durability_p->synced, &durability_p->mutex);
+    }
+
+    mtx_unlock(&durability_p->mutex);
+}
+
+
+static void __dlogger_durability_sync_files(void)
+{
+    if (dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == false)
+    {
+        return;
+    }
+
+    if (fdatasync(dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor) == -1)
+    {
+        perror("DLogger: cannot synchronize log file");
+    }
+
+    if (dlogger_priv_data.thread_files.is_key_created == false ||
+        mtx_lock(&dlogger_priv_data.thread_files.mutex) != thrd_success)
+    {
+        return;
+    }
+
+    for (const DLogger_thread_fileS* file_p = dlogger_priv_data.thread_files.files_p; file_p != NULL; file_p = file_p->next_p)
+    {
+        if (file_p->file_descriptor != -1 && fdatasync(file_p->file_descriptor) == -1)
+        {
+            perror("DLogger: cannot synchronize file of thread");
+        }
+    }
+
+    mtx_unlock(&dlogger_priv_data.thread_files.mutex);
+}
+
+
+static int __dlogger_durability_thread(void* const arg_p)
+{
+    (void)arg_p;
+
+    DLogger_durabilityS* const durability_p = &dlogger_priv_data.durability;
+    const DLogger_durability_optionsS* const options_p = &durability_p->options;
+
+    mtx_lock(&durability_p->mutex);
+
+    while (durability_p->is_stopping == false)
+    {
+        struct timespec deadline;
+        timespec_get(&deadline, TIME_UTC);
+
+        deadline.tv_sec += options_p->period_msec / 1000;
+        deadline.tv_nsec += (long)(options_p->period_msec % 1000) * 1000000;
+
+        if (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+
+        /* Sleep until commit is requested, limit of bytes is reached or period passes. */
+        while (durability_p->is_stopping == false && durability_p->requested_commit == durability_p->finished_commit &&
+               (options_p->max_bytes == 0 ||
+                atomic_load_explicit(&durability_p->unsynced_bytes, memory_order_relaxed) < options_p->max_bytes))
+        {
+            register const int ret = (options_p->period_msec > 0)
+                                     ? cnd_timedwait(&durability_p->wake_up, &durability_p->mutex, &deadline)
+                                     : cnd_wait(&durability_p->wake_up, &durability_p->mutex);
+
+            if (ret != thrd_success)
+            {
+                break;
+            }
+        }
+
+        if (durability_p->is_stopping == true)
+        {
+            break;
+        }
+
+        register const uint64_t commit = durability_p->requested_commit;
+
+        /* Period passed without any record, nothing to synchronize. */
+        if (commit == durability_p->finished_commit &&
+            atomic_load_explicit(&durability_p->unsynced_bytes, memory_order_relaxed) == 0)
+        {
+            continue;
+        }
+
+        mtx_unlock(&durability_p->mutex);
+
+        /* Records written during fdatasync are counted for the next commit. */
+        atomic_store_explicit(&durability_p->unsynced_bytes, 0, memory_order_relaxed);
+        __dlogger_durability_sync_files();
+
+        mtx_lock(&durability_p->mutex);
+
+        durability_p->finished_commit = commit;
+        cnd_broadcast(&durability_p->synced);
+    }
+
+    /* Waiting callers are released, dlogger_destroy synchronizes files for the last time. */
+    cnd_broadcast(&durability_p->synced);
+    mtx_unlock(&durability_p->mutex);
+
+    return 0;
+}
+
+
+static int __dlogger_async_start(const size_t queue_size, const DLogger_backpressureE backpressure,
+                                 const DLogger_writer_optionsS* const options_p)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    async_p->number_of_blocks = (queue_size + sizeof(DLogger_async_blockS) - 1) / sizeof(DLogger_async_blockS);
+    async_p->blocks_p = calloc(async_p->number_of_blocks, sizeof(*async_p->blocks_p));
+    async_p->records_p = calloc(async_p->number_of_blocks, sizeof(*async_p->records_p));
+
+    if (async_p->blocks_p == NULL || async_p->records_p == NULL)
+    {
+        perror("DLogger: calloc error for asynchronous queue");
+        goto error_alloc;
+    }
+
+    for (size_t i = 0; i + 1 < async_p->number_of_blocks; ++i)
+    {
+        async_p->blocks_p[i].next_p = &async_p->blocks_p[i + 1];
+    }
+
+    async_p->free_blocks_p = &async_p->blocks_p[0];
+    async_p->number_of_free_blocks = async_p->number_of_blocks;
+    async_p->backpressure = backpressure;
+    async_p->options = *options_p;
+    atomic_init(&async_p->wakeup, 0);
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    async_p->next_notice_sec = now.tv_sec + DLOGGER_DROPPED_NOTICE_PERIOD_SEC;
+
+    if (mtx_init(&async_p->mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: mutex of asynchronous queue cannot be initialized");
+        goto error_alloc;
+    }
+
+    if (cnd_init(&async_p->not_full) != thrd_success)
+    {
+        perror("DLogger: condition variable cannot be initialized");
+        goto error_not_full;
+    }
+
+    if (cnd_init(&async_p->written) != thrd_success)
+    {
+        perror("DLogger: condition variable cannot be initialized");
+        goto error_written;
+    }
+
+    if (thrd_create(&async_p->thread, __dlogger_async_writer, NULL) != thrd_success)
+    {
+        perror("DLogger: cannot create writer thread");
+        goto error_thread;
+    }
+
+    async_p->is_running = true;
+
+    return 0;
+
+error_thread:
+    cnd_destroy(&async_p->written);
+error_written:
+    cnd_destroy(&async_p->not_full);
+error_not_full:
+    mtx_destroy(&async_p->mutex);
+error_alloc:
+    free(async_p->blocks_p);
+    free(async_p->records_p);
+    memset(async_p, 0, sizeof(*async_p));
+
+    return -1;
+}
+
+
+static void __dlogger_async_stop(void)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    if (mtx_lock(&async_p->mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return;
+    }
+
+    async_p->is_stopping = true;
+    __dlogger_async_wake_up_writer();
+    mtx_unlock(&async_p->mutex);
+
+    thrd_join(async_p->thread, NULL);
+
+    cnd_destroy(&async_p->written);
+    cnd_destroy(&async_p->not_full);
+    mtx_destroy(&async_p->mutex);
+    free(async_p->blocks_p);
+    free(async_p->records_p);
+    memset(async_p, 0, sizeof(*async_p));
+}
+
+
+static void __dlogger_async_wake_up_writer(void)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    atomic_fetch_add_explicit(&async_p->wakeup, 1, memory_order_release);
+
+    if (async_p->is_parked == true)
+    {
+        async_p->is_parked = false;
+        syscall(SYS_futex, &async_p->wakeup, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+
+static inline int64_t __dlogger_monotonic_nsec(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+static void __dlogger_async_wait(const int64_t timeout_nsec)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    register const unsigned int wakeup = atomic_load_explicit(&async_p->wakeup, memory_order_relaxed);
+    register const int64_t start_nsec = __dlogger_monotonic_nsec();
+    register const int64_t spin_nsec = (int64_t)async_p->options.spin_usec * 1000;
+    register int64_t now_nsec = start_nsec;
+
+    mtx_unlock(&async_p->mutex);
+
+    /* Spinning costs CPU, but new record is noticed without system call on both sides. */
+    for (unsigned int i = 1; now_nsec - start_nsec < spin_nsec && now_nsec - start_nsec < timeout_nsec; ++i)
+    {
+        if (atomic_load_explicit(&async_p->wakeup, memory_order_acquire) != wakeup)
+        {
+            mtx_lock(&async_p->mutex);
+            return;
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+
+        /* Clock is checked rarely, it is much slower than load of futex word. */
+        if ((i & 63) == 0)
+        {
+            now_nsec = __dlogger_monotonic_nsec();
+        }
+    }
+
+    mtx_lock(&async_p->mutex);
+
+    register const int64_t left_nsec = timeout_nsec - (__dlogger_monotonic_nsec() - start_nsec);
+
+    if (left_nsec <= 0 || atomic_load_explicit(&async_p->wakeup, memory_order_relaxed) != wakeup)
+    {
+        return;
+    }
+
+    /* Producers see this flag under mutex, futex_wait returns immediately if word has been changed in meantime. */
+    async_p->is_parked = true;
+    mtx_unlock(&async_p->mutex);
+
+    const struct timespec timeout = { .tv_sec = left_nsec / 1000000000, .tv_nsec = left_nsec % 1000000000 };
+    syscall(SYS_futex, &async_p->wakeup, FUTEX_WAIT_PRIVATE, wakeup, &timeout, NULL, 0);
+
+    mtx_lock(&async_p->mutex);
+    async_p->is_parked = false;
+}
+
+
+static int __dlogger_read_numa_cpus(const int numa_node, cpu_set_t* const cpu_set_p)
+{
+    char path[PATH_MAX];
+    snprintf(&path[0], sizeof(path), "/sys/devices/system/node/node%d/cpulist", numa_node);
+
+    FILE* const file_p = fopen(&path[0], "r");
+
+    if (file_p == NULL)
+    {
+        perror("DLogger: cannot open list of CPUs of NUMA node");
+        return -1;
+    }
+
+    CPU_ZERO(cpu_set_p);
+
+    /* Format: ranges or single CPUs separated by comma, e.g. "0-3,8-11". */
+    int first_cpu = 0;
+    int last_cpu = 0;
+    int ret = 0;
+
+    while ((ret = fscanf(file_p, "%d", &first_cpu)) == 1)
+    {
+        last_cpu = first_cpu;
+        register const int separator = fgetc(file_p);
+
+        if (separator == '-' && fscanf(file_p, "%d", &last_cpu) == 1)
+        {
+            (void)fgetc(file_p);
+        }
+
+        for (int cpu = first_cpu; cpu <= last_cpu && cpu < CPU_SETSIZE; ++cpu)
+        {
+            CPU_SET((size_t)cpu, cpu_set_p);
+        }
+    }
+
+    fclose(file_p);
+
+    if (CPU_COUNT(cpu_set_p) == 0)
+    {
+        fprintf(stderr, "DLogger: NUMA node %d has not any CPU\n", numa_node);
+        return -1;
+    }
+
+    return 0;
+}
+
+
+static void __dlogger_async_place_writer(const DLogger_writer_optionsS* const options_p)
+{
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+
+    if (options_p->cpu >= 0 && options_p->cpu < CPU_SETSIZE)
+    {
+        CPU_SET((size_t)options_p->cpu, &cpu_set);
+    }
+    else if (options_p->numa_node >= 0 && __dlogger_read_numa_cpus(options_p->numa_node, &cpu_set) != 0)
+    {
+        CPU_ZERO(&cpu_set);
+    }
+
+    if (CPU_COUNT(&cpu_set) > 0)
+    {
+        register const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+
+        if (ret != 0)
+        {
+            fprintf(stderr, "DLogger: cannot set CPU affinity of writer thread: %s\n", strerror(ret));
+        }
+    }
+
+    if (options_p->sched_policy != SCHED_OTHER)
+    {
+        const struct sched_param param = { .sched_priority = options_p->sched_priority };
+        register const int ret = pthread_setschedparam(pthread_self(), options_p->sched_policy, &param);
+
+        if (ret != 0)
+        {
+            fprintf(stderr, "DLogger: cannot set scheduling policy of writer thread: %s\n", strerror(ret));
+        }
+    }
+}
+
+
+static void __dlogger_async_push(const int file_descriptor, const bool is_log_file, const DLogger_levelE level,
+                                 const struct iovec iov[const static 1], const int iovcnt)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    register const size_t size = __dlogger_iov_size(&iov[0], iovcnt);
+
+    /* Records of writer thread (summaries of repeated messages) are written directly, queue is empty at that time. */
+    if (dlogger_priv_is_async_writer == true)
+    {
+        struct iovec iov_copy[iovcnt];
+        memcpy(&iov_copy[0], &iov[0], sizeof(iov_copy));
+        __dlogger_write_iov(file_descriptor, &iov_copy[0], iovcnt);
+
+        if (is_log_file == true)
+        {
+            __dlogger_durability_after_write(file_descriptor, level, size);
+        }
+
+        return;
+    }
+
+    register const size_t number_of_blocks = (size == 0) ? 1 : (size + DLOGGER_ASYNC_BLOCK_SIZE - 1) / DLOGGER_ASYNC_BLOCK_SIZE;
+    register const bool is_never_dropped = level <= DLOGGER_LEVEL_CRITICAL;
+
+    if (mtx_lock(&async_p->mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return;
+    }
+
+    if (number_of_blocks > async_p->number_of_blocks)
+    {
+        if (is_never_dropped == true)
+        {
+            /* Record is bigger than whole queue. Wait until queue is written to keep order and write record directly. */
+            while (async_p->written_sequence != async_p->pushed_sequence)
+            {
+                cnd_wait(&async_p->written, &async_p->mutex);
+            }
+
+            struct iovec iov_copy[iovcnt];
+            memcpy(&iov_copy[0], &iov[0], sizeof(iov_copy));
+            __dlogger_write_iov(file_descriptor, &iov_copy[0], iovcnt);
+
+            if (is_log_file == true)
+            {
+                __dlogger_durability_after_write(file_descriptor, level, size);
+            }
+        }
+        else
+        {
+            ++async_p->dropped[level];
+            ++async_p->total_dropped[level];
+        }
+
+        mtx_unlock(&async_p->mutex);
+        return;
+    }
+
+    while (async_p->number_of_free_blocks < number_of_blocks)
+    {
+        if (__dlogger_async_evict(level) == true)
+        {
+            continue;
+        }
+
+        if (async_p->backpressure == DLOGGER_BACKPRESSURE_BLOCK || is_never_dropped == true)
+        {
+            cnd_wait(&async_p->not_full, &async_p->mutex);
+            continue;
+        }
+
+        ++async_p->dropped[level];
+        ++async_p->total_dropped[level];
+        mtx_unlock(&async_p->mutex);
+        return;
+    }
+
+    /* Take blocks from list of free blocks. */
+    DLogger_async_blockS* const first_block_p = async_p->free_blocks_p;
+    DLogger_async_blockS* last_block_p = first_block_p;
+
+    for (size_t i = 1; i < number_of_blocks; ++i)
+    {
+        last_block_p = last_block_p->next_p;
+    }
+
+    async_p->free_blocks_p = last_block_p->next_p;
+    async_p->number_of_free_blocks -= number_of_blocks;
+    last_block_p->next_p = NULL;
+
+    /* Copy parts of record into blocks. */
+    DLogger_async_blockS* block_p = first_block_p;
+    block_p->size = 0;
+
+    for (int i = 0; i < iovcnt; ++i)
+    {
+        const char* data_p = iov[i].iov_base;
+        register size_t data_left = iov[i].iov_len;
+
+        while (data_left > 0)
+        {
+            if (block_p->size == DLOGGER_ASYNC_BLOCK_SIZE)
+            {
+                block_p = block_p->next_p;
+                block_p->size = 0;
+            }
+
+            register const size_t space = DLOGGER_ASYNC_BLOCK_SIZE - block_p->size;
+            register const size_t chunk = (data_left < space) ? data_left : space;
+
+            memcpy(&block_p->data[block_p->size], data_p, chunk);
+            block_p->size += chunk;
+            data_p += chunk;
+            data_left -= chunk;
+        }
+    }
+
+    DLogger_async_recordS* const record_p = &async_p->records_p[first_block_p - async_p->blocks_p];
+
+    *record_p = (DLogger_async_recordS){
+        .older_p = async_p->newest_p,
+        .level_older_p = async_p->level_newest_p[level],
+        .first_block_p = first_block_p,
+        .number_of_blocks = number_of_blocks,
+        .file_descriptor = file_descriptor,
+        .level = level,
+        .sequence = ++async_p->pushed_sequence,
+        .is_log_file = is_log_file,
+    };
+
+    if (async_p->newest_p != NULL)
+    {
+        async_p->newest_p->newer_p = record_p;
+    }
+    else
+    {
+        async_p->oldest_p = record_p;
+    }
+
+    async_p->newest_p = record_p;
+
+    if (async_p->level_newest_p[level] != NULL)
+    {
+        async_p->level_newest_p[level]->level_newer_p = record_p;
+    }
+    else
+    {
+        async_p->level_oldest_p[level] = record_p;
+    }
+
+    async_p->level_newest_p[level] = record_p;
+    ++async_p->number_of_records;
+
+    __dlogger_async_wake_up_writer();
+
+    /* Application is going to be closed after FATAL, so record must be written before return. */
+    if (level == DLOGGER_LEVEL_FATAL)
+    {
+        while (async_p->written_sequence < record_p->sequence)
+        {
+            cnd_wait(&async_p->written, &async_p->mutex);
+        }
+    }
+
+    mtx_unlock(&async_p->mutex);
+}
+
+
+static void __dlogger_async_unlink(DLogger_async_recordS* const record_p)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    if (record_p->older_p != NULL)
+    {
+        record_p->older_p->newer_p = record_p->newer_p;
+    }
+    else
+    {
+        async_p->oldest_p = record_p->newer_p;
+    }
+
+    if (record_p->newer_p != NULL)
+    {
+        record_p->newer_p->older_p = record_p->older_p;
+    }
+    else
+    {
+        async_p->newest_p = record_p->older_p;
+    }
+
+    if (record_p->level_older_p != NULL)
+    {
+        record_p->level_older_p->level_newer_p = record_p->level_newer_p;
+    }
+    else
+    {
+        async_p->level_oldest_p[record_p->level] = record_p->level_newer_p;
+    }
+
+    if (record_p->level_newer_p != NULL)
+    {
+        record_p->level_newer_p->level_older_p = record_p->level_older_p;
+    }
+    else
+    {
+        async_p->level_newest_p[record_p->level] = record_p->level_older_p;
+    }
+
+    --async_p->number_of_records;
+}
+
+
+static void __dlogger_async_release(DLogger_async_recordS* const record_p)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    DLogger_async_blockS* last_block_p = record_p->first_block_p;
+
+    while (last_block_p->next_p != NULL)
+    {
+        last_block_p = last_block_p->next_p;
+    }
+
+    last_block_p->next_p = async_p->free_blocks_p;
+    async_p->free_blocks_p = record_p->first_block_p;
+    async_p->number_of_free_blocks += record_p->number_of_blocks;
+}
+
+
+static bool __dlogger_async_evict(const DLogger_levelE level)
+{
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    DLogger_async_recordS* victim_p = NULL;
+
+    switch (async_p->backpressure)
+    {
+        case DLOGGER_BACKPRESSURE_DROP_BY_PRIORITY:
+        {
+            /* The oldest record from the least important level, only less important than new record. */
+            for (int i = DLOGGER_LEVEL_MAX; i > (int)level && i > DLOGGER_LEVEL_CRITICAL && victim_p == NULL; --i)
+            {
+                victim_p = async_p->level_oldest_p[i];
+            }
+            break;
+        }
+        case DLOGGER_BACKPRESSURE_OVERWRITE_OLDEST:
+        {
+            /* The oldest record which can be dropped, FATAL and CRITICAL are skipped. */
+            for (int i = DLOGGER_LEVEL_ERROR; i <= DLOGGER_LEVEL_MAX; ++i)
+            {
+                DLogger_async_recordS* const record_p = async_p->level_oldest_p[i];
+
+                if (record_p != NULL && (victim_p == NULL || record_p->sequence < victim_p->sequence))
+                {
+                    victim_p = record_p;
+                }
+            }
+            break;
+        }
+        case DLOGGER_BACKPRESSURE_BLOCK:
+        case DLOGGER_BACKPRESSURE_DROP_NEW:
+        default:
+        {
+            break;
+        }
+    }
+
+    if (victim_p == NULL)
+    {
+        return false;
+    }
+
+    __dlogger_async_unlink(victim_p);
+    __dlogger_async_release(victim_p);
+
+    ++async_p->dropped[victim_p->level];
+    ++async_p->total_dropped[victim_p->level];
+
+    return true;
+}
+
+
+static void __dlogger_async_write_dropped_notice(void)
+{
+    static const DLogger_callsiteS callsite = { .file_p = __FILE__, .func_p = __func__, .line = __LINE__,
+                                                .level = DLOGGER_LEVEL_WARNING };
+
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+
+    char details[256];
+    register size_t details_size = 0;
+    register size_t total = 0;
+
+    for (size_t i = DLOGGER_LEVEL_FATAL; i <= DLOGGER_LEVEL_MAX; ++i)
+    {
+        if (async_p->dropped[i] > 0)
+        {
+            register const int ret = snprintf(&details[details_size], sizeof(details) - details_size, "%s%s: %zu",
+                                              (total > 0) ? ", " : "", dlogger_priv_level_strings[i], async_p->dropped[i]);
+            details_size += __dlogger_written_bytes(ret, sizeof(details) - details_size);
+            total += async_p->dropped[i];
+        }
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    async_p->next_notice_sec = now.tv_sec + DLOGGER_DROPPED_NOTICE_PERIOD_SEC;
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    memset(&async_p->dropped[0], 0, sizeof(async_p->dropped));
+
+    char message[512];
+    register const int ret = snprintf(&message[0], sizeof(message), "%zu messages dropped (%s)\n", total, &details[0]);
+    register const size_t message_size = __dlogger_written_bytes(ret, sizeof(message));
+
+    /* Records of writer thread are written directly, producers can queue records in meantime. */
+    mtx_unlock(&async_p->mutex);
+
+    __dlogger_write_notice(&callsite, &message[0], message_size);
+
+    mtx_lock(&async_p->mutex);
+}
+
+
+static int __dlogger_async_writer(void* const arg_p)
+{
+    (void)arg_p;
+
+    DLogger_async_queueS* const async_p = &dlogger_priv_data.async;
+    const DLogger_writer_optionsS* const options_p = &async_p->options;
+
+    __dlogger_async_place_writer(options_p);
+
+    dlogger_priv_is_async_writer = true;
+
+    if (mtx_lock(&async_p->mutex) != thrd_success)
+    {
+        perror("DLogger: cannot lock mutex");
+        return 0;
+    }
+
+    for (;;)
+    {
+        if (async_p->oldest_p == NULL)
+        {
+            if (async_p->is_stopping == true)
+            {
+                break;
+            }
+
+            /* Wake up periodically to write notice about dropped records even if nothing is logged. */
+            __dlogger_async_wait((int64_t)DLOGGER_DROPPED_NOTICE_PERIOD_SEC * 1000000000);
+        }
+
+        /* Wait a while for full batch, fewer bigger writes are cheaper than many small ones. */
+        if (async_p->oldest_p != NULL && options_p->batch_size > 0 && options_p->linger_usec > 0)
+        {
+            register const int64_t deadline_nsec = __dlogger_monotonic_nsec() + (int64_t)options_p->linger_usec * 1000;
+            register int64_t now_nsec = __dlogger_monotonic_nsec();
+
+            while (async_p->number_of_records < options_p->batch_size && async_p->is_stopping == false &&
+                   now_nsec < deadline_nsec)
+            {
+                __dlogger_async_wait(deadline_nsec - now_nsec);
+                now_nsec = __dlogger_monotonic_nsec();
+            }
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+        if (now.tv_sec >= async_p->next_notice_sec)
+        {
+            __dlogger_async_write_dropped_notice();
+
+            /* Summary is written only when queue is empty, so it follows all queued copies of repeated message. */
+            if (async_p->oldest_p == NULL)
+            {
+                mtx_unlock(&async_p->mutex);
+                __dlogger_flush_expired_repeated();
+                mtx_lock(&async_p->mutex);
+            }
+        }
+
+        if (async_p->oldest_p == NULL)
+        {
+            continue;
+        }
+
+        /* Take batch (whole queue if size is not limited), producers can push new records while it is written. */
+        DLogger_async_recordS* const batch_p = async_p->oldest_p;
+        DLogger_async_recordS* last_record_p = NULL;
+        size_t batch_records = 0;
+
+        while (async_p->oldest_p != NULL && (options_p->batch_size == 0 || batch_records < options_p->batch_size))
+        {
+            last_record_p = async_p->oldest_p;
+            __dlogger_async_unlink(last_record_p);
+            ++batch_records;
+        }
+
+        register const uint64_t batch_sequence = (async_p->oldest_p == NULL) ? async_p->pushed_sequence
+                                                                              : last_record_p->sequence;
+
+        mtx_unlock(&async_p->mutex);
+
+        /* Last record of batch still points to rest of queue, so batch is iterated by count. */
+        const DLogger_async_recordS* record_p = batch_p;
+
+        for (size_t i = 0; i < batch_records; ++i, record_p = record_p->newer_p)
+        {
+            enum { iov_size = 64 };
+            struct iovec iov[iov_size];
+            register int iovcnt = 0;
+            register size_t size = 0;
+
+            for (DLogger_async_blockS* block_p = record_p->first_block_p; block_p != NULL; block_p = block_p->next_p)
+            {
+                iov[iovcnt++] = (struct iovec){ .iov_base = &block_p->data[0], .iov_len = block_p->size };
+                size += block_p->size;
+
+                if (iovcnt == iov_size)
+                {
+                    __dlogger_write_iov(record_p->file_descriptor, &iov[0], iovcnt);
+                    iovcnt = 0;
+                }
+            }
+
+            if (iovcnt > 0)
+            {
+                __dlogger_write_iov(record_p->file_descriptor, &iov[0], iovcnt);
+            }
+
+            /* FATAL caller waits for written sequence, so its record is durable when caller returns. */
+            if (record_p->is_log_file == true)
+            {
+                __dlogger_durability_after_write(record_p->file_descriptor, record_p->level, size);
+            }
+        }
+
+        mtx_lock(&async_p->mutex);
+
+        DLogger_async_recordS* release_p = batch_p;
+
+        for (size_t i = 0; i < batch_records; ++i, release_p = release_p->newer_p)
+        {
+            __dlogger_async_release(release_p);
+        }
+
+        async_p->written_sequence = batch_sequence;
+
+        cnd_broadcast(&async_p->not_full);
+        cnd_broadcast(&async_p->written);
+    }
+
+    __dlogger_async_write_dropped_notice();
+
+    mtx_unlock(&async_p->mutex);
+
+    return 0;
+}
+
+
+static int __dlogger_shared_start(const size_t ring_size)
+{
+    register const size_t number_of_slots = (ring_size + sizeof(DLogger_shared_slotS) - 1) / sizeof(DLogger_shared_slotS);
+    register const size_t mapping_size = sizeof(DLogger_shared_ringS) + number_of_slots * sizeof(DLogger_shared_slotS);
+
+    /* Anonymous shared mapping is inherited by fork, so ring does not need name in file system. */
+    DLogger_shared_ringS* const ring_p = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (ring_p == MAP_FAILED)
+    {
+        perror("DLogger: cannot map shared ring");
+        return -1;
+    }
+
+    /* Atomics with lock inside are not shared between processes. */
+    if (atomic_is_lock_free(&ring_p->written_position) == false)
+    {
+        fprintf(stderr, "DLogger: shared ring requires lock-free atomics\n");
+        munmap(ring_p, mapping_size);
+        return -1;
+    }
+
+    /* Mapping is zeroed: sequence 0 does not match any position + 1, so ring is empty. */
+    ring_p->number_of_slots = number_of_slots;
+    ring_p->collector_process_id = getpid();
+    atomic_init(&ring_p->is_collecting, true);
+
+    dlogger_priv_data.shared.ring_p = ring_p;
+    dlogger_priv_data.shared.process_id = ring_p->collector_process_id;
+    dlogger_priv_data.shared.mapping_size = mapping_size;
+    atomic_init(&dlogger_priv_data.shared.is_stopping, false);
+
+    if (thrd_create(&dlogger_priv_data.shared.thread, __dlogger_shared_collector, NULL) != thrd_success)
+    {
+        perror("DLogger: cannot create collector thread");
+        munmap(ring_p, mapping_size);
+        dlogger_priv_data.shared.ring_p = NULL;
+        return -1;
+    }
+
+    dlogger_priv_data.shared.is_collector = true;
+
+    return 0;
+}
+
+
+static void __dlogger_shared_stop(void)
+{
+    DLogger_shared_ringS* const ring_p = dlogger_priv_data.shared.ring_p;
+
+    if (dlogger_priv_data.shared.is_collector == true)
+    {
+        /* Processes which still log write directly from now, already reserved records are written by collector. */
+        atomic_store(&ring_p->is_collecting, false);
+        atomic_store(&dlogger_priv_data.shared.is_stopping, true);
+
+        atomic_fetch_add(&ring_p->published, 1);
+        syscall(SYS_futex, &ring_p->published, FUTEX_WAKE, 1, NULL, NULL, 0);
+
+        thrd_join(dlogger_priv_data.shared.thread, NULL);
+
+        /* Producers waiting for space or for FATAL record see stopped collector. */
+        atomic_fetch_add(&ring_p->released, 1);
+        syscall(SYS_futex, &ring_p->released, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+
+    if (munmap(ring_p, dlogger_priv_data.shared.mapping_size) == -1)
+    {
+        perror("DLogger: cannot unmap shared ring");
+    }
+
+    dlogger_priv_data.shared.ring_p = NULL;
+    dlogger_priv_data.shared.is_collector = false;
+}
+
+
+static void __dlogger_shared_push(const size_t descriptor_index, const DLogger_levelE level,
+                                  const struct iovec iov[const static 1], const int iovcnt)
+{
+    DLogger_shared_ringS* const ring_p = dlogger_priv_data.shared.ring_p;
+
+    register const size_t size = __dlogger_iov_size(&iov[0], iovcnt);
+    register const size_t number_of_slots = ring_p->number_of_slots;
+    register const size_t record_slots = (size == 0) ? 1 : (size + DLOGGER_SHARED_SLOT_SIZE - 1) / DLOGGER_SHARED_SLOT_SIZE;
+
+    if (record_slots > number_of_slots || dlogger_priv_is_shared_collector == true ||
+        atomic_load_explicit(&ring_p->is_collecting, memory_order_acquire) == false)
+    {
+        __dlogger_shared_write_directly(descriptor_index, level, &iov[0], iovcnt);
+        return;
+    }
+
+    /* Slots of position are free when collector has written record which used them one lap before. */
+    uint64_t position = atomic_load_explicit(&ring_p->reserved_position, memory_order_relaxed);
+
+    for (;;)
+    {
+        if (position + record_slots > atomic_load_explicit(&ring_p->written_position, memory_order_acquire) + number_of_slots)
+        {
+            if (__dlogger_shared_wait_for_collector(ring_p, position + record_slots - number_of_slots) == false)
+            {
+                __dlogger_shared_write_directly(descriptor_index, level, &iov[0], iovcnt);
+                return;
+            }
+
+            position = atomic_load_explicit(&ring_p->reserved_position, memory_order_relaxed);
+            continue;
+        }
+
+        if (atomic_compare_exchange_weak_explicit(&ring_p->reserved_position, &position, position + record_slots,
+                                                  memory_order_relaxed, memory_order_relaxed))
+        {
+            break;
+        }
+    }
+
+    /* Reservation is signed at once, collector skips it if this process is killed before record is published. */
+    DLogger_shared_slotS* const first_slot_p = &ring_p->slots[position % number_of_slots];
+    first_slot_p->number_of_slots = (uint32_t)record_slots;
+    first_slot_p->process_id = dlogger_priv_data.shared.process_id;
+    atomic_store_explicit(&first_slot_p->reservation, position + 1, memory_order_release);
+
+    /* Copy parts of record into reserved slots, ring might wrap inside record. */
+    DLogger_shared_slotS* slot_p = first_slot_p;
+    register size_t slot = 0;
+    slot_p->size = 0;
+
+    for (int i = 0; i < iovcnt; ++i)
+    {
+        const char* data_p = iov[i].iov_base;
+        register size_t data_left = iov[i].iov_len;
+
+        while (data_left > 0)
+        {
+            if (slot_p->size == DLOGGER_SHARED_SLOT_SIZE)
+            {
+                slot_p = &ring_p->slots[(position + ++slot) % number_of_slots];
+                slot_p->size = 0;
+            }
+
+            register const size_t space = DLOGGER_SHARED_SLOT_SIZE - slot_p->size;
+            register const size_t chunk = (data_left < space) ? data_left : space;
+
+            memcpy(&slot_p->data[slot_p->size], data_p, chunk);
+            slot_p->size += (uint32_t)chunk;
+            data_p += chunk;
+            data_left -= chunk;
+        }
+    }
+
+    first_slot_p->descriptor_index = (int32_t)descriptor_index;
+    first_slot_p->level = (int32_t)level;
+    atomic_store_explicit(&first_slot_p->sequence, position + 1, memory_order_release);
+
+    /* Futex word is changed before flag is checked, so collector going to sleep returns from futex wait at once. */
+    atomic_fetch_add(&ring_p->published, 1);
+
+    if (atomic_load_explicit(&ring_p->is_collector_parked, memory_order_relaxed) != 0 &&
+        atomic_exchange(&ring_p->is_collector_parked, 0) != 0)
+    {
+        syscall(SYS_futex, &ring_p->published, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+
+    /* Application is going to be closed after FATAL, so record must be written before return. */
+    if (level == DLOGGER_LEVEL_FATAL && __dlogger_shared_wait_for_collector(ring_p, position + record_slots) == false)
+    {
+        __dlogger_shared_write_directly(descriptor_index, level, &iov[0], iovcnt);
+    }
+}
+
+
+static void __dlogger_shared_write_directly(const size_t descriptor_index, const DLogger_levelE level,
+                                            const struct iovec iov[const static 1], const int iovcnt)
+{
+    DLogger_shared_ringS* const ring_p = dlogger_priv_data.shared.ring_p;
+
+    /* Records published before are written first to keep order. Collector writes own records between batches. */
+    if (dlogger_priv_is_shared_collector == false)
+    {
+        (void)__dlogger_shared_wait_for_collector(ring_p, atomic_load(&ring_p->reserved_position));
+    }
+
+    register const int file_descriptor = dlogger_priv_data.descriptors[descriptor_index].file_descriptor;
+
+    struct iovec iov_copy[iovcnt];
+    memcpy(&iov_copy[0], &iov[0], sizeof(iov_copy));
+    __dlogger_write_iov(file_descriptor, &iov_copy[0], iovcnt);
+
+    if (descriptor_index == DLOGGER_OPTION_WRITE_TO_FILE)
+    {
+        __dlogger_durability_after_write(file_descriptor, level, __dlogger_iov_size(&iov[0], iovcnt));
+    }
+}
+
+
+static bool __dlogger_shared_wait_for_collector(DLogger_shared_ringS* const ring_p, const uint64_t position)
+{
+    const struct timespec timeout = { .tv_sec = 0, .tv_nsec = DLOGGER_SHARED_WAIT_NSEC };
+
+    for (;;)
+    {
+        /* Word is read before condition, futex wait returns at once if collector has freed slots in meantime. */
+        register const unsigned int released = atomic_load(&ring_p->released);
+
+        if (atomic_load(&ring_p->written_position) >= position)
+        {
+            return true;
+        }
+
+        if (atomic_load(&ring_p->is_collecting) == false)
+        {
+            return false;
+        }
+
+        atomic_fetch_add(&ring_p->number_of_waiters, 1);
+
+        register const long ret = (atomic_load(&ring_p->written_position) < position)
+                                  ? syscall(SYS_futex, &ring_p->released, FUTEX_WAIT, released, &timeout, NULL, 0)
+                                  : 0;
+
+        atomic_fetch_sub(&ring_p->number_of_waiters, 1);
+
+        /* Parent killed without dlogger_destroy never writes ring again, all producers switch to direct writes. */
+        if (ret == -1 && errno == ETIMEDOUT && kill(ring_p->collector_process_id, 0) == -1 && errno == ESRCH)
+        {
+            atomic_store(&ring_p->is_collecting, false);
+            return false;
+        }
+    }
+}
+
+
+static void __dlogger_shared_write_batch(DLogger_shared_batchS* const batch_p)
+{
+    if (batch_p->iovcnt == 0)
+    {
+        return;
+    }
+
+    register const int file_descriptor = dlogger_priv_data.descriptors[batch_p->descriptor_index].file_descriptor;
+    __dlogger_write_iov(file_descriptor, &batch_p->iov[0], batch_p->iovcnt);
+
+    if (batch_p->descriptor_index == DLOGGER_OPTION_WRITE_TO_FILE)
+    {
+        __dlogger_durability_after_write(file_descriptor, batch_p->level, batch_p->size);
+    }
+
+    batch_p->iovcnt = 0;
+    batch_p->level = DLOGGER_LEVEL_MAX;
+    batch_p->size = 0;
+}
+
+
+static uint64_t __dlogger_shared_collect(DLogger_shared_ringS* const ring_p, uint64_t position)
+{
+    DLogger_shared_batchS batch = { .iovcnt = 0, .descriptor_index = 0, .level = DLOGGER_LEVEL_MAX, .size = 0 };
+
+    register const size_t number_of_slots = ring_p->number_of_slots;
+    register const uint64_t first_position = position;
+
+    /* Slots are not freed before batch is written, so at most one lap of ring is collected. */
+    for (;;)
+    {
+        DLogger_shared_slotS* const first_slot_p = &ring_p->slots[position % number_of_slots];
+
+        if (atomic_load_explicit(&first_slot_p->sequence, memory_order_acquire) != position + 1)
+        {
+            break;
+        }
+
+        register const size_t descriptor_index = (size_t)first_slot_p->descriptor_index;
+        register const size_t record_slots = first_slot_p->number_of_slots;
+        register const DLogger_levelE level = (DLogger_levelE)first_slot_p->level;
+
+        if (batch.iovcnt > 0 && batch.descriptor_index != descriptor_index)
+        {
+            __dlogger_shared_write_batch(&batch);
+        }
+
+        /* Ring is writable by all processes, record with wrong descriptor is skipped. */
+        if (descriptor_index < DLOGGER_MAX_NR_OF_FD && dlogger_priv_data.descriptors[descriptor_index].is_filled == true)
+        {
+            batch.descriptor_index = descriptor_index;
+
+            for (size_t i = 0; i < record_slots; ++i)
+            {
+                if (batch.iovcnt == DLOGGER_SHARED_MAX_IOV)
+                {
+                    __dlogger_shared_write_batch(&batch);
+                }
+
+                DLogger_shared_slotS* const slot_p = &ring_p->slots[(position + i) % number_of_slots];
+
+                batch.iov[batch.iovcnt++] = (struct iovec){ .iov_base = &slot_p->data[0], .iov_len = slot_p->size };
+                batch.size += slot_p->size;
+            }
+
+            batch.level = (level < batch.level) ? level : batch.level;
+        }
+
+        position += record_slots;
+    }
+
+    __dlogger_shared_write_batch(&batch);
+
+    if (position != first_position)
+    {
+        __dlogger_shared_release(ring_p, position);
+    }
+
+    return position;
+}
+
+
+static void __dlogger_shared_release(DLogger_shared_ringS* const ring_p, const uint64_t position)
+{
+    /* Futex word is changed before number of waiters is checked, so producer going to sleep returns at once. */
+    atomic_store(&ring_p->written_position, position);
+    atomic_fetch_add(&ring_p->released, 1);
+
+    if (atomic_load(&ring_p->number_of_waiters) > 0)
+    {
+        syscall(SYS_futex, &ring_p->released, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+
+static uint64_t __dlogger_shared_skip_reservation(DLogger_shared_ringS* const ring_p, const uint64_t position,
+                                                  const bool is_expired)
+{
+    static const DLogger_callsiteS callsite = { .file_p = __FILE__, .func_p = __func__, .line = __LINE__,
+                                                .level = DLOGGER_LEVEL_ERROR };
+
+    register const size_t number_of_slots = ring_p->number_of_slots;
+    register const uint64_t reserved_position = atomic_load(&ring_p->reserved_position);
+    const DLogger_shared_slotS* const first_slot_p = &ring_p->slots[position % number_of_slots];
+
+    uint64_t next_position = position;
+
+    if (atomic_load_explicit(&first_slot_p->reservation, memory_order_acquire) == position + 1)
+    {
+        /* Process alive is waited for, only stop of collector gives up after timeout. */
+        if (__dlogger_is_process_dead(first_slot_p->process_id) == true ||
+            (is_expired == true && atomic_load(&dlogger_priv_data.shared.is_stopping) == true))
+        {
+            next_position = position + first_slot_p->number_of_slots;
+        }
+    }
+    else if (is_expired == true)
+    {
+        /* Producer was killed before it signed reservation, its record ends where next signed reservation begins. */
+        do
+        {
+            ++next_position;
+        } while (next_position < reserved_position &&
+                 atomic_load_explicit(&ring_p->slots[next_position % number_of_slots].reservation,
+                                      memory_order_acquire) != next_position + 1);
+    }
+
+    /* Record might have been published right before its producer exited. */
+    if (next_position == position || atomic_load_explicit(&first_slot_p->sequence, memory_order_acquire) == position + 1)
+    {
+        return position;
+    }
+
+    char message[128];
+    register const int ret = snprintf(&message[0], sizeof(message), "%" PRIu64 " slots lost, producer did not publish record\n",
+                                      next_position - position);
+    __dlogger_write_notice(&callsite, &message[0], __dlogger_written_bytes(ret, sizeof(message)));
+
+    __dlogger_shared_release(ring_p, next_position);
+
+    return next_position;
+}
+
+
+static bool __dlogger_is_process_dead(const pid_t process_id)
+{
+    if (kill(process_id, 0) == -1 && errno == ESRCH)
+    {
+        return true;
+    }
+
+    /* Zombie still exists for kill, but it never publishes. WNOWAIT leaves child for waitpid of application. */
+    siginfo_t info = { .si_pid = 0 };
+
+    return waitid(P_PID, (id_t)process_id, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid == process_id;
+}
+
+
+static int __dlogger_shared_collector(void* const arg_p)
+{
+    (void)arg_p;
+
+    DLogger_shared_ringS* const ring_p = dlogger_priv_data.shared.ring_p;
+    const struct timespec timeout = { .tv_sec = 0, .tv_nsec = DLOGGER_SHARED_WAIT_NSEC };
+
+    dlogger_priv_is_shared_collector = true;
+
+    uint64_t position = atomic_load(&ring_p->written_position);
+
+    /* Head of ring reserved and not published: since when it is waited for. */
+    uint64_t stalled_position = UINT64_MAX;
+    int64_t stalled_since_nsec = 0;
+
+    for (;;)
+    {
+        register const unsigned int published = atomic_load(&ring_p->published);
+        register uint64_t next_position = __dlogger_shared_collect(ring_p, position);
+
+        if (next_position == position && position != atomic_load(&ring_p->reserved_position))
+        {
+            register const int64_t now_nsec = __dlogger_monotonic_nsec();
+
+            if (stalled_position != position)
+            {
+                stalled_position = position;
+                stalled_since_nsec = now_nsec;
+            }
+
+            next_position = __dlogger_shared_skip_reservation(ring_p, position,
+                                                              now_nsec - stalled_since_nsec >= DLOGGER_SHARED_RESERVATION_TIMEOUT_NSEC);
+        }
+
+        if (next_position != position)
+        {
+            position = next_position;
+            continue;
+        }
+
+        /* Reserved record is waited for even during stop, unless its producer is killed or timeout expires. */
+        if (atomic_load(&dlogger_priv_data.shared.is_stopping) == true && position == atomic_load(&ring_p->reserved_position))
+        {
+            break;
+        }
+
+        atomic_store(&ring_p->is_collector_parked, 1);
+        syscall(SYS_futex, &ring_p->published, FUTEX_WAIT, published, &timeout, NULL, 0);
+        atomic_store(&ring_p->is_collector_parked, 0);
+    }
+
+    return 0;
+}
+
+
+static void __dlogger_register_fork_handlers(void)
+{
+    register const int ret = pthread_atfork(__dlogger_fork_prepare, __dlogger_fork_parent, __dlogger_fork_child);
+
+    if (ret != 0)
+    {
+        fprintf(stderr, "DLogger: cannot register fork handlers: %s\n", strerror(ret));
+    }
+}
+
+
+static void __dlogger_fork_prepare(void)
+{
+    if (dlogger_priv_data.is_init == false)
+    {
+        return;
+    }
+
+    /* The same order as in logging threads: metrics, main mutex, list of thread files, registered call-sites, arena. */
+    __dlogger_metrics_fork_prepare();
+    mtx_lock(&dlogger_priv_data.mutex);
+
+    if (dlogger_priv_data.thread_files.is_key_created == true)
+    {
+        mtx_lock(&dlogger_priv_data.thread_files.mutex);
+    }
+
+    __dlogger_callsite_fork_prepare();
+
+    if (dlogger_priv_data.arena.memory_p != NULL)
+    {
+        mtx_lock(&dlogger_priv_data.arena.mutex);
+    }
+
+    dlogger_priv_fork.is_locked = true;
+}
+
+
+static void __dlogger_fork_parent(void)
+{
+    if (dlogger_priv_fork.is_locked == false)
+    {
+        return;
+    }
+
+    if (dlogger_priv_data.arena.memory_p != NULL)
+    {
+        mtx_unlock(&dlogger_priv_data.arena.mutex);
+    }
+
+    __dlogger_callsite_fork_parent();
+
+    if (dlogger_priv_data.thread_files.is_key_created == true)
+    {
+        mtx_unlock(&dlogger_priv_data.thread_files.mutex);
+    }
+
+    mtx_unlock(&dlogger_priv_data.mutex);
+    __dlogger_metrics_fork_parent();
+
+    dlogger_priv_fork.is_locked = false;
+}
+
+
+static void __dlogger_fork_child(void)
+{
+    if (dlogger_priv_fork.is_locked == false)
+    {
+        return;
+    }
+
+    dlogger_priv_fork.is_locked = false;
+
+    __dlogger_callsite_fork_child();
+
+    /* Runs taken by other threads of parent are never released in child, nobody waits for them there. */
+    if (dlogger_priv_data.arena.memory_p != NULL)
+    {
+        if (mtx_init(&dlogger_priv_data.arena.mutex, mtx_plain) != thrd_success ||
+            cnd_init(&dlogger_priv_data.arena.released) != thrd_success)
+        {
+            perror("DLogger: cannot initialize synchronization of record arena");
+        }
+
+        __dlogger_arena_reset();
+    }
+
+    /* Mutexes are owned by thread of parent, child initializes them again. */
+    if (mtx_init(&dlogger_priv_data.mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: mutex cannot be initialized");
+    }
+
+    __dlogger_metrics_fork_child();
+
+    /* Files of parent threads stay open in parent, threads of child open own files with own thread ids. */
+    if (dlogger_priv_data.thread_files.is_key_created == true)
+    {
+        if (mtx_init(&dlogger_priv_data.thread_files.mutex, mtx_plain) != thrd_success)
+        {
+            perror("DLogger: cannot initialize mutex of files of threads");
+        }
+
+        for (const DLogger_thread_fileS* file_p = dlogger_priv_data.thread_files.files_p; file_p != NULL; file_p = file_p->next_p)
+        {
+            if (file_p->file_descriptor != -1)
+            {
+                close(file_p->file_descriptor);
+            }
+        }
+
+        __dlogger_reset_thread_files();
+        tss_set(dlogger_priv_data.thread_files.key, NULL);
+    }
+
+    /* Records in queue are written by writer thread of parent, child logs synchronously. */
+    if (dlogger_priv_data.async.is_running == true)
+    {
+        free(dlogger_priv_data.async.blocks_p);
+        free(dlogger_priv_data.async.records_p);
+        memset(&dlogger_priv_data.async, 0, sizeof(dlogger_priv_data.async));
+    }
+
+    /* Without group commit thread child synchronizes FATAL and CRITICAL records by itself. */
+    if (dlogger_priv_data.durability.is_running == true)
+    {
+        dlogger_priv_data.durability.is_running = false;
+        dlogger_priv_data.durability.options.durability = DLOGGER_DURABILITY_CRITICAL;
+    }
+
+    if (dlogger_priv_data.watcher.is_watching == true)
+    {
+        close(dlogger_priv_data.watcher.inotify_fd);
+        close(dlogger_priv_data.watcher.stop_fd);
+        dlogger_priv_data.watcher.is_watching = false;
+    }
+
+    /* Suppressed copies are counted by parent. */
+    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    {
+        memset(&dlogger_priv_data.descriptors[i].repeated, 0, sizeof(dlogger_priv_data.descriptors[i].repeated));
+    }
+
+    /* Child publishes into the same ring, collector stays in parent. */
+    dlogger_priv_data.shared.is_collector = false;
+    dlogger_priv_data.shared.process_id = getpid();
+
+    dlogger_priv_data.trace.process_id = getpid();
+    dlogger_priv_data.trace.is_owner = false;
+    dlogger_priv_trace_thread.thread_id = 0;
+}
+
+
+static uint64_t __dlogger_hash_message(const char* const message_p, const size_t message_size)
+{
+    register uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < message_size; ++i)
+    {
+        hash ^= (unsigned char)message_p[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+
+static void __dlogger_write_repeated_summary(DLogger_descriptorS* const descriptor_p)
+{
+    char buffer[1 << 12];
+
+    register const DLogger_options_markE marks = atomic_load_explicit(&descriptor_p->marks, memory_order_relaxed);
+    register size_t size = __dlogger_write_prefix(0, sizeof(buffer), &buffer[0], descriptor_p->repeated.callsite_p, marks);
+
+    register const int ret = snprintf(&buffer[size], sizeof(buffer) - size, "last message repeated %zu times\n",
+                                      descriptor_p->repeated.counter);
+    size += __dlogger_written_bytes(ret, sizeof(buffer) - size);
+
+    struct iovec iov = { .iov_base = &buffer[0], .iov_len = size };
+    __dlogger_write_record(descriptor_p, descriptor_p->repeated.callsite_p->level, &iov, 1, false);
+
+    descriptor_p->repeated.counter = 0;
+}
+
+
+static bool __dlogger_suppress_repeated(DLogger_descriptorS* const descriptor_p, const DLogger_callsiteS* const callsite_p,
+                                        const uint64_t hash, const size_t message_size)
+{
+    if (descriptor_p->repeated.callsite_p == callsite_p && descriptor_p->repeated.hash == hash &&
+        descriptor_p->repeated.message_size == message_size)
+    {
+        /* Coarse clock is enough for period in seconds and does not need system call. */
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+        if (descriptor_p->repeated.counter++ == 0)
+        {
+            descriptor_p->repeated.first_suppressed_sec = now.tv_sec;
+        }
+        else if (now.tv_sec - descriptor_p->repeated.first_suppressed_sec >= DLOGGER_REPEATED_SUMMARY_PERIOD_SEC)
+        {
+            __dlogger_write_repeated_summary(descriptor_p);
+        }
+
+        return true;
+    }
+
+    if (descriptor_p->repeated.counter > 0)
+    {
+        __dlogger_write_repeated_summary(descriptor_p);
+    }
+
+    descriptor_p->repeated.callsite_p = callsite_p;
+    descriptor_p->repeated.hash = hash;
+    descriptor_p->repeated.message_size = message_size;
+
+    return false;
+}
+
+
+void __dlogger_flush_expired_repeated(void)
+{
+    /* Logging thread might hold main mutex while it waits for background thread, then summary is written next time. */
+    if (dlogger_priv_data.is_init == false || mtx_trylock(&dlogger_priv_data.mutex) != thrd_success)
+    {
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+
+    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    {
+        DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        /* Last message is remembered, so next copies are still suppressed and counted for next summary. */
+        if (descriptor_p->is_filled == true && descriptor_p->repeated.counter > 0 &&
+            now.tv_sec - descriptor_p->repeated.first_suppressed_sec >= DLOGGER_REPEATED_SUMMARY_PERIOD_SEC)
+        {
+            __dlogger_write_repeated_summary(descriptor_p);
+        }
+    }
+
+    mtx_unlock(&dlogger_priv_data.mutex);
+}
+
+
+static void __dlogger_flush_repeated(DLogger_descriptorS* const descriptor_p)
+{
+    if (descriptor_p->repeated.counter > 0)
+    {
+        __dlogger_write_repeated_summary(descriptor_p);
+    }
+
+    descriptor_p->repeated.callsite_p = NULL;
+}
+
+
+static inline bool __dlogger_is_enabled(const DLogger_descriptorS* const descriptor_p, const DLogger_callsiteS* const callsite_p)
+{
+    if (descriptor_p->is_filled == false)
+    {
+        return false;
+    }
+
+    if (__atomic_load_n(&callsite_p->state, __ATOMIC_RELAXED) == DLOGGER_CALLSITE_ON)
+    {
+        return true;
+    }
+
+    return atomic_load_explicit(&descriptor_p->level, memory_order_relaxed) >= (int)callsite_p->level;
+}
+
+
+static void __dlogger_emit_record(const DLogger_callsiteS* const restrict callsite_p,
+                                  const char* const restrict message_p, const size_t message_size,
+                                  const DLogger_backtraceS* const restrict backtrace_p)
+{
+    /* Each thread has own buffer, so whole prefix is formatted without lock. */
+    static thread_local char prefix_buffer[1 << 12] = {0};
+    static const char newline[] = "\n";
+
+    register const bool with_newline = message_size == 0 || message_p[message_size - 1] != '\n';
+
+    /* Hash is calculated only once and only if any descriptor needs it. */
+    register bool is_hashed = false;
+    register uint64_t hash = 0;
+
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (__dlogger_is_enabled(descriptor_p, callsite_p) == false)
+        {
+            continue;
+        }
+
+        register const DLogger_options_markE marks = atomic_load_explicit(&descriptor_p->marks, memory_order_relaxed);
+
+        register const bool with_suppress = (marks & DLOGGER_OPTION_MARK_SUPPRESS_REPEATED) != 0;
+
+        if (with_suppress == true)
+        {
+            if (backtrace_p == NULL && is_hashed == false)
+            {
+                hash = __dlogger_hash_message(message_p, message_size);
+                is_hashed = true;
+            }
+
+            /* Check and write must be atomic, otherwise other thread could write message between them. */
+            if (mtx_lock(&dlogger_priv_data.mutex) != thrd_success)
+            {
+                perror("DLogger: cannot lock mutex");
+                continue;
+            }
+
+            /* Records with backtrace (fatal level) are never suppressed, but pending summary goes before them. */
+            if (backtrace_p != NULL)
+            {
+                __dlogger_flush_repeated(descriptor_p);
+            }
+            else if (__dlogger_suppress_repeated(descriptor_p, callsite_p, hash, message_size) == true)
+            {
+                mtx_unlock(&dlogger_priv_data.mutex);
+                continue;
+            }
+        }
+
+        register const size_t prefix_size = __dlogger_write_prefix(0, sizeof(prefix_buffer), &prefix_buffer[0], callsite_p, marks);
+
+        /* Message is not copied, it is written directly from buffer of caller. */
+        struct iovec iov[4];
+        register int iovcnt = 0;
+
+        iov[iovcnt++] = (struct iovec){ .iov_base = &prefix_buffer[0], .iov_len = prefix_size };
+        iov[iovcnt++] = (struct iovec){ .iov_base = (void*)(uintptr_t)message_p, .iov_len = message_size };
+
+        if (with_newline == true)
+        {
+            iov[iovcnt++] = (struct iovec){ .iov_base = (void*)(uintptr_t)&newline[0], .iov_len = sizeof(newline) - 1 };
+        }
+
+        if (backtrace_p != NULL)
+        {
+            if (marks & DLOGGER_OPTION_MARK_RAW_BACKTRACE)
+            {
+                iov[iovcnt++] = (struct iovec){ .iov_base = (void*)(uintptr_t)backtrace_p->raw_p, .iov_len = backtrace_p->raw_size };
+            }
+            else
+            {
+                iov[iovcnt++] = (struct iovec){ .iov_base = (void*)(uintptr_t)backtrace_p->symbols_p, .iov_len = backtrace_p->symbols_size };
+            }
+        }
+
+        /* With suppression of repeated messages main mutex is already taken. */
+        __dlogger_write_record(descriptor_p, callsite_p->level, &iov[0], iovcnt, with_suppress == false);
+
+        if (with_suppress == true)
+        {
+            mtx_unlock(&dlogger_priv_data.mutex);
+        }
+    }
+}
+
+
+static void __attribute__(( noinline )) __dlogger_emit_record_with_backtrace(const DLogger_callsiteS* const restrict callsite_p,
+                                                                              const char* const restrict message_p,
+                                                                              const size_t message_size)
+{
+    /* 
+     * If we save backtrace_size as: register const int we get clang warning: "variable length array folded to constant array as an extension"
+     * Simple workaround is just use enum or define.
+     */
+    enum { backtrace_size = 128 };
+    void* frames[backtrace_size];
+
+    register const int number_of_frames = backtrace(&frames[0], backtrace_size);
+
+    register bool with_symbols = false;
+    register bool with_raw = false;
+
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        const DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (__dlogger_is_enabled(descriptor_p, callsite_p) == true)
+        {
+            if (atomic_load_explicit(&descriptor_p->marks, memory_order_relaxed) & DLOGGER_OPTION_MARK_RAW_BACKTRACE)
+            {
+                with_raw = true;
+            }
+            else
+            {
+                with_symbols = true;
+            }
+        }
+    }
+
+    /* Backtrace has own buffers on stack of FATAL record, so it never waits for chunks of record arena. */
+    char symbols_buffer[1 << 14];
+    char raw_buffer[1 << 12];
+    DLogger_backtraceS backtrace_info = { .symbols_p = &symbols_buffer[0], .raw_p = &raw_buffer[0] };
+
+    if (with_symbols == true)
+    {
+        backtrace_info.symbols_size = __dlogger_write_backtrace(0, sizeof(symbols_buffer), &symbols_buffer[0], &frames[0], number_of_frames);
+    }
+
+    if (with_raw == true)
+    {
+        backtrace_info.raw_size = __dlogger_write_raw_backtrace(0, sizeof(raw_buffer), &raw_buffer[0], &frames[0], number_of_frames);
+    }
+
+    __dlogger_emit_record(callsite_p, message_p, message_size, &backtrace_info);
+}
+
+
+static void __dlogger_write_notice(const DLogger_callsiteS* const restrict callsite_p, const char* const restrict message_p,
+                                   const size_t message_size)
+{
+    char prefix[1 << 12];
+
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        const DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (__dlogger_is_enabled(descriptor_p, callsite_p) == false)
+        {
+            continue;
+        }
+
+        register const DLogger_options_markE marks = atomic_load_explicit(&descriptor_p->marks, memory_order_relaxed);
+        register const size_t prefix_size = __dlogger_write_prefix(0, sizeof(prefix), &prefix[0], callsite_p, marks);
+
+        struct iovec iov[] =
+        {
+            { .iov_base = &prefix[0], .iov_len = prefix_size },
+            { .iov_base = (void*)(uintptr_t)message_p, .iov_len = message_size },
+        };
+
+        __dlogger_write_record(descriptor_p, callsite_p->level, &iov[0], 2, true);
+    }
+}
+
+
+static bool __dlogger_is_any_enabled(const DLogger_callsiteS* const callsite_p)
+{
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        if (__dlogger_is_enabled(&dlogger_priv_data.descriptors[i], callsite_p) == true)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static size_t __dlogger_write_json_string(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
+                                          const char* const restrict string_p)
+{
+    if (buffer_index >= buffer_size)
+    {
+        perror("DLogger: end of internal buffer");
+        return 0;
+    }
+
+    register size_t written_bytes = buffer_index;
+
+    /* Place for the longest escape sequence (\u00XX) and terminating null is kept. */
+    for (const char* p = string_p; *p != '\0' && buffer_size - written_bytes > 7; ++p)
+    {
+        register const unsigned char c = (unsigned char)*p;
+        register int ret = 0;
+
+        if (c == '"' || c == '\\')
+        {
+            ret = snprintf(&buffer[written_bytes], buffer_size - written_bytes, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            ret = snprintf(&buffer[written_bytes], buffer_size - written_bytes, "\\u%04x", c);
+        }
+        else
+        {
+            ret = snprintf(&buffer[written_bytes], buffer_size - written_bytes, "%c", c);
+        }
+
+        written_bytes += __dlogger_written_bytes(ret, buffer_size - written_bytes);
+    }
+
+    return written_bytes - buffer_index;
+}
+
+
+static int __dlogger_trace_open(const char* const path_p)
+{
+    register const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+
+    /* O_APPEND keeps events from different threads separated, like records in unique log file. */
+    register const int fd = open(path_p, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, mode);
+
+    if (fd == -1)
+    {
+        perror("DLogger: cannot create trace file");
+        return -1;
+    }
+
+    static const char begin[] = "[\n";
+    struct iovec iov = { .iov_base = (void*)(uintptr_t)&begin[0], .iov_len = sizeof(begin) - 1 };
+    __dlogger_write_iov(fd, &iov, 1);
+
+    dlogger_priv_data.trace.is_filled = true;
+    dlogger_priv_data.trace.file_descriptor = fd;
+    dlogger_priv_data.trace.origin_nsec = (uint64_t)__dlogger_monotonic_nsec();
+    dlogger_priv_data.trace.process_id = getpid();
+    dlogger_priv_data.trace.is_owner = true;
+
+    return 0;
+}
+
+
+static void __dlogger_trace_close(void)
+{
+    /* Forked child writes only own events, array is closed once by creator of file. */
+    if (dlogger_priv_data.trace.is_owner == false)
+    {
+        if (close(dlogger_priv_data.trace.file_descriptor) == -1)
+        {
+            perror("DLogger: cannot close trace file");
+        }
+
+        return;
+    }
+
+    char name[NAME_MAX * 2] = {0};
+    __dlogger_write_json_string(0, sizeof(name), &name[0], program_invocation_short_name);
+
+    /* Metadata event without comma closes array, so file is valid JSON. */
+    char buffer[1 << 10];
+    register const int ret = snprintf(&buffer[0], sizeof(buffer),
+                                      "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,\"args\":{\"name\":\"%s\"}}\n]\n",
+                                      (long)dlogger_priv_data.trace.process_id, &name[0]);
+    register const size_t size = __dlogger_written_bytes(ret, sizeof(buffer));
+
+    struct iovec iov = { .iov_base = &buffer[0], .iov_len = size };
+    __dlogger_write_iov(dlogger_priv_data.trace.file_descriptor, &iov, 1);
+
+    if (close(dlogger_priv_data.trace.file_descriptor) == -1)
+    {
+        perror("DLogger: cannot close trace file");
+    }
+}
+
+
+static void __dlogger_trace_write_event(const DLogger_trace_spanS* const span_p, const uint64_t end_nsec)
+{
+    char buffer[1 << 11];
+    register size_t size = 0;
+
+    if (dlogger_priv_trace_thread.thread_id == 0)
+    {
+        dlogger_priv_trace_thread.thread_id = (pid_t)syscall(__NR_gettid);
+    }
+
+    /* Chrome expects microseconds, fraction keeps nanoseconds resolution. */
+    register const uint64_t start_nsec = span_p->start_nsec - dlogger_priv_data.trace.origin_nsec;
+    register const uint64_t duration_nsec = end_nsec - span_p->start_nsec;
+
+    /* Name and file are limited to quarter of buffer each, so the rest of event always fits. */
+    size += __dlogger_write_string(size, sizeof(buffer), &buffer[0], "{\"name\":\"");
+    size += __dlogger_write_json_string(size, size + sizeof(buffer) / 4, &buffer[0], span_p->name_p);
+
+    register int ret = snprintf(&buffer[size], sizeof(buffer) - size,
+                                "\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u,"
+                                "\"pid\":%ld,\"tid\":%ld,\"args\":{\"file\":\"",
+                                span_p->callsite_p->func_p,
+                                start_nsec / 1000, (unsigned int)(start_nsec % 1000),
+                                duration_nsec / 1000, (unsigned int)(duration_nsec % 1000),
+                                (long)dlogger_priv_data.trace.process_id, (long)dlogger_priv_trace_thread.thread_id);
+    size += __dlogger_written_bytes(ret, sizeof(buffer) - size);
+
+    size += __dlogger_write_json_string(size, size + sizeof(buffer) / 4, &buffer[0], span_p->callsite_p->file_p);
+
+    ret = snprintf(&buffer[size], sizeof(buffer) - size, "\",\"line\":%d}},\n", span_p->callsite_p->line);
+    size += __dlogger_written_bytes(ret, sizeof(buffer) - size);
+
+    struct iovec iov = { .iov_base = &buffer[0], .iov_len = size };
+
+    if (dlogger_priv_data.async.is_running == true)
+    {
+        __dlogger_async_push(dlogger_priv_data.trace.file_descriptor, false, DLOGGER_LEVEL_DEBUG, &iov, 1);
+    }
+    else
+    {
+        __dlogger_write_iov(dlogger_priv_data.trace.file_descriptor, &iov, 1);
+    }
+}
+
+
+static void __dlogger_trace_write_record(const DLogger_trace_spanS* const span_p, const uint64_t end_nsec)
+{
+    char buffer[1 << 10];
+
+    register const uint64_t duration_nsec = end_nsec - span_p->start_nsec;
+
+    register const int ret = snprintf(&buffer[0], sizeof(buffer), "trace %*s%s: %" PRIu64 ".%03u usec",
+                                      (int)(span_p->depth * 2), "", span_p->name_p,
+                                      duration_nsec / 1000, (unsigned int)(duration_nsec % 1000));
+
+    __dlogger_emit_record(span_p->callsite_p, &buffer[0], __dlogger_written_bytes(ret, sizeof(buffer)), NULL);
+}
+
+
+static inline DLogger_descriptor_optionsS __dlogger_parse_user_option(const DLogger_options_writeE descriptor_to_write,
+                                                                      const DLogger_levelE level_of_logging,
+                                                                      const DLogger_options_markE additional_options)
+{
+    const int fd[] = 
+    {
+        [DLOGGER_OPTION_WRITE_TO_FILE] = -1,
+        [DLOGGER_OPTION_WRITE_TO_STDERR] = 2,
+        [DLOGGER_OPTION_WRITE_TO_STDOUT] = 1,
+    };
+
+    return (DLogger_descriptor_optionsS){
+        .is_filled = true,
+        .file_descriptor = fd[descriptor_to_write],
+        .level = level_of_logging,
+        .marks = additional_options,
+    };
+}
+
+
+static int __dlogger_max_descriptor_level(void)
+{
+    register int max_level = -1;
+
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        const DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (descriptor_p->is_filled == true && atomic_load(&descriptor_p->level) > max_level)
+        {
+            max_level = atomic_load(&descriptor_p->level);
+        }
+    }
+
+    return max_level;
+}
+
+
+static void __dlogger_update_max_level(void)
+{
+    /*
+     * Concurrent update could overwrite newer maximum by older one. Every update checks levels again after its
+     * store, so the last store always matches levels of descriptors.
+     */
+    atomic_thread_fence(memory_order_seq_cst);
+
+    register int max_level = __dlogger_max_descriptor_level();
+    register int stored_level = 0;
+
+    do
+    {
+        stored_level = max_level;
+        __atomic_store_n(&__dlogger_max_level, stored_level, __ATOMIC_SEQ_CST);
+        max_level = __dlogger_max_descriptor_level();
+    } while (max_level != stored_level);
+
+    __dlogger_callsite_refresh_all();
+}
+
+
+static void __dlogger_signal_handler(const int signal_number)
+{
+    register const int step = (signal_number == dlogger_priv_data.signals.signal_more_verbose) ? 1 : -1;
+
+    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
+    {
+        DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (descriptor_p->is_filled == false)
+        {
+            continue;
+        }
+
+        register int level = atomic_load_explicit(&descriptor_p->level, memory_order_relaxed) + step;
+
+        if (level < (int)DLOGGER_LEVEL_FATAL || level > (int)DLOGGER_LEVEL_MAX)
+        {
+            continue;
+        }
+
+        atomic_store_explicit(&descriptor_p->level, level, memory_order_relaxed);
+    }
+
+    __dlogger_update_max_level();
+}
+
+
+static int __dlogger_apply_config_callsite(char** const save_pp)
+{
+    static const char* const state_strings[] =
+    {
+        [DLOGGER_CALLSITE_DEFAULT] = "default",
+        [DLOGGER_CALLSITE_ON] = "on",
+        [DLOGGER_CALLSITE_OFF] = "off",
+    };
+
+    register const char* const restrict delimiters_p = " \t";
+
+    const char* const token_file_p = strtok_r(NULL, delimiters_p, save_pp);
+    const char* const token_func_p = strtok_r(NULL, delimiters_p, save_pp);
+    const char* const token_state_p = strtok_r(NULL, delimiters_p, save_pp);
+
+    if (token_file_p == NULL || token_func_p == NULL || token_state_p == NULL)
+    {
+        fprintf(stderr, "DLogger: call-site line in configuration file needs file, function and state\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < sizeof(state_strings) / sizeof(state_strings[0]); ++i)
+    {
+        if (strcasecmp(token_state_p, state_strings[i]) == 0)
+        {
+            dlogger_callsite_set(token_file_p, token_func_p, (DLogger_callsite_stateE)i);
+            return 0;
+        }
+    }
+
+    fprintf(stderr, "DLogger: unknown call-site state %s in configuration file\n", token_state_p);
+    return -1;
+}
+
+
+static int __dlogger_apply_config_line(char line_p[const static 1])
+{
+    static const char* const descriptor_strings[] =
+    {
+        [DLOGGER_OPTION_WRITE_TO_FILE] = "file",
+        [DLOGGER_OPTION_WRITE_TO_STDERR] = "stderr",
+        [DLOGGER_OPTION_WRITE_TO_STDOUT] = "stdout",
+    };
+
+    static const struct
+    {
+        const char* name_p;
+        DLogger_options_markE mark;
+    } mark_strings[] =
+    {
+        { "timestamp", DLOGGER_OPTION_MARK_TIMESTAMP },
+        { "threadid", DLOGGER_OPTION_MARK_THREADID },
+        { "rawbacktrace", DLOGGER_OPTION_MARK_RAW_BACKTRACE },
+        { "suppressrepeated", DLOGGER_OPTION_MARK_SUPPRESS_REPEATED },
+        { "perthreadfile", DLOGGER_OPTION_MARK_PER_THREAD_FILE },
+    };
+
+    register const char* const restrict delimiters_p = " \t=,";
+    char* save_p = NULL;
+
+    const char* const token_descriptor_p = strtok_r(line_p, delimiters_p, &save_p);
+
+    if (token_descriptor_p == NULL || token_descriptor_p[0] == '#')
+    {
+        return 0;
+    }
+
+    if (strcasecmp(token_descriptor_p, "callsite") == 0)
+    {
+        return __dlogger_apply_config_callsite(&save_p);
+    }
+
+    const char* const token_level_p = strtok_r(NULL, delimiters_p, &save_p);
+
+    if (token_level_p == NULL)
+    {
+        fprintf(stderr, "DLogger: missing level for descriptor %s in configuration file\n", token_descriptor_p);
+        return -1;
+    }
+
+    register int descriptor = -1;
+
+    for (size_t i = 0; i < sizeof(descriptor_strings) / sizeof(descriptor_strings[0]); ++i)
+    {
+        if (strcasecmp(token_descriptor_p, descriptor_strings[i]) == 0)
+        {
+            descriptor = (int)i;
+        }
+    }
+
+    register int level = -1;
+
+    for (size_t i = 0; i < sizeof(dlogger_priv_level_strings) / sizeof(dlogger_priv_level_strings[0]); ++i)
+    {
+        if (strcasecmp(token_level_p, dlogger_priv_level_strings[i]) == 0)
+        {
+            level = (int)i;
+        }
+    }
+
+    if (descriptor == -1 || level == -1)
+    {
+        fprintf(stderr, "DLogger: unknown descriptor %s or level %s in configuration file\n", token_descriptor_p, token_level_p);
+        return -1;
+    }
+
+    DLogger_options_markE marks = 0;
+
+    for (const char* token_mark_p = strtok_r(NULL, delimiters_p, &save_p); token_mark_p != NULL; token_mark_p = strtok_r(NULL, delimiters_p, &save_p))
+    {
+        register bool is_known = false;
+
+        for (size_t i = 0; i < sizeof(mark_strings) / sizeof(mark_strings[0]); ++i)
+        {
+            if (strcasecmp(token_mark_p, mark_strings[i].name_p) == 0)
+            {
+                marks |= mark_strings[i].mark;
+                is_known = true;
+            }
+        }
+
+        if (is_known == false)
+        {
+            fprintf(stderr, "DLogger: unknown option %s in configuration file\n", token_mark_p);
+            return -1;
+        }
+    }
+
+    return dlogger_set_runtime_options((DLogger_options_writeE)descriptor, (DLogger_levelE)level, marks);
+}
+
+
+static int __dlogger_load_config_file(const char path_p[const static 1])
+{
+    register const int fd = open(path_p, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+    {
+        perror("DLogger: cannot open configuration file");
+        return -1;
+    }
+
+    char file_buffer[1 << 12] = {0};
+    register size_t file_buffer_index = 0;
+
+    while (file_buffer_index < sizeof(file_buffer) - 1)
+    {
+        register const ssize_t ret = read(fd, &file_buffer[file_buffer_index], sizeof(file_buffer) - 1 - file_buffer_index);
+
+        if (ret == -1 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (ret <= 0)
+        {
+            break;
+        }
+
+        file_buffer_index += (size_t)ret;
+    }
+
+    close(fd);
+
+    register int status = 0;
+    char* save_p = NULL;
+
+    for (char* line_p = strtok_r(&file_buffer[0], "\n", &save_p); line_p != NULL; line_p = strtok_r(NULL, "\n", &save_p))
+    {
+        status |= __dlogger_apply_config_line(line_p);
+    }
+
+    return status;
+}
+
+
+static int __dlogger_config_watcher(void* const arg_p)
+{
+    (void)arg_p;
+
+    const char* const path_p = &dlogger_priv_data.watcher.path[0];
+    const char* const slash_p = strrchr(path_p, '/');
+    const char* const filename_p = (slash_p == NULL) ? path_p : slash_p + 1;
+
+    for (;;)
+    {
+        struct pollfd poll_fds[] =
+        {
+            { .fd = dlogger_priv_data.watcher.inotify_fd, .events = POLLIN },
+            { .fd = dlogger_priv_data.watcher.stop_fd, .events = POLLIN },
+        };
+
+        if (poll(&poll_fds[0], sizeof(poll_fds) / sizeof(poll_fds[0]), -1) == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("DLogger: poll error in configuration watcher");
+            break;
+        }
+
+        if (poll_fds[1].revents & POLLIN)
+        {
+            break;
+        }
+
+        char events_buffer[1 << 12] __attribute__(( aligned(__alignof__(struct inotify_event)) ));
+        register const ssize_t length = read(dlogger_priv_data.watcher.inotify_fd, &events_buffer[0], sizeof(events_buffer));
+
+        if (length <= 0)
+        {
+            continue;
+        }
+
+        register bool is_changed = false;
+
+        for (ssize_t offset = 0; offset < length; )
+        {
+            const struct inotify_event* const event_p = (const struct inotify_event*)(void*)&events_buffer[offset];
+
+            if (event_p->len > 0 && strcmp(event_p->name, filename_p) == 0)
+            {
+                is_changed = true;
+            }
+
+            offset += (ssize_t)(sizeof(*event_p) + event_p->len);
+        }
+
+        if (is_changed == true)
+        {
+            __dlogger_load_config_file(path_p);
+        }
+    }
+
+    return 0;
+}
+
+
+static int __dlogger_try_create_unique_file(void)
+{
+    register int fd = -1;
+    register size_t tries = 0;
+    register const size_t max_tries = 10;
+
+    do
+    {
+        char filename_buffer[1 << 6] = {0};
+        register size_t filename_buffer_index = 0;
+
+        register const bool with_date = true;
+        register const bool with_h_min_sec = true;
+        register const bool with_usec = (tries > max_tries / 2) ? true : false;
+
+        /* first generate timestamp, then add file extension */
+        filename_buffer_index += __dlogger_write_timestamp(filename_buffer_index, sizeof(filename_buffer), &filename_buffer[0], 
+                                                           with_date, with_h_min_sec, with_usec);
+        filename_buffer_index += (size_t)snprintf(&filename_buffer[filename_buffer_index], 
+                                                  sizeof(filename_buffer) - filename_buffer_index, "%s", ".log");
+
+        /* somehow this file name exist, we need to try more times */
+        if (stat(&filename_buffer[0], &((struct stat){0})) != -1)
+        {
+            fprintf(stderr, "DLogger: file name: %s already exist. We will try more time %zu/%zu\n",
+                    &filename_buffer[0], tries, max_tries);
+
+            tries++;
+            sleep(1);
+            continue;
+        }
+
+        register const mode_t mode = S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH;
+
+        fd = creat(&filename_buffer[0], mode);
+
+        if (fd == -1)
+        {
+            perror("DLogger: cannot create file");
+            return -1;
+        }
+
+        /* O_APPEND makes each write of record atomic in relation to other threads, so lock is not needed. */
+        register const int flags = O_WRONLY | O_TRUNC | O_APPEND;
+        fd = open(&filename_buffer[0], flags);
+
+        if (fd == -1)
+        {
+            perror("DLogger: cannot open file");
+            return -1;
+        }
+
+        dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor = fd;
+        tries = max_tries;
+
+        /* Thread files get the same name with thread id before extension. */
+        memcpy(&dlogger_priv_data.thread_files.file_stem[0], &filename_buffer[0], filename_buffer_index - (sizeof(".log") - 1));
+
+    } while (tries < max_tries);
+
+    return fd;
+}
+
+
+DLogger_user_optionsS* dlogger_create_user_options(void)
+{
+    DLogger_user_optionsS* user_options_p = calloc(1, sizeof(*user_options_p));
+
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: calloc error");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    {
+        user_options_p->descriptors[i].file_descriptor = -1;
+    }
+
+    user_options_p->writer.cpu = -1;
+    user_options_p->writer.numa_node = -1;
+    user_options_p->writer.sched_policy = SCHED_OTHER;
+
+    return user_options_p;
+}
+
+
+void dlogger_destroy_user_options(DLogger_user_optionsS* user_options_p)
+{
+    free(user_options_p);
+    user_options_p = NULL;
+}
+
+
+void dlogger_set_user_options(DLogger_user_optionsS* const user_options_p,
+                              const DLogger_options_writeE descriptor_to_write,
+                              const DLogger_levelE level_of_logging,
+                              const DLogger_options_markE additional_options)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    user_options_p->descriptors[descriptor_to_write] = __dlogger_parse_user_option(descriptor_to_write, level_of_logging, additional_options);
+}
+
+
+void dlogger_set_async_options(DLogger_user_optionsS* const user_options_p,
+                               const size_t queue_size,
+                               const DLogger_backpressureE backpressure)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    if (backpressure > DLOGGER_BACKPRESSURE_OVERWRITE_OLDEST)
+    {
+        fprintf(stderr, "DLogger: wrong backpressure policy %d\n", (int)backpressure);
+        return;
+    }
+
+    user_options_p->queue_size = queue_size;
+    user_options_p->backpressure = backpressure;
+}
+
+
+void dlogger_set_writer_options(DLogger_user_optionsS* const user_options_p,
+                                const unsigned int spin_usec,
+                                const size_t batch_size,
+                                const unsigned int linger_usec)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    user_options_p->writer.spin_usec = spin_usec;
+    user_options_p->writer.batch_size = batch_size;
+    user_options_p->writer.linger_usec = linger_usec;
+}
+
+
+void dlogger_set_writer_placement(DLogger_user_optionsS* const user_options_p,
+                                  const int cpu,
+                                  const int numa_node,
+                                  const int sched_policy,
+                                  const int sched_priority)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    if (cpu < -1 || numa_node < -1)
+    {
+        fprintf(stderr, "DLogger: wrong CPU %d or NUMA node %d\n", cpu, numa_node);
+        return;
+    }
+
+    user_options_p->writer.cpu = cpu;
+    user_options_p->writer.numa_node = numa_node;
+    user_options_p->writer.sched_policy = sched_policy;
+    user_options_p->writer.sched_priority = sched_priority;
+}
+
+
+void dlogger_set_trace_options(DLogger_user_optionsS* const user_options_p, const char* const trace_path_p)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    if (trace_path_p == NULL)
+    {
+        user_options_p->trace_path[0] = '\0';
+        return;
+    }
+
+    if (strlen(trace_path_p) >= sizeof(user_options_p->trace_path))
+    {
+        fprintf(stderr, "DLogger: path to trace file is too long\n");
+        return;
+    }
+
+    strcpy(&user_options_p->trace_path[0], trace_path_p);
+}
+
+
+void dlogger_set_durability_options(DLogger_user_optionsS* const user_options_p, const DLogger_durabilityE durability,
+                                    const unsigned int period_msec, const size_t max_bytes)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    if (durability > DLOGGER_DURABILITY_GROUP_COMMIT)
+    {
+        perror("DLogger: wrong durability");
+        return;
+    }
+
+    user_options_p->durability = (DLogger_durability_optionsS){
+        .durability = durability,
+        .period_msec = period_msec,
+        .max_bytes = max_bytes,
+    };
+}
+
+
+void dlogger_set_metrics_options(DLogger_user_optionsS* const user_options_p, const unsigned int period_sec)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    user_options_p->metrics_period_sec = period_sec;
+}
+
+
+void dlogger_set_multiprocess_options(DLogger_user_optionsS* const user_options_p, const size_t ring_size)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    user_options_p->shared_ring_size = ring_size;
+}
+
+
+void dlogger_set_arena_options(DLogger_user_optionsS* const user_options_p, const size_t number_of_chunks, const size_t chunk_size)
+{
+    if (user_options_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return;
+    }
+
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: options can be specify before initialization");
+        return;
+    }
+
+    user_options_p->arena_chunks = number_of_chunks;
+    user_options_p->arena_chunk_size = chunk_size;
+}
+
+
+int dlogger_create(const DLogger_user_optionsS* const user_options_p)
+{
+    if (dlogger_priv_data.is_init == true)
+    {
+        perror("DLogger: dlogger cannot be initialized more than once");
+        return 1;
+    }
+
+    DLogger_user_optionsS default_options = {0};
+    const DLogger_user_optionsS* options_p = user_options_p;
+
+    if (user_options_p == NULL)
+    {
+        default_options.descriptors[DLOGGER_OPTION_WRITE_TO_FILE] = 
+            __dlogger_parse_user_option(DLOGGER_OPTION_WRITE_TO_FILE,
+                                        DLOGGER_LEVEL_MAX,
+                                        DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_THREADID);
+        options_p = &default_options;
+    }
+
+    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    {
+        DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        descriptor_p->is_filled = options_p->descriptors[i].is_filled;
+        descriptor_p->file_descriptor = options_p->descriptors[i].file_descriptor;
+        atomic_init(&descriptor_p->level, (int)options_p->descriptors[i].level);
+        atomic_init(&descriptor_p->marks, options_p->descriptors[i].marks);
+    }
+
+    if (dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
+    {
+        register const int fd = __dlogger_try_create_unique_file();
+
+        if (fd == -1)
+        {
+            perror("DLogger: cannot create or open log file");
+            memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
+            return -1;
+        }
+
+        dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor = fd;
+
+        /* Format of file is fixed, so reader never finds frames mixed with plain records. */
+        dlogger_priv_data.frame.is_enabled =
+            (options_p->descriptors[DLOGGER_OPTION_WRITE_TO_FILE].marks & DLOGGER_OPTION_MARK_FRAMED) != 0;
+    }
+
+    if (mtx_init(&dlogger_priv_data.mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: mutex cannot be initialized");
+        memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
+        return -1;
+    }
+
+    if (__dlogger_arena_start(options_p->arena_chunks, options_p->arena_chunk_size) != 0)
+    {
+        goto error_arena;
+    }
+
+    /* First call of backtrace loads unwinder library (malloc inside), do it now instead of in FATAL path. */
+    void* frame_p = NULL;
+    backtrace(&frame_p, 1);
+
+    /* The same for time zone, it is loaded by the first localtime_r. */
+    tzset();
+
+    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    {
+        const DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[i];
+
+        if (descriptor_p->is_filled == true && (atomic_load(&descriptor_p->marks) & DLOGGER_OPTION_MARK_RAW_BACKTRACE))
+        {
+            __dlogger_write_modules(descriptor_p);
+        }
+    }
+
+    /*
+     * Key is created even without DLOGGER_OPTION_MARK_PER_THREAD_FILE, mark can be set in run-time.
+     * It is created after list of modules is written, so the list stays in unique file.
+     */
+    if (dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
+    {
+        if (mtx_init(&dlogger_priv_data.thread_files.mutex, mtx_plain) != thrd_success)
+        {
+            perror("DLogger: cannot initialize mutex of files of threads");
+        }
+        else if (tss_create(&dlogger_priv_data.thread_files.key, __dlogger_close_thread_file) == thrd_success)
+        {
+            __dlogger_reset_thread_files();
+            dlogger_priv_data.thread_files.is_key_created = true;
+        }
+        else
+        {
+            perror("DLogger: cannot create key for files of threads");
+            mtx_destroy(&dlogger_priv_data.thread_files.mutex);
+        }
+    }
+
+    if (__dlogger_durability_start(&options_p->durability) != 0)
+    {
+        goto error_durability;
+    }
+
+    if (options_p->trace_path[0] != '\0' && __dlogger_trace_open(&options_p->trace_path[0]) != 0)
+    {
+        goto error_trace;
+    }
+
+    /* Shared ring replaces asynchronous queue, both let caller skip write to file. */
+    if (options_p->shared_ring_size > 0)
+    {
+        if (__dlogger_shared_start(options_p->shared_ring_size) != 0)
+        {
+            goto error_async;
+        }
+    }
+    else if (options_p->queue_size > 0 && __dlogger_async_start(options_p->queue_size, options_p->backpressure,
+                                                                      &options_p->writer) != 0)
+    {
+        goto error_async;
+    }
+
+    /* Handlers are registered even without multi-process mode, child of any application must not inherit locked mutex. */
+    call_once(&dlogger_priv_fork.once, __dlogger_register_fork_handlers);
+
+    __dlogger_update_max_level();
+    dlogger_priv_data.is_init = true;
+
+    /* Logging works without metrics, so failure is only reported. */
+    if (__dlogger_metrics_start(options_p->metrics_period_sec) != 0)
+    {
+        perror("DLogger: cannot start metrics");
+    }
+
+    const char* const config_path_p = getenv("DLOGGER_CONFIG_FILE");
+
+    if (config_path_p != NULL)
+    {
+        dlogger_watch_config_file(config_path_p);
+    }
+
+    return 0;
+
+error_async:
+    if (dlogger_priv_data.trace.is_filled == true)
+    {
+        close(dlogger_priv_data.trace.file_descriptor);
+    }
+error_trace:
+    __dlogger_durability_stop();
+error_durability:
+    if (dlogger_priv_data.thread_files.is_key_created == true)
+    {
+        __dlogger_close_thread_files();
+    }
+
+    __dlogger_arena_stop();
+error_arena:
+    mtx_destroy(&dlogger_priv_data.mutex);
+
+    if (dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
+    {
+        close(dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor);
+    }
+
+    memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
+    return -1;
+}
+
+
+void dlogger_destroy(void)
+{
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return;
+    }
+
+    if (dlogger_priv_data.watcher.is_watching == true)
+    {
+        if (eventfd_write(dlogger_priv_data.watcher.stop_fd, 1) == -1)
+        {
+            perror("DLogger: cannot stop configuration watcher");
+        }
+
+        thrd_join(dlogger_priv_data.watcher.thread, NULL);
+        close(dlogger_priv_data.watcher.inotify_fd);
+        close(dlogger_priv_data.watcher.stop_fd);
+    }
+
+    if (dlogger_priv_data.signals.signal_more_verbose != 0)
+    {
+        sigaction(dlogger_priv_data.signals.signal_more_verbose, &dlogger_priv_data.signals.old_more_verbose_action, NULL);
+    }
+
+    if (dlogger_priv_data.signals.signal_less_verbose != 0)
+    {
+        sigaction(dlogger_priv_data.signals.signal_less_verbose, &dlogger_priv_data.signals.old_less_verbose_action, NULL);
+    }
+
+    /* The last report of metrics is written before queue is stopped. */
+    __dlogger_metrics_stop();
+
+    /* Do not lose number of suppressed messages. */
+    if (mtx_lock(&dlogger_priv_data.mutex) == thrd_success)
+    {
+        for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+        {
+            if (dlogger_priv_data.descriptors[i].is_filled == true)
+            {
+                __dlogger_flush_repeated(&dlogger_priv_data.descriptors[i]);
+            }
+        }
+
+        mtx_unlock(&dlogger_priv_data.mutex);
+    }
+
+    /* All queued records are written before descriptors are closed. */
+    if (dlogger_priv_data.async.is_running == true)
+    {
+        __dlogger_async_stop();
+    }
+
+    if (dlogger_priv_data.shared.ring_p != NULL)
+    {
+        __dlogger_shared_stop();
+    }
+
+    if (dlogger_priv_data.trace.is_filled == true)
+    {
+        __dlogger_trace_close();
+    }
+
+    /* All records are written, the last commit makes them durable before files are closed. */
+    __dlogger_durability_stop();
+
+    if (dlogger_priv_data.thread_files.is_key_created == true)
+    {
+        __dlogger_close_thread_files();
+    }
+
+    __dlogger_arena_stop();
+
+    __dlogger_callsite_destroy();
+
+    mtx_destroy(&dlogger_priv_data.mutex);
+
+    if (dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
+    {
+        if (close(dlogger_priv_data.descriptors[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor) == -1)
+        {
+            perror("DLogger: cannot close log descriptor");
+        }
+    }
+
+    memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
+
+    /* The same like before dlogger_create, logging macros report that DLogger is not initialized. */
+    __atomic_store_n(&__dlogger_max_level, DLOGGER_PRIV_LEVEL_MAX, __ATOMIC_SEQ_CST);
+    __dlogger_callsite_refresh_all();
+}
+
+
+int dlogger_set_runtime_options(const DLogger_options_writeE descriptor_to_write,
+                                const DLogger_levelE level_of_logging,
+                                const DLogger_options_markE additional_options)
+{
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return -1;
+    }
+
+    if (descriptor_to_write > DLOGGER_OPTION_WRITE_TO_STDOUT || level_of_logging > DLOGGER_LEVEL_MAX)
+    {
+        fprintf(stderr, "DLogger: wrong descriptor %d or level %d\n", (int)descriptor_to_write, (int)level_of_logging);
+        return -1;
+    }
+
+    DLogger_descriptorS* const descriptor_p = &dlogger_priv_data.descriptors[descriptor_to_write];
+
+    if (descriptor_p->is_filled == false)
+    {
+        fprintf(stderr, "DLogger: descriptor %d has not been specified in dlogger_create\n", (int)descriptor_to_write);
+        return -1;
+    }
+
+    atomic_store_explicit(&descriptor_p->level, (int)level_of_logging, memory_order_relaxed);
+    __dlogger_update_max_level();
+
+    register const DLogger_options_markE old_marks = atomic_exchange_explicit(&descriptor_p->marks, additional_options, memory_order_relaxed);
+
+    if ((additional_options & DLOGGER_OPTION_MARK_RAW_BACKTRACE) && !(old_marks & DLOGGER_OPTION_MARK_RAW_BACKTRACE))
+    {
+        __dlogger_write_modules(descriptor_p);
+    }
+
+    if (!(additional_options & DLOGGER_OPTION_MARK_SUPPRESS_REPEATED) && (old_marks & DLOGGER_OPTION_MARK_SUPPRESS_REPEATED) &&
+        mtx_lock(&dlogger_priv_data.mutex) == thrd_success)
+    {
+        __dlogger_flush_repeated(descriptor_p);
+        mtx_unlock(&dlogger_priv_data.mutex);
+    }
+
+    return 0;
+}
+
+
+size_t dlogger_dropped_messages(const DLogger_levelE level)
+{
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return 0;
+    }
+
+    if (level > DLOGGER_LEVEL_MAX)
+    {
+        fprintf(stderr, "DLogger: wrong level %d\n", (int)level);
+        return 0;
+    }
+
+    if (dlogger_priv_data.async.is_running == false || mtx_lock(&dlogger_priv_data.async.mutex) != thrd_success)
+    {
+        return 0;
+    }
+
+    register const size_t dropped = dlogger_priv_data.async.total_dropped[level];
+
+    mtx_unlock(&dlogger_priv_data.async.mutex);
 
-    return (size_t)snprintf(&buffer[buffer_index], buffer_size - buffer_index,
-                            fmt_p, dlogger_priv_level_strings[level], &spaces_to_fill[0]);
+    return dropped;
 }
 
 
-static size_t __dlogger_write_file_line_func(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1],
-                                             const char *const restrict file_p, const int line, const char *const restrict func_p)
+size_t dlogger_truncated_messages(void)
 {
-    if (buffer_index >= buffer_size)
+    if (dlogger_priv_data.is_init == false)
     {
-        perror("DLogger: end of internal buffer");
+        perror("DLogger: first initialize DLogger");
         return 0;
     }
 
-    register const char* const restrict fmt_p = "[%s:%d %s] ";
-
-    return (size_t)snprintf(&buffer[buffer_index], buffer_size - buffer_index, fmt_p, file_p, line, func_p);
+    return atomic_load_explicit(&dlogger_priv_data.arena.truncated, memory_order_relaxed);
 }
 
 
-static size_t __dlogger_write_thread_id(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1])
+int dlogger_install_signal_handlers(const int signal_more_verbose, const int signal_less_verbose)
 {
-    if (buffer_index >= buffer_size)
+    if (dlogger_priv_data.is_init == false)
     {
-        perror("DLogger: end of internal buffer");
-        return 0;
+        perror("DLogger: first initialize DLogger");
+        return -1;
     }
 
-    register const pid_t thread_id = (pid_t)syscall(__NR_gettid);
+    if (dlogger_priv_data.signals.signal_more_verbose != 0 || dlogger_priv_data.signals.signal_less_verbose != 0)
+    {
+        fprintf(stderr, "DLogger: signal handlers have been already installed\n");
+        return -1;
+    }
 
+    struct sigaction action = {0};
+    action.sa_handler = __dlogger_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
 
-    register const char* const restrict fmt_p = "[TID %ld] ";
+    dlogger_priv_data.signals.signal_more_verbose = signal_more_verbose;
+    dlogger_priv_data.signals.signal_less_verbose = signal_less_verbose;
+
+    if (signal_more_verbose != 0 &&
+        sigaction(signal_more_verbose, &action, &dlogger_priv_data.signals.old_more_verbose_action) == -1)
+    {
+        perror("DLogger: cannot install signal handler");
+        dlogger_priv_data.signals.signal_more_verbose = 0;
+        dlogger_priv_data.signals.signal_less_verbose = 0;
+        return -1;
+    }
+
+    if (signal_less_verbose != 0 &&
+        sigaction(signal_less_verbose, &action, &dlogger_priv_data.signals.old_less_verbose_action) == -1)
+    {
+        perror("DLogger: cannot install signal handler");
+
+        if (signal_more_verbose != 0)
+        {
+            sigaction(signal_more_verbose, &dlogger_priv_data.signals.old_more_verbose_action, NULL);
+        }
+
+        dlogger_priv_data.signals.signal_more_verbose = 0;
+        dlogger_priv_data.signals.signal_less_verbose = 0;
+        return -1;
+    }
 
-    return (size_t)snprintf(&buffer[buffer_index], buffer_size - buffer_index, fmt_p, (long)thread_id);
+    return 0;
 }
 
 
-static size_t __dlogger_write_backtrace(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1])
+int dlogger_watch_config_file(const char* const path_p)
 {
-    if (buffer_index >= buffer_size)
+    if (path_p == NULL)
     {
-        perror("DLogger: end of internal buffer");
-        return 0;
+        perror("DLogger: pass NULL pointer");
+        return -1;
     }
 
-    /* 
-     * If we save backtrace_size as: register const int we get clang warning: "variable length array folded to constant array as an extension"
-     * Simple workaround is just use enum or define.
-     */
-    enum { backtrace_size = 128 };
-    void* backtrace_buffer[backtrace_size];
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return -1;
+    }
 
-    register const int number_of_frames = backtrace(&backtrace_buffer[0], backtrace_size);
+    if (dlogger_priv_data.watcher.is_watching == true)
+    {
+        fprintf(stderr, "DLogger: configuration file %s is already watched\n", &dlogger_priv_data.watcher.path[0]);
+        return -1;
+    }
 
-    char** backtrace_strings_pp = backtrace_symbols(&backtrace_buffer[0], number_of_frames);
+    register const int ret = snprintf(&dlogger_priv_data.watcher.path[0], sizeof(dlogger_priv_data.watcher.path), "%s", path_p);
 
-    if (backtrace_strings_pp == NULL)
+    if (ret < 0 || (size_t)ret >= sizeof(dlogger_priv_data.watcher.path))
     {
-        perror("DLogger: error with backtrace symbols");
-        return 0;
+        fprintf(stderr, "DLogger: path to configuration file is too long\n");
+        return -1;
     }
 
-    register size_t bytes_written = buffer_index;
-
-    bytes_written += (size_t)snprintf(&buffer[bytes_written], buffer_size - bytes_written, "Backtrace:\n");
+    /* Editors usually replace file by rename, so we need to watch directory instead of file. */
+    char directory[PATH_MAX] = {0};
+    const char* const slash_p = strrchr(path_p, '/');
 
-    for (size_t i = 0; i < (size_t)number_of_frames; ++i)
+    if (slash_p == NULL)
     {
-        bytes_written += (size_t)snprintf(&buffer[bytes_written], buffer_size - bytes_written, "%s\n", backtrace_strings_pp[i]);
+        directory[0] = '.';
+    }
+    else
+    {
+        memcpy(&directory[0], path_p, (slash_p == path_p) ? 1 : (size_t)(slash_p - path_p));
     }
 
-    free(backtrace_strings_pp);
-
-    return bytes_written - buffer_index;
-}
+    dlogger_priv_data.watcher.inotify_fd = inotify_init1(IN_CLOEXEC);
 
+    if (dlogger_priv_data.watcher.inotify_fd == -1)
+    {
+        perror("DLogger: cannot initialize inotify");
+        return -1;
+    }
 
-static void __dlogger_add_newline(const size_t buffer_index, const size_t buffer_size, char buffer[const static 1])
-{
-    if (buffer_index >= buffer_size)
+    if (inotify_add_watch(dlogger_priv_data.watcher.inotify_fd, &directory[0], IN_CLOSE_WRITE | IN_MOVED_TO) == -1)
     {
-        perror("DLogger: end of internal buffer");
-        return;
+        perror("DLogger: cannot watch directory of configuration file");
+        close(dlogger_priv_data.watcher.inotify_fd);
+        return -1;
     }
 
-    if (buffer[buffer_index - 1] != '\n')
+    dlogger_priv_data.watcher.stop_fd = eventfd(0, EFD_CLOEXEC);
+
+    if (dlogger_priv_data.watcher.stop_fd == -1)
     {
-        buffer[buffer_index] = '\n';
-        buffer[buffer_index + 1] = '\0';
+        perror("DLogger: cannot create eventfd");
+        close(dlogger_priv_data.watcher.inotify_fd);
+        return -1;
     }
-}
 
+    __dlogger_load_config_file(&dlogger_priv_data.watcher.path[0]);
 
-static inline DLogger_user_optionsS __dlogger_parse_user_option(const DLogger_options_writeE descriptor_to_write,
-                                                                const DLogger_levelE level_of_logging,
-                                                                const DLogger_options_markE additional_options)
-{
-    const int fd[] = 
+    if (thrd_create(&dlogger_priv_data.watcher.thread, __dlogger_config_watcher, NULL) != thrd_success)
     {
-        [DLOGGER_OPTION_WRITE_TO_FILE] = -1,
-        [DLOGGER_OPTION_WRITE_TO_STDERR] = 2,
-        [DLOGGER_OPTION_WRITE_TO_STDOUT] = 1,
-    };
+        perror("DLogger: cannot create configuration watcher thread");
+        close(dlogger_priv_data.watcher.inotify_fd);
+        close(dlogger_priv_data.watcher.stop_fd);
+        return -1;
+    }
 
-    return (DLogger_user_optionsS){
-        .is_filled = true,
-        .file_descriptor = fd[descriptor_to_write],
-        .level = level_of_logging,
-        .timestamp = additional_options & DLOGGER_OPTION_MARK_TIMESTAMP,
-        .threadid = additional_options & DLOGGER_OPTION_MARK_THREADID,
-    };
+    dlogger_priv_data.watcher.is_watching = true;
+
+    return 0;
 }
 
 
-static int __dlogger_try_create_unique_file(void)
+void __attribute__(( __format__ (__printf__, 2, 3)) ) __dlogger_print(const DLogger_callsiteS* const restrict callsite_p,
+                                                                      const char* const restrict format_p,
+                                                                      ...)
 {
-    register int fd = -1;
-    register size_t tries = 0;
-    register const size_t max_tries = 10;
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return;
+    }
 
-    do
+    if (__dlogger_is_any_enabled(callsite_p) == false)
     {
-        char filename_buffer[1 << 6] = {0};
-        register size_t filename_buffer_index = 0;
+        return;
+    }
 
-        register const bool with_date = true;
-        register const bool with_h_min_sec = true;
-        register const bool with_usec = (tries > max_tries / 2) ? true : false;
+    /* Each thread has own buffer, so message is formatted without lock. */
+    static thread_local char buffer[1 << 15] = {0};
 
-        /* first generate timestamp, then add file extension */
-        filename_buffer_index += __dlogger_write_timestamp(filename_buffer_index, sizeof(filename_buffer), &filename_buffer[0], 
-                                                           with_date, with_h_min_sec, with_usec);
-        filename_buffer_index += (size_t)snprintf(&filename_buffer[filename_buffer_index], 
-                                                  sizeof(filename_buffer) - filename_buffer_index, "%s", ".log");
+    /* Not moved to another functions because it will be triumph of form over content with passing format and variadic arguments. */
+    va_list args;
+    va_list args_copy;
+    va_start(args, format_p);
+    va_copy(args_copy, args);
 
-        /* somehow this file name exist, we need to try more times */
-        if (stat(&filename_buffer[0], &((struct stat){0})) != -1)
-        {
-            fprintf(stderr, "DLogger: file name: %s already exist. We will try more time %zu/%zu\n",
-                    &filename_buffer[0], tries, max_tries);
+    register const int ret = vsnprintf(&buffer[0], sizeof(buffer), format_p, args);
 
-            tries++;
-            sleep(1);
-            continue;
-        }
+    va_end(args);
 
-        register const mode_t mode = S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH;
+    const char* message_p = &buffer[0];
+    register size_t message_size = __dlogger_written_bytes(ret, sizeof(buffer));
+    char* long_buffer_p = NULL;
+    register const size_t long_buffer_size = ret > 0 ? (size_t)ret + 1 : 0;
 
-        fd = creat(&filename_buffer[0], mode);
+    /* Message is longer than internal buffer, so format it again into run of record arena chunks big enough for it. */
+    if (long_buffer_size > sizeof(buffer))
+    {
+        long_buffer_p = __dlogger_arena_take(long_buffer_size);
 
-        if (fd == -1)
+        if (long_buffer_p != NULL)
         {
-            perror("DLogger: cannot create file");
-            return -1;
-        }
-
-        register const int flags = O_WRONLY | O_TRUNC;
-        fd = open(&filename_buffer[0], flags);
+            register const int long_ret = vsnprintf(long_buffer_p, long_buffer_size, format_p, args_copy);
 
-        if (fd == -1)
+            message_p = long_buffer_p;
+            message_size = __dlogger_written_bytes(long_ret, long_buffer_size);
+        }
+        else
         {
-            perror("DLogger: cannot open file");
-            return -1;
+            /* Memory for record bigger than whole arena could not be mapped, only then end of message is lost. */
+            __dlogger_arena_count_truncated();
         }
+    }
 
-        dlogger_priv_data.user_options[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor = fd;
-        tries = max_tries;
-
-    } while (tries < max_tries);
-
-    return fd;
-}
-
-
-DLogger_user_optionsS* dlogger_create_user_options(void)
-{
-    DLogger_user_optionsS* user_options_p = calloc(DLOGGER_MAX_NR_OF_FD, sizeof(*user_options_p));
+    va_end(args_copy);
 
-    if (user_options_p == NULL)
+    if (callsite_p->level == DLOGGER_LEVEL_FATAL)
     {
-        perror("DLogger: calloc error");
-        return NULL;
+        __dlogger_emit_record_with_backtrace(callsite_p, message_p, message_size);
     }
-
-    for (size_t i = 0; i < DLOGGER_MAX_NR_OF_FD; ++i)
+    else
     {
-        user_options_p[i].file_descriptor = -1;
+        __dlogger_emit_record(callsite_p, message_p, message_size, NULL);
     }
 
-    return user_options_p;
+    __dlogger_arena_release(long_buffer_p, long_buffer_size);
 }
 
 
-void dlogger_destroy_user_options(DLogger_user_optionsS* user_options_p)
+void __dlogger_print_raw(const DLogger_callsiteS* const restrict callsite_p, const void* const restrict data_p, const size_t size)
 {
-    free(user_options_p);
-    user_options_p = NULL;
-}
-
+    if (dlogger_priv_data.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return;
+    }
 
-void dlogger_set_user_options(DLogger_user_optionsS* const user_options_p,
-                              const DLogger_options_writeE descriptor_to_write,
-                              const DLogger_levelE level_of_logging,
-                              const DLogger_options_markE additional_options)
-{
-    if (user_options_p == NULL)
+    if (data_p == NULL)
     {
         perror("DLogger: pass NULL pointer");
         return;
     }
 
-    if (dlogger_priv_data.is_init == true)
+    if (__dlogger_is_any_enabled(callsite_p) == false)
     {
-        perror("DLogger: options can be specify before initialization");
         return;
     }
 
-    user_options_p[descriptor_to_write] = __dlogger_parse_user_option(descriptor_to_write, level_of_logging, additional_options);
+    if (callsite_p->level == DLOGGER_LEVEL_FATAL)
+    {
+        __dlogger_emit_record_with_backtrace(callsite_p, data_p, size);
+    }
+    else
+    {
+        __dlogger_emit_record(callsite_p, data_p, size, NULL);
+    }
 }
 
 
-int dlogger_create(const DLogger_user_optionsS* const user_options_p)
+int __dlogger_is_callsite_enabled(const DLogger_callsiteS* const callsite_p)
 {
-    if (dlogger_priv_data.is_init == true)
+    /* Not initialized library is reported by __dlogger_print_raw, the same like for C macros. */
+    if (dlogger_priv_data.is_init == false)
     {
-        perror("DLogger: dlogger cannot be initialized more than once");
         return 1;
     }
 
-    register bool create_uniq_file = false;
+    return __dlogger_is_any_enabled(callsite_p) == true;
+}
 
-    if (user_options_p == NULL)
-    {
-        create_uniq_file = true;
-        dlogger_priv_data.user_options[DLOGGER_OPTION_WRITE_TO_FILE] = 
-            __dlogger_parse_user_option(DLOGGER_OPTION_WRITE_TO_FILE,
-                                        DLOGGER_LEVEL_MAX,
-                                        DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_THREADID);
-    }
-    else
-    {
-        if (user_options_p[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
-        {
-            create_uniq_file = true;
-        }
 
-        if (memcpy(&dlogger_priv_data.user_options[0], user_options_p, sizeof(dlogger_priv_data.user_options)) != &dlogger_priv_data.user_options[0])
-        {
-            perror("DLogger: memcpy error");
-            return -1;
-        }
-    }
+DLogger_trace_spanS __dlogger_trace_begin(const DLogger_callsiteS* const restrict callsite_p, const char* const restrict name_p)
+{
+    DLogger_trace_spanS span = { .callsite_p = callsite_p, .name_p = name_p, .depth = dlogger_priv_trace_thread.depth++ };
 
-    if (create_uniq_file == true)
+    if (dlogger_priv_data.is_init == false ||
+        __atomic_load_n(&callsite_p->state, __ATOMIC_RELAXED) == DLOGGER_CALLSITE_OFF)
     {
-        register const int fd = __dlogger_try_create_unique_file();
-
-        if (fd == -1)
-        {
-            perror("DLogger: cannot create or open log file");
-            return -1;
-        }
-
-        dlogger_priv_data.user_options[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor = fd;
+        return span;
     }
 
-    if (mtx_init(&dlogger_priv_data.mutex, mtx_plain) != thrd_success)
+    /* Clock is read only for spans which will be written somewhere. */
+    if (dlogger_priv_data.trace.is_filled == true || __dlogger_is_any_enabled(callsite_p) == true)
     {
-        perror("DLogger: mutex cannot be initialized");
-        memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
-        return -1;
+        span.is_recorded = true;
+        span.start_nsec = (uint64_t)__dlogger_monotonic_nsec();
     }
 
-    dlogger_priv_data.is_init = true;
-
-    return 0;
+    return span;
 }
 
 
-void dlogger_destroy(void)
+void __dlogger_trace_end(DLogger_trace_spanS* const span_p)
 {
-    if (dlogger_priv_data.is_init == false)
+    --dlogger_priv_trace_thread.depth;
+
+    if (span_p->is_recorded == false || dlogger_priv_data.is_init == false)
     {
-        perror("DLogger: first initialize DLogger");
         return;
     }
 
-    mtx_destroy(&dlogger_priv_data.mutex);
+    register const uint64_t end_nsec = (uint64_t)__dlogger_monotonic_nsec();
 
-    if (dlogger_priv_data.user_options[DLOGGER_OPTION_WRITE_TO_FILE].is_filled == true)
+    if (dlogger_priv_data.trace.is_filled == true)
     {
-        if (close(dlogger_priv_data.user_options[DLOGGER_OPTION_WRITE_TO_FILE].file_descriptor) == -1)
-        {
-            perror("DLogger: cannot close log descriptor");
-        }
+        __dlogger_trace_write_event(span_p, end_nsec);
+    }
+    else
+    {
+        __dlogger_trace_write_record(span_p, end_nsec);
     }
-
-    memset(&dlogger_priv_data, 0, sizeof(dlogger_priv_data));
 }
 
 
-void __attribute__(( __format__ (__printf__, 5, 6)) ) __dlogger_print(const char* const restrict file_p, 
-                                                                      const int line,
-                                                                      const char* const restrict func_p, 
-                                                                      const DLogger_levelE level,
-                                                                      const char* const restrict format_p,
-                                                                      ...)
+void __dlogger_trace_push(const DLogger_callsiteS* const restrict callsite_p, const char* const restrict name_p)
 {
-    if (dlogger_priv_data.is_init == false)
+    /* Too deep span is only counted, so dlogger_trace_end still matches its dlogger_trace_begin. */
+    if (dlogger_priv_trace_thread.number_of_spans >= DLOGGER_TRACE_MAX_DEPTH)
     {
-        perror("DLogger: first initialize DLogger");
-        return;
-    }
+        fprintf(stderr, "DLogger: too many opened spans, span %s is not recorded\n", name_p);
 
-    if (mtx_lock(&dlogger_priv_data.mutex) != thrd_success)
-    {
-        perror("DLogger: cannot lock mutex");
+        ++dlogger_priv_trace_thread.number_of_spans;
+        ++dlogger_priv_trace_thread.depth;
         return;
     }
 
-    for (DLogger_options_writeE i = DLOGGER_OPTION_WRITE_TO_FILE; i <= DLOGGER_OPTION_WRITE_TO_STDOUT; ++i)
-    {
-        if (dlogger_priv_data.user_options[i].is_filled == false || 
-            dlogger_priv_data.user_options[i].level < level)
-        {
-            continue;
-        }
-
-        static char buffer[1 << 15] = {0};
-        register size_t buffer_index = 0;
-
-        buffer_index += __dlogger_write_level(buffer_index, sizeof(buffer), &buffer[0], level);
-
-        if (dlogger_priv_data.user_options[i].timestamp == true)
-        {
-            register const bool with_date = false;
-            register const bool with_h_min_sec = true;
-            register const bool with_usec = true;
-
-            buffer[buffer_index++] = '[';
-            buffer_index += __dlogger_write_timestamp(buffer_index, sizeof(buffer), &buffer[0], with_date, with_h_min_sec, with_usec);
-            buffer[buffer_index++] = ']';
-            buffer[buffer_index++] = ' ';
-        }
-            
-        if (dlogger_priv_data.user_options[i].threadid == true)
-        {
-            buffer_index += __dlogger_write_thread_id(buffer_index, sizeof(buffer), &buffer[0]);      
-        }
-
-        buffer_index += __dlogger_write_file_line_func(buffer_index, sizeof(buffer), &buffer[0], file_p, line, func_p);
-
-        /* Not moved to another functions because it will be triumph of form over content with passing format and variadic arguments. */
-        va_list args;
-        va_start(args, format_p);
-
-        buffer_index += (size_t)vsnprintf(&buffer[buffer_index], sizeof(buffer) - buffer_index, format_p, args);
+    dlogger_priv_trace_thread.spans[dlogger_priv_trace_thread.number_of_spans++] = __dlogger_trace_begin(callsite_p, name_p);
+}
 
-        va_end(args);
 
-        __dlogger_add_newline(buffer_index, sizeof(buffer), &buffer[0]);
+void __dlogger_trace_pop(void)
+{
+    if (dlogger_priv_trace_thread.number_of_spans == 0)
+    {
+        fprintf(stderr, "DLogger: dlogger_trace_end without dlogger_trace_begin\n");
+        return;
+    }
 
-        if (level == DLOGGER_LEVEL_FATAL)
-        {
-            buffer_index += __dlogger_write_backtrace(buffer_index, sizeof(buffer), &buffer[0]);  
-        }
+    --dlogger_priv_trace_thread.number_of_spans;
 
-        dprintf(dlogger_priv_data.user_options[i].file_descriptor, "%s", &buffer[0]);
+    if (dlogger_priv_trace_thread.number_of_spans >= DLOGGER_TRACE_MAX_DEPTH)
+    {
+        --dlogger_priv_trace_thread.depth;
+        return;
     }
 
-    mtx_unlock(&dlogger_priv_data.mutex);
+    __dlogger_trace_end(&dlogger_priv_trace_thread.spans[dlogger_priv_trace_thread.number_of_spans]);
 }
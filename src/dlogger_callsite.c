@@ -0,0 +1,416 @@
+#include <dlogger/dlogger.h>
+#include <stdatomic.h>
+#include <fnmatch.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+
+
+/*
+ * Symbols generated by linker for section with call-sites. They are weak because application might not use
+ * any logging functionlike macro, then section does not exist and both symbols are NULL.
+ */
+extern DLogger_callsiteS __start_dlogger_callsites[] __attribute__(( weak ));
+extern DLogger_callsiteS __stop_dlogger_callsites[] __attribute__(( weak ));
+
+
+/* Call of dlogger_callsite_set kept for call-sites registered later. Newer rules are at the front of list. */
+typedef struct DLogger_callsite_ruleS
+{
+    char* file_pattern_p;
+    char* func_pattern_p;
+    DLogger_callsite_stateE state;
+    struct DLogger_callsite_ruleS* next_p;
+} DLogger_callsite_ruleS;
+
+
+/*
+ * Call-sites registered in run-time and rules for them. Lists are protected by spinlock, it is statically
+ * initialized (call-sites can be registered before dlogger_create) and held only for short changes of lists:
+ * rules are allocated and freed, and patterns are matched against nodes without it. Refresh of call-sites reads
+ * head of nodes without lock too (it is called by signal handler), nodes are never removed from list.
+ */
+static struct
+{
+    atomic_flag lock;
+    DLogger_callsite_nodeS* nodes_p;
+    DLogger_callsite_ruleS* rules_p;
+} dlogger_priv_callsites = { .lock = ATOMIC_FLAG_INIT };
+
+
+/*
+ * This function check if call-site match patterns.
+ *
+ * @param[in] callsite_p     - pointer to call-site.
+ * @param[in] file_pattern_p - pattern for file name of call-site, NULL matches all files.
+ * @param[in] func_pattern_p - pattern for function name of call-site, NULL matches all functions.
+ *
+ * @return - true if call-site match both patterns, otherwise false.
+ */
+static bool __dlogger_callsite_match(const DLogger_callsiteS* callsite_p, const char* file_pattern_p, const char* func_pattern_p);
+
+
+/*
+ * This function check if pattern of rule is the same like pattern given by user.
+ *
+ * @param[in] rule_pattern_p - pattern of rule, NULL matches all.
+ * @param[in] pattern_p      - pattern given by user, NULL matches all.
+ *
+ * @return - true if patterns are equal, otherwise false.
+ */
+static bool __dlogger_callsite_same_pattern(const char* rule_pattern_p, const char* pattern_p);
+
+
+/*
+ * This function allocate rule for call-sites registered later. Spinlock must not be taken.
+ *
+ * @param[in] file_pattern_p - pattern for file name of call-site, NULL matches all files.
+ * @param[in] func_pattern_p - pattern for function name of call-site, NULL matches all functions.
+ * @param[in] state          - state set by rule.
+ *
+ * @return - pointer to new rule, NULL on failure.
+ */
+static DLogger_callsite_ruleS* __dlogger_callsite_create_rule(const char* file_pattern_p, const char* func_pattern_p,
+                                                              DLogger_callsite_stateE state);
+
+
+/*
+ * This function save rule at the front of list. Older rule with the same patterns is unlinked, so repeated calls
+ * of dlogger_callsite_set do not grow list. Spinlock has to be taken.
+ *
+ * @param[in] rule_p - new rule.
+ *
+ * @return - pointer to unlinked rule which should be freed after spinlock is released, NULL if there is none.
+ */
+static DLogger_callsite_ruleS* __dlogger_callsite_save_rule(DLogger_callsite_ruleS* rule_p);
+
+
+/*
+ * This function free rule and its patterns. Spinlock must not be taken.
+ *
+ * @param[in] rule_p - rule to free, NULL is ignored.
+ *
+ * @return - void.
+ */
+static void __dlogger_callsite_free_rule(DLogger_callsite_ruleS* rule_p);
+
+
+/*
+ * This function recompute field enabled of call-site from its state and level of the most verbose descriptor.
+ * Concurrent refresh could overwrite newer value by older one. Every refresh checks state and level again after
+ * its store, so the last store always matches them. Only atomic operations are used.
+ *
+ * @param[in] callsite_p - pointer to call-site.
+ *
+ * @return - void.
+ */
+static void __dlogger_callsite_refresh(DLogger_callsiteS* callsite_p);
+
+
+/*
+ * These functions take and release spinlock of registered call-sites and rules.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_callsite_lock(void);
+static void __dlogger_callsite_unlock(void);
+
+
+static bool __dlogger_callsite_match(const DLogger_callsiteS* const callsite_p,
+                                     const char* const file_pattern_p,
+                                     const char* const func_pattern_p)
+{
+    if (file_pattern_p != NULL && fnmatch(file_pattern_p, callsite_p->file_p, 0) != 0)
+    {
+        return false;
+    }
+
+    if (func_pattern_p != NULL && fnmatch(func_pattern_p, callsite_p->func_p, 0) != 0)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool __dlogger_callsite_same_pattern(const char* const rule_pattern_p, const char* const pattern_p)
+{
+    if (rule_pattern_p == NULL || pattern_p == NULL)
+    {
+        return rule_pattern_p == pattern_p;
+    }
+
+    return strcmp(rule_pattern_p, pattern_p) == 0;
+}
+
+
+static DLogger_callsite_ruleS* __dlogger_callsite_create_rule(const char* const file_pattern_p,
+                                                              const char* const func_pattern_p,
+                                                              const DLogger_callsite_stateE state)
+{
+    DLogger_callsite_ruleS* const rule_p = calloc(1, sizeof(*rule_p));
+
+    if (rule_p == NULL)
+    {
+        perror("DLogger: cannot allocate rule of call-sites");
+        return NULL;
+    }
+
+    rule_p->file_pattern_p = file_pattern_p != NULL ? strdup(file_pattern_p) : NULL;
+    rule_p->func_pattern_p = func_pattern_p != NULL ? strdup(func_pattern_p) : NULL;
+    rule_p->state = state;
+
+    if ((file_pattern_p != NULL && rule_p->file_pattern_p == NULL) || (func_pattern_p != NULL && rule_p->func_pattern_p == NULL))
+    {
+        perror("DLogger: cannot allocate rule of call-sites");
+
+        __dlogger_callsite_free_rule(rule_p);
+        return NULL;
+    }
+
+    return rule_p;
+}
+
+
+static DLogger_callsite_ruleS* __dlogger_callsite_save_rule(DLogger_callsite_ruleS* const rule_p)
+{
+    DLogger_callsite_ruleS* replaced_p = NULL;
+
+    for (DLogger_callsite_ruleS** rule_pp = &dlogger_priv_callsites.rules_p; *rule_pp != NULL; rule_pp = &(*rule_pp)->next_p)
+    {
+        if (__dlogger_callsite_same_pattern((*rule_pp)->file_pattern_p, rule_p->file_pattern_p) == true &&
+            __dlogger_callsite_same_pattern((*rule_pp)->func_pattern_p, rule_p->func_pattern_p) == true)
+        {
+            replaced_p = *rule_pp;
+            *rule_pp = replaced_p->next_p;
+            break;
+        }
+    }
+
+    rule_p->next_p = dlogger_priv_callsites.rules_p;
+    dlogger_priv_callsites.rules_p = rule_p;
+
+    return replaced_p;
+}
+
+
+static void __dlogger_callsite_free_rule(DLogger_callsite_ruleS* const rule_p)
+{
+    if (rule_p == NULL)
+    {
+        return;
+    }
+
+    free(rule_p->file_pattern_p);
+    free(rule_p->func_pattern_p);
+    free(rule_p);
+}
+
+
+static void __dlogger_callsite_refresh(DLogger_callsiteS* const callsite_p)
+{
+    register int max_level = __atomic_load_n(&__dlogger_max_level, __ATOMIC_SEQ_CST);
+    register unsigned char state = __atomic_load_n(&callsite_p->state, __ATOMIC_SEQ_CST);
+    register int stored_level = 0;
+    register unsigned char stored_state = 0;
+
+    do
+    {
+        stored_level = max_level;
+        stored_state = state;
+
+        register const bool is_enabled = (stored_state == DLOGGER_PRIV_CALLSITE_ON) ||
+                                         (stored_state != DLOGGER_PRIV_CALLSITE_OFF && (int)callsite_p->level <= stored_level);
+
+        __atomic_store_n(&callsite_p->enabled, (unsigned char)is_enabled, __ATOMIC_SEQ_CST);
+
+        max_level = __atomic_load_n(&__dlogger_max_level, __ATOMIC_SEQ_CST);
+        state = __atomic_load_n(&callsite_p->state, __ATOMIC_SEQ_CST);
+    } while (max_level != stored_level || state != stored_state);
+}
+
+
+static void __dlogger_callsite_lock(void)
+{
+    while (atomic_flag_test_and_set_explicit(&dlogger_priv_callsites.lock, memory_order_acquire) == true)
+    {
+        /* Spin, lock is held only for walking of lists. */
+    }
+}
+
+
+static void __dlogger_callsite_unlock(void)
+{
+    atomic_flag_clear_explicit(&dlogger_priv_callsites.lock, memory_order_release);
+}
+
+
+void __dlogger_register_callsite(DLogger_callsite_nodeS* const node_p)
+{
+    __dlogger_callsite_lock();
+
+    /* Another thread could register call-site between check of caller and taking of lock. */
+    if (__atomic_load_n(&node_p->is_registered, __ATOMIC_RELAXED) == 0)
+    {
+        for (const DLogger_callsite_ruleS* rule_p = dlogger_priv_callsites.rules_p; rule_p != NULL; rule_p = rule_p->next_p)
+        {
+            if (__dlogger_callsite_match(&node_p->callsite, rule_p->file_pattern_p, rule_p->func_pattern_p) == true)
+            {
+                __atomic_store_n(&node_p->callsite.state, (unsigned char)rule_p->state, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+
+        /*
+         * Node is published before its field enabled is computed. Refresh of all call-sites walks list without lock,
+         * so either it finds node or this refresh reads new level of the most verbose descriptor.
+         */
+        node_p->next_p = dlogger_priv_callsites.nodes_p;
+        __atomic_store_n(&dlogger_priv_callsites.nodes_p, node_p, __ATOMIC_SEQ_CST);
+
+        __dlogger_callsite_refresh(&node_p->callsite);
+
+        __atomic_store_n(&node_p->is_registered, 1, __ATOMIC_RELEASE);
+    }
+
+    __dlogger_callsite_unlock();
+}
+
+
+void __dlogger_callsite_refresh_all(void)
+{
+    for (DLogger_callsiteS* callsite_p = __start_dlogger_callsites; callsite_p < __stop_dlogger_callsites; ++callsite_p)
+    {
+        __dlogger_callsite_refresh(callsite_p);
+    }
+
+    /* Called by signal handler too, so spinlock is not taken. Nodes are never removed from list. */
+    for (DLogger_callsite_nodeS* node_p = __atomic_load_n(&dlogger_priv_callsites.nodes_p, __ATOMIC_SEQ_CST);
+         node_p != NULL;
+         node_p = node_p->next_p)
+    {
+        __dlogger_callsite_refresh(&node_p->callsite);
+    }
+}
+
+
+void __dlogger_callsite_fork_prepare(void)
+{
+    __dlogger_callsite_lock();
+}
+
+
+void __dlogger_callsite_fork_parent(void)
+{
+    __dlogger_callsite_unlock();
+}
+
+
+void __dlogger_callsite_fork_child(void)
+{
+    __dlogger_callsite_unlock();
+}
+
+
+void __dlogger_callsite_destroy(void)
+{
+    __dlogger_callsite_lock();
+    DLogger_callsite_ruleS* rule_p = dlogger_priv_callsites.rules_p;
+    dlogger_priv_callsites.rules_p = NULL;
+    __dlogger_callsite_unlock();
+
+    while (rule_p != NULL)
+    {
+        DLogger_callsite_ruleS* const next_p = rule_p->next_p;
+        __dlogger_callsite_free_rule(rule_p);
+        rule_p = next_p;
+    }
+}
+
+
+size_t dlogger_callsite_set(const char* const file_pattern_p,
+                            const char* const func_pattern_p,
+                            const DLogger_callsite_stateE state)
+{
+    register size_t matched = 0;
+
+    for (DLogger_callsiteS* callsite_p = __start_dlogger_callsites; callsite_p < __stop_dlogger_callsites; ++callsite_p)
+    {
+        if (__dlogger_callsite_match(callsite_p, file_pattern_p, func_pattern_p) == true)
+        {
+            __atomic_store_n(&callsite_p->state, (unsigned char)state, __ATOMIC_SEQ_CST);
+            __dlogger_callsite_refresh(callsite_p);
+            ++matched;
+        }
+    }
+
+    /* Rule is saved before nodes are walked, so call-site registered in meantime gets state from rule. */
+    DLogger_callsite_ruleS* const rule_p = __dlogger_callsite_create_rule(file_pattern_p, func_pattern_p, state);
+
+    __dlogger_callsite_lock();
+    DLogger_callsite_ruleS* const replaced_p = (rule_p != NULL) ? __dlogger_callsite_save_rule(rule_p) : NULL;
+    DLogger_callsite_nodeS* const nodes_p = dlogger_priv_callsites.nodes_p;
+    __dlogger_callsite_unlock();
+
+    __dlogger_callsite_free_rule(replaced_p);
+
+    /* Nodes are never removed from list, so it is walked without lock. */
+    for (DLogger_callsite_nodeS* node_p = nodes_p; node_p != NULL; node_p = node_p->next_p)
+    {
+        if (__dlogger_callsite_match(&node_p->callsite, file_pattern_p, func_pattern_p) == true)
+        {
+            __atomic_store_n(&node_p->callsite.state, (unsigned char)state, __ATOMIC_SEQ_CST);
+            __dlogger_callsite_refresh(&node_p->callsite);
+            ++matched;
+        }
+    }
+
+    return matched;
+}
+
+
+size_t dlogger_callsite_query(const char* const file_pattern_p,
+                              const char* const func_pattern_p,
+                              void (*const callback_p)(const DLogger_callsiteS* callsite_p, void* arg_p),
+                              void* const arg_p)
+{
+    register size_t matched = 0;
+
+    for (const DLogger_callsiteS* callsite_p = __start_dlogger_callsites; callsite_p < __stop_dlogger_callsites; ++callsite_p)
+    {
+        if (__dlogger_callsite_match(callsite_p, file_pattern_p, func_pattern_p) == true)
+        {
+            if (callback_p != NULL)
+            {
+                callback_p(callsite_p, arg_p);
+            }
+
+            ++matched;
+        }
+    }
+
+    /* Callback is called without lock, it may call dlogger_callsite_set. Nodes are never removed from list. */
+    __dlogger_callsite_lock();
+    const DLogger_callsite_nodeS* const nodes_p = dlogger_priv_callsites.nodes_p;
+    __dlogger_callsite_unlock();
+
+    for (const DLogger_callsite_nodeS* node_p = nodes_p; node_p != NULL; node_p = node_p->next_p)
+    {
+        if (__dlogger_callsite_match(&node_p->callsite, file_pattern_p, func_pattern_p) == true)
+        {
+            if (callback_p != NULL)
+            {
+                callback_p(&node_p->callsite, arg_p);
+            }
+
+            ++matched;
+        }
+    }
+
+    return matched;
+}
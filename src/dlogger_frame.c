@@ -0,0 +1,234 @@
+#define _GNU_SOURCE /* memmem */
+
+#include <dlogger/dlogger_frame.h>
+#include <threads.h>
+#include <string.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+
+_Static_assert(sizeof(DLogger_frame_headerS) == DLOGGER_FRAME_HEADER_SIZE, "header of frame must not have padding");
+
+
+/* Reversed polynomial of CRC32C (Castagnoli). */
+#define DLOGGER_FRAME_CRC32C_POLY (0x82f63b78U)
+
+
+static struct
+{
+    once_flag once;                           /* implementation is chosen only once for whole process. */
+    uint32_t table[256];                      /* table for CPU without SSE4.2. */
+    uint32_t (*update_p)(uint32_t crc, const unsigned char* data_p, size_t size);
+} dlogger_priv_crc32c = { .once = ONCE_FLAG_INIT };
+
+
+/*
+ * This function choose implementation of CRC32C for current CPU.
+ *
+ * @return - void.
+ */
+static void __dlogger_frame_init_crc32c(void);
+
+
+/*
+ * This function update CRC32C by table, one byte per step.
+ *
+ * @param[in] crc    - current not inverted CRC.
+ * @param[in] data_p - data.
+ * @param[in] size   - size of data.
+ *
+ * @return - updated not inverted CRC.
+ */
+static uint32_t __dlogger_frame_crc32c_table(uint32_t crc, const unsigned char* data_p, size_t size);
+
+
+#if defined(__x86_64__)
+/*
+ * This function update CRC32C by instruction crc32 from SSE4.2, eight bytes per step.
+ *
+ * @param[in] crc    - current not inverted CRC.
+ * @param[in] data_p - data.
+ * @param[in] size   - size of data.
+ *
+ * @return - updated not inverted CRC.
+ */
+static uint32_t __dlogger_frame_crc32c_sse42(uint32_t crc, const unsigned char* data_p, size_t size);
+#endif
+
+
+/*
+ * This function check CRC of header.
+ *
+ * @param[in]  begin_p  - first byte of header, at least DLOGGER_FRAME_HEADER_SIZE bytes.
+ * @param[out] header_p - read header.
+ *
+ * @return - true if header is correct, otherwise false.
+ */
+static bool __dlogger_frame_read_header(const char* begin_p, DLogger_frame_headerS* header_p);
+
+
+static uint32_t __dlogger_frame_crc32c_table(uint32_t crc, const unsigned char* const data_p, const size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = dlogger_priv_crc32c.table[(crc ^ data_p[i]) & 0xffU] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+
+#if defined(__x86_64__)
+static __attribute__(( target("sse4.2") )) uint32_t __dlogger_frame_crc32c_sse42(const uint32_t crc,
+                                                                                 const unsigned char* const data_p,
+                                                                                 const size_t size)
+{
+    uint64_t crc64 = crc;
+    size_t i = 0;
+
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, &data_p[i], sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+
+    uint32_t crc32 = (uint32_t)crc64;
+
+    for (; i < size; ++i)
+    {
+        crc32 = _mm_crc32_u8(crc32, data_p[i]);
+    }
+
+    return crc32;
+}
+#endif
+
+
+static void __dlogger_frame_init_crc32c(void)
+{
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t crc = i;
+
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            crc = (crc & 1U) ? (crc >> 1) ^ DLOGGER_FRAME_CRC32C_POLY : crc >> 1;
+        }
+
+        dlogger_priv_crc32c.table[i] = crc;
+    }
+
+    dlogger_priv_crc32c.update_p = __dlogger_frame_crc32c_table;
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        dlogger_priv_crc32c.update_p = __dlogger_frame_crc32c_sse42;
+    }
+#endif
+}
+
+
+static bool __dlogger_frame_read_header(const char* const begin_p, DLogger_frame_headerS* const header_p)
+{
+    memcpy(header_p, begin_p, sizeof(*header_p));
+
+    return header_p->magic == DLOGGER_FRAME_MAGIC &&
+           header_p->header_crc == dlogger_frame_crc32c(0, begin_p, offsetof(DLogger_frame_headerS, header_crc)) &&
+           header_p->length <= DLOGGER_FRAME_MAX_LENGTH;
+}
+
+
+uint32_t dlogger_frame_crc32c(const uint32_t crc, const void* const data_p, const size_t size)
+{
+    call_once(&dlogger_priv_crc32c.once, __dlogger_frame_init_crc32c);
+
+    return ~dlogger_priv_crc32c.update_p(~crc, data_p, size);
+}
+
+
+void dlogger_frame_make_header(DLogger_frame_headerS* const header_p, const uint32_t length, const uint64_t sequence,
+                               const uint32_t payload_crc)
+{
+    *header_p = (DLogger_frame_headerS){
+        .magic = DLOGGER_FRAME_MAGIC,
+        .length = length,
+        .sequence = sequence,
+        .payload_crc = payload_crc,
+    };
+
+    header_p->header_crc = dlogger_frame_crc32c(0, header_p, offsetof(DLogger_frame_headerS, header_crc));
+}
+
+
+DLogger_frame_statusE dlogger_frame_read(const char* const begin_p, const char* const end_p,
+                                         DLogger_frame_headerS* const header_p, const char** const payload_pp)
+{
+    if (begin_p >= end_p)
+    {
+        return DLOGGER_FRAME_END;
+    }
+
+    register const size_t size_left = (size_t)(end_p - begin_p);
+
+    if (size_left < DLOGGER_FRAME_HEADER_SIZE)
+    {
+        return DLOGGER_FRAME_TRUNCATED;
+    }
+
+    if (__dlogger_frame_read_header(begin_p, header_p) == false)
+    {
+        return DLOGGER_FRAME_CORRUPTED;
+    }
+
+    if (size_left - DLOGGER_FRAME_HEADER_SIZE < header_p->length)
+    {
+        return DLOGGER_FRAME_TRUNCATED;
+    }
+
+    const char* const payload_p = begin_p + DLOGGER_FRAME_HEADER_SIZE;
+
+    if (dlogger_frame_crc32c(0, payload_p, header_p->length) != header_p->payload_crc)
+    {
+        return DLOGGER_FRAME_CORRUPTED;
+    }
+
+    *payload_pp = payload_p;
+
+    return DLOGGER_FRAME_VALID;
+}
+
+
+const char* dlogger_frame_resync(const char* const begin_p, const char* const end_p)
+{
+    static const uint32_t magic = DLOGGER_FRAME_MAGIC;
+    const char* search_p = begin_p;
+
+    while (search_p < end_p)
+    {
+        const char* const magic_p = memmem(search_p, (size_t)(end_p - search_p), &magic, sizeof(magic));
+
+        if (magic_p == NULL)
+        {
+            break;
+        }
+
+        DLogger_frame_headerS header;
+
+        if ((size_t)(end_p - magic_p) >= DLOGGER_FRAME_HEADER_SIZE && __dlogger_frame_read_header(magic_p, &header) == true)
+        {
+            return magic_p;
+        }
+
+        search_p = magic_p + 1;
+    }
+
+    return end_p;
+}
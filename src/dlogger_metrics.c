@@ -0,0 +1,697 @@
+#include <dlogger/dlogger.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <stdbool.h>
+#include <threads.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+
+
+/* Updates are spread over shards, each thread uses one shard, so threads rarely touch the same cache line. */
+#define DLOGGER_METRIC_SHARDS (16U)
+
+/* Log-linear histogram: each power of two is split into 2^DLOGGER_METRIC_SUB_BUCKET_BITS buckets (error <= 12.5%). */
+#define DLOGGER_METRIC_SUB_BUCKET_BITS (3U)
+#define DLOGGER_METRIC_SUB_BUCKETS     (1U << DLOGGER_METRIC_SUB_BUCKET_BITS)
+#define DLOGGER_METRIC_BUCKETS         ((64U - DLOGGER_METRIC_SUB_BUCKET_BITS + 1U) * DLOGGER_METRIC_SUB_BUCKETS)
+
+#define DLOGGER_METRIC_CACHE_LINE (64U)
+
+
+typedef enum DLogger_metric_typeE
+{
+    DLOGGER_METRIC_COUNTER,
+    DLOGGER_METRIC_GAUGE,
+    DLOGGER_METRIC_HISTOGRAM,
+} DLogger_metric_typeE;
+
+
+/* Shard of counter, aligned to cache line to avoid false sharing. */
+typedef struct DLogger_metric_counter_shardS
+{
+    alignas(DLOGGER_METRIC_CACHE_LINE) atomic_uint_fast64_t value;
+} DLogger_metric_counter_shardS;
+
+
+/* Shard of histogram. Reporter takes values by atomic exchange, so each report covers only its period. */
+typedef struct DLogger_metric_histogram_shardS
+{
+    alignas(DLOGGER_METRIC_CACHE_LINE) atomic_uint_fast64_t count;
+    atomic_uint_fast64_t sum;
+    atomic_uint_fast64_t max;
+    atomic_uint_fast64_t buckets[DLOGGER_METRIC_BUCKETS];
+} DLogger_metric_histogram_shardS;
+
+
+struct DLogger_metricS
+{
+    struct DLogger_metricS* next_p;   /* next registered metric. */
+    char* name_p;
+    DLogger_metric_typeE type;
+
+    union
+    {
+        DLogger_metric_counter_shardS* counter_shards_p;     /* DLOGGER_METRIC_COUNTER. */
+        atomic_int_fast64_t gauge;                           /* DLOGGER_METRIC_GAUGE. */
+        DLogger_metric_histogram_shardS* histogram_shards_p; /* DLOGGER_METRIC_HISTOGRAM. */
+    };
+
+    uint64_t last_reported; /* total of counter or value of gauge in previous report. */
+};
+
+
+static struct
+{
+    mtx_t mutex;                     /* protects list of metrics and state of reporter. */
+    bool is_init;                    /* is mutex initialized? */
+    DLogger_metricS* metrics_p;      /* list of registered metrics. */
+    int64_t last_report_nsec;        /* monotonic time of previous report, used to calculate rates. */
+
+    bool is_running;                 /* is reporter thread running? */
+    bool is_stopping;                /* reporter thread should exit. */
+    unsigned int period_sec;         /* period of reports. */
+    cnd_t stop;                      /* signaled when reporter thread should exit. */
+    thrd_t thread;
+
+    atomic_uint next_shard;          /* shard for next thread which updates any metric. */
+} dlogger_priv_metrics;
+
+
+/* Shard of calling thread, 0 means not assigned yet, otherwise shard + 1. */
+static thread_local unsigned int dlogger_priv_metrics_shard;
+
+
+/*
+ * This function return shard of calling thread. Shards are assigned to threads round-robin at first update.
+ *
+ * @param[in] - void.
+ *
+ * @return - index of shard.
+ */
+static inline unsigned int __dlogger_metrics_shard(void);
+
+
+/*
+ * This function return index of histogram bucket for value. Values smaller than number of sub-buckets have
+ * own buckets, bigger ones are grouped by power of two and then linearly by next bits.
+ *
+ * @param[in] value - recorded value.
+ *
+ * @return - index of bucket.
+ */
+static inline unsigned int __dlogger_metrics_bucket(uint64_t value);
+
+
+/*
+ * This function return the biggest value which falls into bucket.
+ *
+ * @param[in] bucket - index of bucket.
+ *
+ * @return - upper bound of bucket.
+ */
+static uint64_t __dlogger_metrics_bucket_upper_bound(unsigned int bucket);
+
+
+/*
+ * This function return monotonic time.
+ *
+ * @param[in] - void.
+ *
+ * @return - monotonic time in nanoseconds.
+ */
+static int64_t __dlogger_metrics_now_nsec(void);
+
+
+/*
+ * This function find registered metric or register new one. Mutex is initialized by dlogger_create.
+ *
+ * @param[in] name_p - name of metric.
+ * @param[in] type   - type of metric.
+ *
+ * @return pointer to metric if success, otherwise NULL.
+ */
+static DLogger_metricS* __dlogger_metrics_register(const char* name_p, DLogger_metric_typeE type);
+
+
+/*
+ * This function write one record with aggregated value of metric. Mutex must be taken by caller.
+ *
+ * @param[in/out] metric_p       - pointer to metric.
+ * @param[in]     elapsed_nsec   - time since previous report.
+ *
+ * @return - void.
+ */
+static void __dlogger_metrics_report_one(DLogger_metricS* metric_p, int64_t elapsed_nsec);
+
+
+/*
+ * This function write all metrics. Mutex must be taken by caller.
+ *
+ * @param[in] - void.
+ *
+ * @return - void.
+ */
+static void __dlogger_metrics_report_locked(void);
+
+
+/*
+ * This function is main function of reporter thread. Writes all metrics every period until it is stopped.
+ *
+ * @param[in] arg_p - not used.
+ *
+ * @return - 0.
+ */
+static int __dlogger_metrics_reporter(void* arg_p);
+
+
+static inline unsigned int __dlogger_metrics_shard(void)
+{
+    if (dlogger_priv_metrics_shard == 0)
+    {
+        dlogger_priv_metrics_shard = atomic_fetch_add_explicit(&dlogger_priv_metrics.next_shard, 1, memory_order_relaxed)
+                                     % DLOGGER_METRIC_SHARDS + 1;
+    }
+
+    return dlogger_priv_metrics_shard - 1;
+}
+
+
+static inline unsigned int __dlogger_metrics_bucket(const uint64_t value)
+{
+    if (value < DLOGGER_METRIC_SUB_BUCKETS)
+    {
+        return (unsigned int)value;
+    }
+
+    register const unsigned int exponent = 63U - (unsigned int)__builtin_clzll(value);
+    register const unsigned int shift = exponent - DLOGGER_METRIC_SUB_BUCKET_BITS;
+    register const unsigned int sub_bucket = (unsigned int)(value >> shift) & (DLOGGER_METRIC_SUB_BUCKETS - 1);
+
+    return (shift + 1) * DLOGGER_METRIC_SUB_BUCKETS + sub_bucket;
+}
+
+
+static uint64_t __dlogger_metrics_bucket_upper_bound(const unsigned int bucket)
+{
+    if (bucket < DLOGGER_METRIC_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    register const unsigned int shift = bucket / DLOGGER_METRIC_SUB_BUCKETS - 1;
+    register const uint64_t lower = (uint64_t)(DLOGGER_METRIC_SUB_BUCKETS + bucket % DLOGGER_METRIC_SUB_BUCKETS) << shift;
+
+    return lower + ((UINT64_C(1) << shift) - 1);
+}
+
+
+static int64_t __dlogger_metrics_now_nsec(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+
+static DLogger_metricS* __dlogger_metrics_register(const char* const name_p, const DLogger_metric_typeE type)
+{
+    if (name_p == NULL)
+    {
+        perror("DLogger: pass NULL pointer");
+        return NULL;
+    }
+
+    if (dlogger_priv_metrics.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return NULL;
+    }
+
+    mtx_lock(&dlogger_priv_metrics.mutex);
+
+    /* The same metric can be updated from many places, each of them can ask for it by name. */
+    DLogger_metricS** link_p = &dlogger_priv_metrics.metrics_p;
+
+    while (*link_p != NULL && strcmp((*link_p)->name_p, name_p) != 0)
+    {
+        link_p = &(*link_p)->next_p;
+    }
+
+    DLogger_metricS* metric_p = *link_p;
+
+    if (metric_p != NULL)
+    {
+        mtx_unlock(&dlogger_priv_metrics.mutex);
+
+        if (metric_p->type != type)
+        {
+            fprintf(stderr, "DLogger: metric %s already exists with other type\n", name_p);
+            return NULL;
+        }
+
+        return metric_p;
+    }
+
+    metric_p = calloc(1, sizeof(*metric_p));
+
+    if (metric_p == NULL)
+    {
+        perror("DLogger: calloc error");
+        goto error_metric;
+    }
+
+    metric_p->name_p = strdup(name_p);
+
+    if (metric_p->name_p == NULL)
+    {
+        perror("DLogger: strdup error");
+        goto error_name;
+    }
+
+    metric_p->type = type;
+
+    if (type == DLOGGER_METRIC_COUNTER)
+    {
+        metric_p->counter_shards_p = aligned_alloc(DLOGGER_METRIC_CACHE_LINE,
+                                                   DLOGGER_METRIC_SHARDS * sizeof(*metric_p->counter_shards_p));
+
+        if (metric_p->counter_shards_p == NULL)
+        {
+            perror("DLogger: aligned_alloc error");
+            goto error_shards;
+        }
+
+        for (size_t i = 0; i < DLOGGER_METRIC_SHARDS; ++i)
+        {
+            atomic_init(&metric_p->counter_shards_p[i].value, 0);
+        }
+    }
+    else if (type == DLOGGER_METRIC_HISTOGRAM)
+    {
+        metric_p->histogram_shards_p = aligned_alloc(DLOGGER_METRIC_CACHE_LINE,
+                                                     DLOGGER_METRIC_SHARDS * sizeof(*metric_p->histogram_shards_p));
+
+        if (metric_p->histogram_shards_p == NULL)
+        {
+            perror("DLogger: aligned_alloc error");
+            goto error_shards;
+        }
+
+        /* All fields are atomic integers without padding between them, zero bytes are valid zero values. */
+        memset(metric_p->histogram_shards_p, 0, DLOGGER_METRIC_SHARDS * sizeof(*metric_p->histogram_shards_p));
+    }
+    else
+    {
+        atomic_init(&metric_p->gauge, 0);
+    }
+
+    /* Metrics are reported in order of registration. */
+    *link_p = metric_p;
+
+    mtx_unlock(&dlogger_priv_metrics.mutex);
+
+    return metric_p;
+
+error_shards:
+    free(metric_p->name_p);
+error_name:
+    free(metric_p);
+error_metric:
+    mtx_unlock(&dlogger_priv_metrics.mutex);
+
+    return NULL;
+}
+
+
+static void __dlogger_metrics_report_one(DLogger_metricS* const metric_p, const int64_t elapsed_nsec)
+{
+    dlogger_priv_define_callsite(__dlogger_callsite, DLOGGER_PRIV_LEVEL_INFO);
+
+    register const uint64_t elapsed_msec = elapsed_nsec > 1000000 ? (uint64_t)elapsed_nsec / 1000000 : 1;
+
+    /* Metrics without change in period are not written, so report stays short. */
+    if (metric_p->type == DLOGGER_METRIC_GAUGE)
+    {
+        register const int64_t value = (int64_t)atomic_load_explicit(&metric_p->gauge, memory_order_relaxed);
+
+        if ((uint64_t)value != metric_p->last_reported)
+        {
+            __dlogger_print(&__dlogger_callsite, "metric %s: %" PRId64, metric_p->name_p, value);
+            metric_p->last_reported = (uint64_t)value;
+        }
+
+        return;
+    }
+
+    if (metric_p->type == DLOGGER_METRIC_COUNTER)
+    {
+        register uint64_t total = 0;
+
+        for (size_t i = 0; i < DLOGGER_METRIC_SHARDS; ++i)
+        {
+            total += atomic_load_explicit(&metric_p->counter_shards_p[i].value, memory_order_relaxed);
+        }
+
+        register const uint64_t delta = total - metric_p->last_reported;
+        metric_p->last_reported = total;
+
+        if (delta > 0)
+        {
+            __dlogger_print(&__dlogger_callsite, "metric %s: total %" PRIu64 ", +%" PRIu64 " (%" PRIu64 "/s)",
+                            metric_p->name_p, total, delta, delta * 1000 / elapsed_msec);
+        }
+
+        return;
+    }
+
+    /* Histogram: shards are merged and reset, each report describes only its own period. */
+    uint64_t buckets[DLOGGER_METRIC_BUCKETS] = {0};
+    register uint64_t count = 0;
+    register uint64_t sum = 0;
+    register uint64_t max = 0;
+
+    for (size_t i = 0; i < DLOGGER_METRIC_SHARDS; ++i)
+    {
+        DLogger_metric_histogram_shardS* const shard_p = &metric_p->histogram_shards_p[i];
+
+        count += atomic_exchange_explicit(&shard_p->count, 0, memory_order_relaxed);
+        sum += atomic_exchange_explicit(&shard_p->sum, 0, memory_order_relaxed);
+
+        register const uint64_t shard_max = atomic_exchange_explicit(&shard_p->max, 0, memory_order_relaxed);
+        max = shard_max > max ? shard_max : max;
+
+        for (size_t j = 0; j < DLOGGER_METRIC_BUCKETS; ++j)
+        {
+            buckets[j] += atomic_exchange_explicit(&shard_p->buckets[j], 0, memory_order_relaxed);
+        }
+    }
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    /* Count is taken before buckets, concurrent updates might be split between reports, so ranks use sum of buckets. */
+    register uint64_t bucket_count = 0;
+
+    for (size_t j = 0; j < DLOGGER_METRIC_BUCKETS; ++j)
+    {
+        bucket_count += buckets[j];
+    }
+
+    const uint64_t ranks[] = { (bucket_count + 1) / 2, bucket_count - bucket_count / 100 };
+    uint64_t quantiles[] = { 0, 0 };
+    register uint64_t cumulative = 0;
+    register size_t quantile = 0;
+
+    for (unsigned int j = 0; j < DLOGGER_METRIC_BUCKETS && quantile < sizeof(ranks) / sizeof(ranks[0]); ++j)
+    {
+        cumulative += buckets[j];
+
+        while (quantile < sizeof(ranks) / sizeof(ranks[0]) && cumulative >= ranks[quantile] && cumulative > 0)
+        {
+            register const uint64_t upper_bound = __dlogger_metrics_bucket_upper_bound(j);
+            quantiles[quantile++] = upper_bound < max ? upper_bound : max;
+        }
+    }
+
+    __dlogger_print(&__dlogger_callsite,
+                    "metric %s: count %" PRIu64 " (%" PRIu64 "/s), mean %" PRIu64 ", p50 %" PRIu64 ", p99 %" PRIu64
+                    ", max %" PRIu64,
+                    metric_p->name_p, count, count * 1000 / elapsed_msec, sum / count, quantiles[0], quantiles[1], max);
+}
+
+
+static void __dlogger_metrics_report_locked(void)
+{
+    register const int64_t now_nsec = __dlogger_metrics_now_nsec();
+    register const int64_t elapsed_nsec = now_nsec - dlogger_priv_metrics.last_report_nsec;
+
+    dlogger_priv_metrics.last_report_nsec = now_nsec;
+
+    for (DLogger_metricS* metric_p = dlogger_priv_metrics.metrics_p; metric_p != NULL; metric_p = metric_p->next_p)
+    {
+        __dlogger_metrics_report_one(metric_p, elapsed_nsec);
+    }
+}
+
+
+static int __dlogger_metrics_reporter(void* const arg_p)
+{
+    (void)arg_p;
+
+    mtx_lock(&dlogger_priv_metrics.mutex);
+
+    struct timespec deadline;
+    timespec_get(&deadline, TIME_UTC);
+
+    while (dlogger_priv_metrics.is_stopping == false)
+    {
+        deadline.tv_sec += dlogger_priv_metrics.period_sec;
+
+        /* Deadline is moved by period, so reports do not drift by time of writing. */
+        while (dlogger_priv_metrics.is_stopping == false &&
+               cnd_timedwait(&dlogger_priv_metrics.stop, &dlogger_priv_metrics.mutex, &deadline) == thrd_success)
+        {
+        }
+
+        if (dlogger_priv_metrics.is_stopping == false)
+        {
+            __dlogger_metrics_report_locked();
+            __dlogger_flush_expired_repeated();
+        }
+    }
+
+    mtx_unlock(&dlogger_priv_metrics.mutex);
+
+    return 0;
+}
+
+
+int __dlogger_metrics_start(const unsigned int period_sec)
+{
+    if (mtx_init(&dlogger_priv_metrics.mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: mutex cannot be initialized");
+        return -1;
+    }
+
+    dlogger_priv_metrics.is_init = true;
+    dlogger_priv_metrics.last_report_nsec = __dlogger_metrics_now_nsec();
+
+    if (period_sec == 0)
+    {
+        return 0;
+    }
+
+    if (cnd_init(&dlogger_priv_metrics.stop) != thrd_success)
+    {
+        perror("DLogger: condition variable cannot be initialized");
+        return -1;
+    }
+
+    dlogger_priv_metrics.period_sec = period_sec;
+    dlogger_priv_metrics.is_stopping = false;
+
+    if (thrd_create(&dlogger_priv_metrics.thread, __dlogger_metrics_reporter, NULL) != thrd_success)
+    {
+        perror("DLogger: cannot create reporter thread");
+        cnd_destroy(&dlogger_priv_metrics.stop);
+        return -1;
+    }
+
+    dlogger_priv_metrics.is_running = true;
+
+    return 0;
+}
+
+
+void __dlogger_metrics_stop(void)
+{
+    if (dlogger_priv_metrics.is_init == false)
+    {
+        return;
+    }
+
+    if (dlogger_priv_metrics.is_running == true)
+    {
+        mtx_lock(&dlogger_priv_metrics.mutex);
+        dlogger_priv_metrics.is_stopping = true;
+        cnd_signal(&dlogger_priv_metrics.stop);
+        mtx_unlock(&dlogger_priv_metrics.mutex);
+
+        thrd_join(dlogger_priv_metrics.thread, NULL);
+        cnd_destroy(&dlogger_priv_metrics.stop);
+    }
+
+    /* Values since last report are not lost. */
+    mtx_lock(&dlogger_priv_metrics.mutex);
+    __dlogger_metrics_report_locked();
+    mtx_unlock(&dlogger_priv_metrics.mutex);
+
+    DLogger_metricS* metric_p = dlogger_priv_metrics.metrics_p;
+
+    while (metric_p != NULL)
+    {
+        DLogger_metricS* const next_p = metric_p->next_p;
+
+        if (metric_p->type == DLOGGER_METRIC_COUNTER)
+        {
+            free(metric_p->counter_shards_p);
+        }
+        else if (metric_p->type == DLOGGER_METRIC_HISTOGRAM)
+        {
+            free(metric_p->histogram_shards_p);
+        }
+
+        free(metric_p->name_p);
+        free(metric_p);
+        metric_p = next_p;
+    }
+
+    mtx_destroy(&dlogger_priv_metrics.mutex);
+
+    register const unsigned int next_shard = atomic_load(&dlogger_priv_metrics.next_shard);
+    memset(&dlogger_priv_metrics, 0, sizeof(dlogger_priv_metrics));
+    atomic_init(&dlogger_priv_metrics.next_shard, next_shard);
+}
+
+
+void __dlogger_metrics_fork_prepare(void)
+{
+    if (dlogger_priv_metrics.is_init == true)
+    {
+        mtx_lock(&dlogger_priv_metrics.mutex);
+    }
+}
+
+
+void __dlogger_metrics_fork_parent(void)
+{
+    if (dlogger_priv_metrics.is_init == true)
+    {
+        mtx_unlock(&dlogger_priv_metrics.mutex);
+    }
+}
+
+
+void __dlogger_metrics_fork_child(void)
+{
+    if (dlogger_priv_metrics.is_init == false)
+    {
+        return;
+    }
+
+    /* Reporter thread is not copied by fork, mutex was locked by thread which does not exist in child. */
+    if (mtx_init(&dlogger_priv_metrics.mutex, mtx_plain) != thrd_success)
+    {
+        perror("DLogger: mutex cannot be initialized");
+    }
+
+    dlogger_priv_metrics.is_running = false;
+    dlogger_priv_metrics.is_stopping = false;
+    dlogger_priv_metrics.last_report_nsec = __dlogger_metrics_now_nsec();
+
+    /* Values updated by parent are reported by parent, child reports only own updates. */
+    for (DLogger_metricS* metric_p = dlogger_priv_metrics.metrics_p; metric_p != NULL; metric_p = metric_p->next_p)
+    {
+        if (metric_p->type == DLOGGER_METRIC_COUNTER)
+        {
+            register uint64_t total = 0;
+
+            for (size_t i = 0; i < DLOGGER_METRIC_SHARDS; ++i)
+            {
+                total += atomic_load_explicit(&metric_p->counter_shards_p[i].value, memory_order_relaxed);
+            }
+
+            metric_p->last_reported = total;
+        }
+        else if (metric_p->type == DLOGGER_METRIC_HISTOGRAM)
+        {
+            memset(metric_p->histogram_shards_p, 0, DLOGGER_METRIC_SHARDS * sizeof(*metric_p->histogram_shards_p));
+        }
+    }
+}
+
+
+DLogger_metricS* dlogger_metric_counter(const char* const name_p)
+{
+    return __dlogger_metrics_register(name_p, DLOGGER_METRIC_COUNTER);
+}
+
+
+DLogger_metricS* dlogger_metric_gauge(const char* const name_p)
+{
+    return __dlogger_metrics_register(name_p, DLOGGER_METRIC_GAUGE);
+}
+
+
+DLogger_metricS* dlogger_metric_histogram(const char* const name_p)
+{
+    return __dlogger_metrics_register(name_p, DLOGGER_METRIC_HISTOGRAM);
+}
+
+
+void dlogger_metric_add(DLogger_metricS* const metric_p, const uint64_t value)
+{
+    if (metric_p == NULL || metric_p->type != DLOGGER_METRIC_COUNTER)
+    {
+        return;
+    }
+
+    atomic_fetch_add_explicit(&metric_p->counter_shards_p[__dlogger_metrics_shard()].value, value, memory_order_relaxed);
+}
+
+
+void dlogger_metric_set(DLogger_metricS* const metric_p, const int64_t value)
+{
+    if (metric_p == NULL || metric_p->type != DLOGGER_METRIC_GAUGE)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&metric_p->gauge, value, memory_order_relaxed);
+}
+
+
+void dlogger_metric_record(DLogger_metricS* const metric_p, const uint64_t value)
+{
+    if (metric_p == NULL || metric_p->type != DLOGGER_METRIC_HISTOGRAM)
+    {
+        return;
+    }
+
+    DLogger_metric_histogram_shardS* const shard_p = &metric_p->histogram_shards_p[__dlogger_metrics_shard()];
+
+    atomic_fetch_add_explicit(&shard_p->buckets[__dlogger_metrics_bucket(value)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard_p->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&shard_p->sum, value, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&shard_p->max, memory_order_relaxed);
+
+    while (value > max && atomic_compare_exchange_weak_explicit(&shard_p->max, &max, value,
+                                                                memory_order_relaxed, memory_order_relaxed) == false)
+    {
+    }
+}
+
+
+void dlogger_metrics_report(void)
+{
+    if (dlogger_priv_metrics.is_init == false)
+    {
+        perror("DLogger: first initialize DLogger");
+        return;
+    }
+
+    mtx_lock(&dlogger_priv_metrics.mutex);
+    __dlogger_metrics_report_locked();
+    mtx_unlock(&dlogger_priv_metrics.mutex);
+}
+
@@ -1,11 +1,90 @@
 #include <dlogger/dlogger.h>
+#include <dlogger/dlogger_frame.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sched.h>
+#include <signal.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <threads.h>
+#include <unistd.h>
 
 
 static void example_default(void);
 static void example_only_stdout(void);
 static void example_file_and_stderr(void);
 static void example_all_descriptors(void);
+static void example_runtime_options(void);
+static void example_callsites(void);
+static void example_raw_buffer(void);
+static void example_suppress_repeated(void);
+static void example_async(void);
+static void example_async_writer(void);
+static void example_trace(void);
+static void example_metrics(void);
+static void example_per_thread_files(void);
+static int example_per_thread_files_worker(void* arg_p);
+static void example_framed(void);
+static void example_durability(void);
+static void example_multiprocess(void);
+static void example_multiprocess_killed_child(void);
+static void example_no_allocation(void);
+static void example_lazy_arguments(void);
+static void example_merge_and_symbolize(void);
+static const char* example_lazy_arguments_describe(void);
+
+
+/*
+ * Test mode of example_no_allocation: malloc, calloc and realloc of whole test binary (also of glibc) are
+ * interposed, calls are counted only when counting is enabled.
+ */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t number, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static struct
+{
+    atomic_bool is_counting;
+    atomic_size_t allocations;
+} test_malloc;
+
+
+void* malloc(const size_t size)
+{
+    if (atomic_load_explicit(&test_malloc.is_counting, memory_order_relaxed) == true)
+    {
+        atomic_fetch_add_explicit(&test_malloc.allocations, 1, memory_order_relaxed);
+    }
+
+    return __libc_malloc(size);
+}
+
+
+void* calloc(const size_t number, const size_t size)
+{
+    if (atomic_load_explicit(&test_malloc.is_counting, memory_order_relaxed) == true)
+    {
+        atomic_fetch_add_explicit(&test_malloc.allocations, 1, memory_order_relaxed);
+    }
+
+    return __libc_calloc(number, size);
+}
+
+
+void* realloc(void* const ptr, const size_t size)
+{
+    if (atomic_load_explicit(&test_malloc.is_counting, memory_order_relaxed) == true)
+    {
+        atomic_fetch_add_explicit(&test_malloc.allocations, 1, memory_order_relaxed);
+    }
+
+    return __libc_realloc(ptr, size);
+}
 
 
 /* 
@@ -214,12 +293,768 @@ static void example_all_descriptors(void)
 }
 
 
+/* 
+ * In this example we change level of logging without restart of application. First by API, then by 
+ * signals. Signal handlers step level for all descriptors (SIGUSR1 - more verbose, SIGUSR2 - less verbose).
+ * Arguments of disabled records are not evaluated, so counter is not incremented by them.
+ *
+ *
+ * Contents of stdout:
+ * [ERROR]    [test/dlogger_test.c:322 example_runtime_options] Message 1
+ * [WARNING]  [03:12:05.200325] [test/dlogger_test.c:327 example_runtime_options] Message 2
+ * [INFO]     [03:12:05.200332] [test/dlogger_test.c:328 example_runtime_options] Message 3
+ * [WARNING]  [03:12:05.200359] [test/dlogger_test.c:333 example_runtime_options] Message 4
+ */
+static void example_runtime_options(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_ERROR,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+    dlogger_install_signal_handlers(SIGUSR1, SIGUSR2);
+
+    register size_t counter = 0;
+
+    dlogger_log_error("Message %zu", ++counter);
+    dlogger_log_warning("Message %zu", ++counter);
+
+    dlogger_set_runtime_options(DLOGGER_OPTION_WRITE_TO_STDOUT, DLOGGER_LEVEL_INFO, DLOGGER_OPTION_MARK_TIMESTAMP);
+
+    dlogger_log_warning("Message %zu", ++counter);
+    dlogger_log_info("Message %zu", ++counter);
+
+    raise(SIGUSR2);
+
+    dlogger_log_info("Message %zu", ++counter);
+    dlogger_log_warning("Message %zu", ++counter);
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example we turn on DEBUG level only for call-sites from this function, without flooding logs
+ * from other functions. Then all call-sites from this function are turned off and arguments of macros are
+ * not evaluated.
+ *
+ *
+ * Contents of stdout:
+ * [WARNING]  [test/dlogger_test.c:363 example_callsites] Message 1
+ * [DEBUG]    [test/dlogger_test.c:368 example_callsites] Message 2
+ * [WARNING]  [test/dlogger_test.c:376 example_callsites] Message 3
+ */
+static void example_callsites(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_WARNING,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    register size_t counter = 0;
+
+    dlogger_log_warning("Message %zu", ++counter);
+    dlogger_log_debug("Not visible %zu", counter);
+
+    dlogger_callsite_set("*dlogger_test.c", "example_callsites", DLOGGER_CALLSITE_ON);
+
+    dlogger_log_debug("Message %zu", ++counter);
+
+    dlogger_callsite_set(NULL, "example_callsites", DLOGGER_CALLSITE_OFF);
+
+    dlogger_log_warning("Message %zu", ++counter);
+
+    dlogger_callsite_set(NULL, NULL, DLOGGER_CALLSITE_DEFAULT);
+
+    dlogger_log_warning("Message %zu", ++counter);
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example we write caller-owned buffer with standard prefix. Buffer is not copied into internal
+ * buffer of DLogger. Newline is added because buffer does not end with it.
+ *
+ *
+ * Contents of stdout:
+ * [INFO]     [test/dlogger_test.c:403 example_raw_buffer] 00 01 02 03 04 05 06 07
+ */
+static void example_raw_buffer(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    const char hex_dump[] = "00 01 02 03 04 05 06 07";
+
+    dlogger_log_raw(DLOGGER_LEVEL_INFO, &hex_dump[0], sizeof(hex_dump) - 1);
+    dlogger_log_raw(DLOGGER_LEVEL_DEBUG, &hex_dump[0], sizeof(hex_dump) - 1);
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example retry loop writes the same error many times. Only first message is written, then summary
+ * with number of suppressed copies is written when other message comes (or in dlogger_destroy). The same messages
+ * from different call-sites are not suppressed.
+ *
+ *
+ * Contents of stdout:
+ * [ERROR]    [test/dlogger_test.c:436 example_suppress_repeated] Cannot connect to localhost
+ * [ERROR]    [test/dlogger_test.c:436 example_suppress_repeated] last message repeated 999 times
+ * [INFO]     [test/dlogger_test.c:439 example_suppress_repeated] Connected after 1000 retries
+ * [INFO]     [test/dlogger_test.c:440 example_suppress_repeated] Connected after 1000 retries
+ * [INFO]     [test/dlogger_test.c:441 example_suppress_repeated] Connected after 1000 retries
+ */
+static void example_suppress_repeated(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_SUPPRESS_REPEATED);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    for (size_t retry = 0; retry < 1000; ++retry)
+    {
+        dlogger_log_error("Cannot connect to %s", "localhost");
+    }
+
+    dlogger_log_info("Connected after %d retries", 1000);
+    dlogger_log_info("Connected after %d retries", 1000);
+    dlogger_log_info("Connected after %d retries", 1000);
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example records are written by writer thread. Caller only formats record and copies it into queue.
+ * With DLOGGER_BACKPRESSURE_BLOCK caller waits when queue is full, so nothing is dropped.
+ *
+ *
+ * Contents of stdout:
+ * [INFO]     [test/dlogger_test.c:472 example_async] Message 0
+ * [INFO]     [test/dlogger_test.c:472 example_async] Message 1
+ * [INFO]     [test/dlogger_test.c:472 example_async] Message 2
+ * [WARNING]  [test/dlogger_test.c:475 example_async] Dropped messages 0
+ */
+static void example_async(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+    dlogger_set_async_options(user_options_p, 1 << 16, DLOGGER_BACKPRESSURE_BLOCK);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        dlogger_log_info("Message %zu", i);
+    }
+
+    dlogger_log_warning("Dropped messages %zu", dlogger_dropped_messages(DLOGGER_LEVEL_INFO));
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example writer thread is pinned to CPU 0, spins 50 usec before it sleeps and waits up to 1 msec
+ * for batch of 8 records, so burst of records is written by few writev calls.
+ *
+ *
+ * Contents of stdout:
+ * [INFO]     [test/dlogger_test.c:508 example_async_writer] Burst 0
+ * [INFO]     [test/dlogger_test.c:508 example_async_writer] Burst 1
+ * [INFO]     [test/dlogger_test.c:508 example_async_writer] Burst 2
+ * [INFO]     [test/dlogger_test.c:508 example_async_writer] Burst 3
+ */
+static void example_async_writer(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+    dlogger_set_async_options(user_options_p, 1 << 16, DLOGGER_BACKPRESSURE_BLOCK);
+    dlogger_set_writer_options(user_options_p, 50, 8, 1000);
+    dlogger_set_writer_placement(user_options_p, 0, -1, SCHED_OTHER, 0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        dlogger_log_info("Burst %zu", i);
+    }
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example spans are written as DEBUG records when scope ends. Nested span is indented by its depth.
+ * With dlogger_set_trace_options(user_options_p, "trace.json") the same spans would be written into
+ * Chrome trace file, which can be opened by chrome://tracing or ui.perfetto.dev.
+ *
+ *
+ * Contents of stdout:
+ * [DEBUG]    [test/dlogger_test.c:543 example_trace] trace   parse: 0.412 usec
+ * [DEBUG]    [test/dlogger_test.c:543 example_trace] trace   parse: 0.098 usec
+ * [DEBUG]    [test/dlogger_test.c:546 example_trace] trace   flush: 4.126 usec
+ * [DEBUG]    [test/dlogger_test.c:539 example_trace] trace request: 11.873 usec
+ */
+static void example_trace(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_DEBUG,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    {
+        dlogger_trace_scope("request");
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            dlogger_trace_scope("parse");
+        }
+
+        dlogger_trace_begin("flush");
+        fflush(stdout);
+        dlogger_trace_end();
+    }
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example each request updates metrics instead of writing own record. Aggregated values are written by
+ * dlogger_metrics_report (or every period by reporter thread, see dlogger_set_metrics_options). Histogram reports
+ * upper bound of bucket, so p50 and p99 might be slightly bigger than exact values.
+ *
+ *
+ * Contents of stdout:
+ * [INFO]     [src/dlogger_metrics.c:334 __dlogger_metrics_report_one] metric requests: total 1000, +1000 (1000000/s)
+ * [INFO]     [src/dlogger_metrics.c:334 __dlogger_metrics_report_one] metric latency_us: count 1000 (1000000/s), mean 499, p50 511, p99 999, max 999
+ * [INFO]     [src/dlogger_metrics.c:334 __dlogger_metrics_report_one] metric connections: 7
+ */
+static void example_metrics(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    DLogger_metricS* const requests_p = dlogger_metric_counter("requests");
+    DLogger_metricS* const latency_p = dlogger_metric_histogram("latency_us");
+    DLogger_metricS* const connections_p = dlogger_metric_gauge("connections");
+
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        dlogger_metric_add(requests_p, 1);
+        dlogger_metric_record(latency_p, i);
+    }
+
+    dlogger_metric_set(connections_p, 7);
+
+    dlogger_metrics_report();
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example each thread writes into own file next to uniq file, so threads do not contend for one file.
+ * Files are merged into one log ordered by timestamps with tool dlogger_merge:
+ * $./dlogger_merge 2024:01:31-12:30:00.log 2024:01:31-12:30:00.*.log
+ *
+ *
+ * Contents of file 2024:01:31-12:30:00.17841.log:
+ * [INFO]     [12:30:00.000412] [TID 17841] [test/dlogger_test.c:615 example_per_thread_files_worker] Worker 1 message 0
+ * [INFO]     [12:30:00.000437] [TID 17841] [test/dlogger_test.c:615 example_per_thread_files_worker] Worker 1 message 1
+ *
+ * Contents of file 2024:01:31-12:30:00.17842.log:
+ * [INFO]     [12:30:00.000425] [TID 17842] [test/dlogger_test.c:615 example_per_thread_files_worker] Worker 2 message 0
+ * [INFO]     [12:30:00.000449] [TID 17842] [test/dlogger_test.c:615 example_per_thread_files_worker] Worker 2 message 1
+ */
+static int example_per_thread_files_worker(void* const arg_p)
+{
+    register const size_t worker = (size_t)arg_p;
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        dlogger_log_info("Worker %zu message %zu", worker, i);
+    }
+
+    return 0;
+}
+
+
+static void example_per_thread_files(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_THREADID | DLOGGER_OPTION_MARK_PER_THREAD_FILE);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    thrd_t threads[2];
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        thrd_create(&threads[i], example_per_thread_files_worker, (void*)(i + 1));
+    }
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        thrd_join(threads[i], NULL);
+    }
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example each record of file is written as frame with length, sequence number and CRC32C, so record
+ * torn by crash is detected. The same CRC32C is available for readers in dlogger_frame.h.
+ *
+ *
+ * Contents of file printed by $./dlogger_verify -p 2024:01:31-12:30:00.log:
+ * [INFO]     [test/dlogger_test.c:675 example_framed] Frame 0
+ * [INFO]     [test/dlogger_test.c:675 example_framed] Frame 1
+ * 2024:01:31-12:30:00.log: 2 frames, last sequence 2, 0 corrupted regions (0 bytes), torn tail 0 bytes
+ *
+ * Contents of stdout:
+ * CRC32C("123456789") = e3069283
+ */
+static void example_framed(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_FRAMED);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        dlogger_log_info("Frame %zu", i);
+    }
+
+    dlogger_destroy();
+
+    printf("CRC32C(\"123456789\") = %08" PRIx32 "\n", dlogger_frame_crc32c(0, "123456789", 9));
+}
+
+
+/* 
+ * In this example background thread synchronizes log file with disk every 10 msec or after 1 MB, one fdatasync
+ * covers all records written since previous commit. CRITICAL record does not wait for disk.
+ *
+ *
+ * Contents of log file (both records are on disk when dlogger_destroy returns):
+ * [CRITICAL] [test/dlogger_test.c:705 example_durability] Disk is almost full
+ * [INFO]     [test/dlogger_test.c:706 example_durability] Request handled
+ */
+static void example_durability(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+    dlogger_set_durability_options(user_options_p, DLOGGER_DURABILITY_GROUP_COMMIT, 10, 1 << 20);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    dlogger_log_critical("Disk is almost full");
+    dlogger_log_info("Request handled");
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example two forked children log into ring shared with parent, collector thread of parent writes
+ * records of all processes into one file. Parent destroys DLogger after children exit.
+ *
+ *
+ * Contents of log file:
+ * [INFO]     [TID 17839] [test/dlogger_test.c:735 example_multiprocess] Parent forks children
+ * [INFO]     [TID 17840] [test/dlogger_test.c:745 example_multiprocess] Child 1 started
+ * [INFO]     [TID 17841] [test/dlogger_test.c:745 example_multiprocess] Child 2 started
+ * [INFO]     [TID 17839] [test/dlogger_test.c:756 example_multiprocess] All children exited
+ */
+static void example_multiprocess(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_THREADID);
+    dlogger_set_multiprocess_options(user_options_p, 1 << 16);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    dlogger_log_info("Parent forks children");
+
+    pid_t children[2];
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        children[i] = fork();
+
+        if (children[i] == 0)
+        {
+            dlogger_log_info("Child %zu started", i + 1);
+            dlogger_destroy();
+            _exit(0);
+        }
+    }
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        waitpid(children[i], NULL, 0);
+    }
+
+    dlogger_log_info("All children exited");
+
+    dlogger_destroy();
+}
+
+
+static void example_multiprocess_killed_child_on_fault(const int signal_number)
+{
+    (void)signal_number;
+
+    kill(getpid(), SIGKILL);
+}
+
+
+/* 
+ * In this example child is killed in the middle of publication: its raw buffer is copied into reserved slots
+ * of ring, but the middle page of buffer is not readable. Collector sees that producer of reserved record is dead,
+ * skips its slots and writes notice, so next records and dlogger_destroy do not wait for it.
+ *
+ *
+ * Contents of log file:
+ * [INFO]     [TID 17839] [test/dlogger_test.c:793 example_multiprocess_killed_child] Parent forks child
+ * [ERROR]    [TID 17842] [src/dlogger.c:3574 __dlogger_shared_skip_reservation] 49 slots lost, producer did not publish record
+ * [INFO]     [TID 17839] [test/dlogger_test.c:813 example_multiprocess_killed_child] Child killed by signal 9
+ */
+static void example_multiprocess_killed_child(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_THREADID);
+    dlogger_set_multiprocess_options(user_options_p, 1 << 16);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    dlogger_log_info("Parent forks child");
+
+    const size_t page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const pid_t child = fork();
+
+    if (child == 0)
+    {
+        char* const buffer_p = mmap(NULL, 3 * page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        memset(buffer_p, 'x', 3 * page_size);
+        mprotect(buffer_p + page_size, page_size, PROT_NONE);
+
+        signal(SIGSEGV, example_multiprocess_killed_child_on_fault);
+
+        dlogger_log_raw(DLOGGER_LEVEL_INFO, buffer_p, 3 * page_size);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    dlogger_log_info("Child killed by signal %d", WTERMSIG(status));
+
+    dlogger_destroy();
+}
+
+
+/* 
+ * In this example malloc is counted between dlogger_create and dlogger_destroy. Messages longer than per-thread
+ * buffer are formatted into chunks of record arena (here 2 chunks of 64 KiB), message of 64 KiB takes both chunks.
+ * Message longer than whole arena is formatted into temporary mapping. No message is cut. Backtrace of FATAL record
+ * is formatted into buffer on stack, so no record allocates memory. Then raw backtraces and file of thread are
+ * enabled in run-time: list of modules is formatted into chunk of arena and file of thread gets preallocated slot.
+ *
+ *
+ * Contents of log file (long messages are shortened here):
+ * [INFO]     [16:35:49.735209] [TID 17839] [test/dlogger_test.c:871 example_no_allocation] Message 1
+ * [INFO]     [16:35:49.735228] [TID 17839] [test/dlogger_test.c:872 example_no_allocation] Long message      ...      end
+ * [INFO]     [16:35:49.735241] [TID 17839] [test/dlogger_test.c:873 example_no_allocation] Message of two chunks      ...      end
+ * [INFO]     [16:35:49.735254] [TID 17839] [test/dlogger_test.c:874 example_no_allocation] Message longer than arena      ...      end
+ * [FATAL]    [16:35:49.735310] [TID 17839] [test/dlogger_test.c:875 example_no_allocation] Message 5
+ * Backtrace:
+ * ./test_dlogger.out(+0x7da5) [0x55d5b5e4fda5]
+ * ./test_dlogger.out(+0x82c2) [0x55d5b5e502c2]
+ * /lib/x86_64-linux-gnu/libc.so.6(+0x2724a) [0x7f1b4e84624a]
+ * /lib/x86_64-linux-gnu/libc.so.6(__libc_start_main+0x85) [0x7f1b4e846305]
+ * ./test_dlogger.out(+0x2441) [0x55d5b5e4a441]
+ *
+ * Contents of file of thread 2024:01:31-16:35:49.17839.log:
+ * Modules:
+ * 0x55d5b5e48000 0x55d5b5e48000-0x55d5b5e63670 c9a28c87f4767b8b10fc4358839b3ba84f15aa0a ./test_dlogger.out
+ * 0x7f1b4e81f000 0x7f1b4e81f000-0x7f1b4ea00f50 6196744a316dbd57c0fd8968df1680aac482cec4 /lib/x86_64-linux-gnu/libc.so.6
+ * [INFO]     [16:35:49.735322] [TID 17839] [test/dlogger_test.c:882 example_no_allocation] Message 6
+ * [FATAL]    [16:35:49.735327] [TID 17839] [test/dlogger_test.c:883 example_no_allocation] Message 7
+ * Raw backtrace:
+ * 0x55d5b5e4fda5
+ * 0x55d5b5e502c2
+ * 0x7f1b4e84624a
+ * 0x7f1b4e846305
+ * 0x55d5b5e4a441
+ *
+ *
+ * Contents of stdout:
+ * Allocations after dlogger_create: 0, truncated records: 0
+ */
+static void example_no_allocation(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_THREADID);
+    dlogger_set_arena_options(user_options_p, 2, 1 << 16);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    atomic_store(&test_malloc.is_counting, true);
+
+    dlogger_log_info("Message %d", 1);
+    dlogger_log_info("Long message%*s", 1 << 15, "end");
+    dlogger_log_info("Message of two chunks%*s", 1 << 16, "end");
+    dlogger_log_info("Message longer than arena%*s", 1 << 17, "end");
+    dlogger_log_fatal("Message %d", 5);
+
+    dlogger_set_runtime_options(DLOGGER_OPTION_WRITE_TO_FILE,
+                                DLOGGER_LEVEL_INFO,
+                                DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_THREADID |
+                                DLOGGER_OPTION_MARK_RAW_BACKTRACE | DLOGGER_OPTION_MARK_PER_THREAD_FILE);
+
+    dlogger_log_info("Message %d", 6);
+    dlogger_log_fatal("Message %d", 7);
+
+    atomic_store(&test_malloc.is_counting, false);
+
+    const size_t allocations = atomic_load(&test_malloc.allocations);
+    const size_t truncated = dlogger_truncated_messages();
+
+    dlogger_destroy();
+
+    printf("Allocations after dlogger_create: %zu, truncated records: %zu\n", allocations, truncated);
+
+    assert(allocations == 0);
+    assert(truncated == 0);
+}
+
+
+/* Number of calls of example_lazy_arguments_describe, i.e. how many times arguments of record have been evaluated. */
+static size_t example_lazy_arguments_evaluations;
+
+
+static const char* example_lazy_arguments_describe(void)
+{
+    ++example_lazy_arguments_evaluations;
+
+    return "GET /index.html";
+}
+
+
+/* 
+ * In this example DEBUG record is disabled by level, so its arguments are not evaluated at all: macro checks
+ * level of the most verbose descriptor and state of call-site before arguments. After level is changed
+ * in run-time, the same record is written and its arguments are evaluated.
+ *
+ *
+ * Contents of stdout:
+ * [DEBUG]    [test/dlogger_test.c:934 example_lazy_arguments] Request GET /index.html
+ * Arguments evaluated: 1 of 2
+ */
+static void example_lazy_arguments(void)
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        dlogger_log_debug("Request %s", example_lazy_arguments_describe());
+
+        dlogger_set_runtime_options(DLOGGER_OPTION_WRITE_TO_STDOUT, DLOGGER_LEVEL_DEBUG, 0);
+    }
+
+    dlogger_destroy();
+
+    printf("Arguments evaluated: %zu of 2\n", example_lazy_arguments_evaluations);
+}
+
+
+/* 
+ * In this example log with raw backtrace is written into temporary directory, merged by dlogger_merge and resolved
+ * by dlogger_symbolize (tools are built next to this binary by make all). List of modules is written before
+ * the first record of file, merge keeps it before this record, so symbolize resolves every address.
+ *
+ *
+ * Contents of stdout:
+ * Merged backtrace: 7 addresses, 0 not resolved
+ */
+static void example_merge_and_symbolize(void)
+{
+    char tools_directory[1 << 12];
+    const ssize_t path_size = readlink("/proc/self/exe", &tools_directory[0], sizeof(tools_directory) - 1);
+
+    if (path_size <= 0)
+    {
+        return;
+    }
+
+    tools_directory[path_size] = '\0';
+    *strrchr(&tools_directory[0], '/') = '\0';
+
+    char merge_path[sizeof(tools_directory) + 16];
+    snprintf(&merge_path[0], sizeof(merge_path), "%s/dlogger_merge", &tools_directory[0]);
+
+    if (access(&merge_path[0], X_OK) != 0)
+    {
+        printf("Merged backtrace: tools are not built\n");
+        return;
+    }
+
+    char log_directory[] = "/tmp/dlogger_merge_XXXXXX";
+    char current_directory[1 << 12];
+
+    if (mkdtemp(&log_directory[0]) == NULL || getcwd(&current_directory[0], sizeof(current_directory)) == NULL ||
+        chdir(&log_directory[0]) != 0)
+    {
+        perror("example_merge_and_symbolize");
+        return;
+    }
+
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_FILE,
+                             DLOGGER_LEVEL_INFO,
+                             DLOGGER_OPTION_MARK_TIMESTAMP | DLOGGER_OPTION_MARK_RAW_BACKTRACE);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    dlogger_log_fatal("Message %d", 1);
+
+    dlogger_destroy();
+
+    if (chdir(&current_directory[0]) != 0)
+    {
+        perror("example_merge_and_symbolize");
+    }
+
+    char command[3 * sizeof(tools_directory)];
+    snprintf(&command[0], sizeof(command), "cd %s && %s/dlogger_merge *.log | %s/dlogger_symbolize; rm -f *.log",
+             &log_directory[0], &tools_directory[0], &tools_directory[0]);
+
+    FILE* const pipe_p = popen(&command[0], "r");
+    size_t addresses = 0;
+    size_t not_resolved = 0;
+    char line[1 << 12];
+
+    while (pipe_p != NULL && fgets(&line[0], sizeof(line), pipe_p) != NULL)
+    {
+        if (strstr(&line[0], " [0x") != NULL)
+        {
+            ++addresses;
+            not_resolved += strncmp(&line[0], "?? ", 3) == 0;
+        }
+    }
+
+    if (pipe_p != NULL)
+    {
+        pclose(pipe_p);
+    }
+
+    rmdir(&log_directory[0]);
+
+    printf("Merged backtrace: %zu addresses, %zu not resolved\n", addresses, not_resolved);
+
+    assert(addresses > 0);
+    assert(not_resolved == 0);
+}
+
+
 int main(void)
 {
     example_default();
     example_only_stdout();
     example_file_and_stderr();
     example_all_descriptors();
+    example_runtime_options();
+    example_callsites();
+    example_raw_buffer();
+    example_suppress_repeated();
+    example_async();
+    example_async_writer();
+    example_trace();
+    example_metrics();
+    example_per_thread_files();
+    example_framed();
+    example_durability();
+    example_multiprocess();
+    example_multiprocess_killed_child();
+    example_no_allocation();
+    example_lazy_arguments();
+    example_merge_and_symbolize();
 
     return 0;
 }
@@ -0,0 +1,71 @@
+#include <dlogger/dlogger.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+static void example_cpp_frontend();
+
+
+/* Member function defined in class is inline, its call-site is registered at the first execution. */
+class Connection
+{
+public:
+    explicit Connection(std::string_view peer) : peer_(peer) {}
+
+    void send(const std::size_t bytes) const
+    {
+        dlogger_log_debug("Sent %zu bytes to %s", bytes, peer_);
+    }
+
+private:
+    std::string peer_;
+};
+
+
+/*
+ * In this example C++ front-end is used. Format is checked at compile time, so dlogger_log_info("%d", "text")
+ * does not compile. std::string, std::string_view and integers of any size are written without conversions.
+ * Output is the same like from C macros. Rule of dlogger_callsite_set is kept, so it turns on call-site
+ * of member function, even though the function was not called yet.
+ *
+ *
+ * Contents of stdout:
+ * [INFO]     [test/dlogger_test_cpp.cpp:54 example_cpp_frontend] User alice logged in from 10.0.0.1 after 3 attempts
+ * [WARNING]  [test/dlogger_test_cpp.cpp:55 example_cpp_frontend] Offset -9223372036854775808, mask 0X00FF,  42.50%
+ * [DEBUG]    [test/dlogger_test_cpp.cpp:18 send] Sent 512 bytes to alice
+ */
+static void example_cpp_frontend()
+{
+    DLogger_user_optionsS* user_options_p = dlogger_create_user_options();
+    dlogger_set_user_options(user_options_p,
+                             DLOGGER_OPTION_WRITE_TO_STDOUT,
+                             DLOGGER_LEVEL_INFO,
+                             0);
+
+    dlogger_create(user_options_p);
+    dlogger_destroy_user_options(user_options_p);
+
+    const std::string user = "alice";
+    const std::string_view address = "10.0.0.1";
+    const std::int64_t offset = INT64_MIN;
+    const unsigned int attempts = 3;
+
+    dlogger_log_info("User %s logged in from %s after %u attempts", user, address, attempts);
+    dlogger_log_warning("Offset %d, mask %#06X, %6.2f%%", offset, 0xffU, 42.5);
+
+    dlogger_callsite_set("*dlogger_test_cpp.cpp", "send", DLOGGER_CALLSITE_ON);
+
+    const Connection connection(user);
+    connection.send(512);
+
+    dlogger_destroy();
+}
+
+
+int main()
+{
+    example_cpp_frontend();
+
+    return 0;
+}
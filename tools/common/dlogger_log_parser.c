@@ -0,0 +1,357 @@
+#define _GNU_SOURCE /* memrchr */
+
+#include "dlogger_log_parser.h"
+#include <dlogger/dlogger.h>
+#include <strings.h>
+#include <string.h>
+#include <ctype.h>
+
+
+/*
+ * This function return pointer to first character of next line. memchr is vectorized by libc, so it is
+ * the fastest way to skip long lines.
+ *
+ * @param[in] line_p - pointer to any character of line.
+ * @param[in] end_p  - end of log.
+ *
+ * @return - pointer to next line or @end_p.
+ */
+static inline const char* __dlogger_log_next_line(const char* line_p, const char* end_p);
+
+
+/*
+ * This function parse unsigned decimal number.
+ *
+ * @param[in/out] p_p   - pointer to current position, moved after number.
+ * @param[in]     end_p - end of log.
+ * @param[out]    value - parsed number.
+ *
+ * @return - true if at least one digit has been parsed, otherwise false.
+ */
+static bool __dlogger_log_parse_number(const char** p_p, const char* end_p, int64_t* value);
+
+
+/*
+ * This function find first line which starts record at @begin_p or later.
+ *
+ * @param[in]  log_begin_p    - first character of log.
+ * @param[in]  begin_p        - position where search starts.
+ * @param[in]  end_p          - end of search.
+ * @param[in]  with_timestamp - skip records without timestamp?
+ * @param[out] record_p       - parsed first line of record.
+ *
+ * @return - true if record has been found, otherwise false.
+ */
+static bool __dlogger_log_find_header(const char* log_begin_p, const char* begin_p, const char* end_p,
+                                      bool with_timestamp, DLogger_log_recordS* record_p);
+
+
+/*
+ * This function find the last line which starts record with timestamp. Lines are searched from the end of log.
+ *
+ * @param[in]  begin_p  - first character of log.
+ * @param[in]  end_p    - end of log.
+ * @param[out] record_p - parsed first line of record.
+ *
+ * @return - true if record has been found, otherwise false.
+ */
+static bool __dlogger_log_find_last_header(const char* begin_p, const char* end_p, DLogger_log_recordS* record_p);
+
+
+static inline const char* __dlogger_log_next_line(const char* const line_p, const char* const end_p)
+{
+    const char* const newline_p = memchr(line_p, '\n', (size_t)(end_p - line_p));
+
+    return (newline_p == NULL) ? end_p : newline_p + 1;
+}
+
+
+static bool __dlogger_log_parse_number(const char** const p_p, const char* const end_p, int64_t* const value)
+{
+    const char* p = *p_p;
+    int64_t number = 0;
+
+    while (p < end_p && isdigit((unsigned char)*p))
+    {
+        number = number * 10 + (*p - '0');
+        ++p;
+    }
+
+    if (p == *p_p)
+    {
+        return false;
+    }
+
+    *p_p = p;
+    *value = number;
+
+    return true;
+}
+
+
+bool dlogger_log_parse_header(const char* const line_p, const char* const end_p, DLogger_log_recordS* const record_p)
+{
+    const char* p = line_p;
+
+    if (p >= end_p || *p != '[')
+    {
+        return false;
+    }
+
+    ++p;
+    record_p->level = -1;
+
+    for (size_t i = 0; i < sizeof(dlogger_priv_level_strings) / sizeof(dlogger_priv_level_strings[0]); ++i)
+    {
+        const size_t length = strlen(dlogger_priv_level_strings[i]);
+
+        if ((size_t)(end_p - p) > length && memcmp(p, dlogger_priv_level_strings[i], length) == 0 && p[length] == ']')
+        {
+            record_p->level = (int)i;
+            p += length + 1;
+            break;
+        }
+    }
+
+    if (record_p->level == -1)
+    {
+        return false;
+    }
+
+    record_p->begin_p = line_p;
+    record_p->timestamp_usec = -1;
+    record_p->thread_id = -1;
+    record_p->location_p = NULL;
+    record_p->location_size = 0;
+
+    while (p < end_p && *p == ' ')
+    {
+        ++p;
+    }
+
+    /* Timestamp: [HH:MM:SS.usec], microseconds are saved without leading zeros. */
+    if (end_p - p > 2 && p[0] == '[' && isdigit((unsigned char)p[1]))
+    {
+        const char* q = p + 1;
+        int64_t hours = 0;
+        int64_t minutes = 0;
+        int64_t seconds = 0;
+        int64_t usec = 0;
+
+        if (__dlogger_log_parse_number(&q, end_p, &hours) && q < end_p && *q++ == ':' &&
+            __dlogger_log_parse_number(&q, end_p, &minutes) && q < end_p && *q++ == ':' &&
+            __dlogger_log_parse_number(&q, end_p, &seconds) && q < end_p && *q++ == '.' &&
+            __dlogger_log_parse_number(&q, end_p, &usec) && q < end_p && *q++ == ']')
+        {
+            record_p->timestamp_usec = ((hours * 60 + minutes) * 60 + seconds) * 1000000 + usec;
+            p = q;
+
+            while (p < end_p && *p == ' ')
+            {
+                ++p;
+            }
+        }
+    }
+
+    /* Thread id: [TID id]. */
+    if (end_p - p > 5 && memcmp(p, "[TID ", 5) == 0)
+    {
+        const char* q = p + 5;
+        int64_t thread_id = 0;
+
+        if (__dlogger_log_parse_number(&q, end_p, &thread_id) && q < end_p && *q++ == ']')
+        {
+            record_p->thread_id = (long)thread_id;
+            p = q;
+
+            while (p < end_p && *p == ' ')
+            {
+                ++p;
+            }
+        }
+    }
+
+    /* Location: [file:line function]. */
+    if (p < end_p && *p == '[')
+    {
+        const char* q = p + 1;
+
+        while (q < end_p && *q != ' ' && *q != '\n')
+        {
+            ++q;
+        }
+
+        record_p->location_p = p + 1;
+        record_p->location_size = (size_t)(q - (p + 1));
+    }
+
+    return true;
+}
+
+
+static bool __dlogger_log_find_header(const char* const log_begin_p, const char* const begin_p, const char* const end_p,
+                                      const bool with_timestamp, DLogger_log_recordS* const record_p)
+{
+    const char* line_p = begin_p;
+
+    if (line_p > log_begin_p && line_p[-1] != '\n')
+    {
+        line_p = __dlogger_log_next_line(line_p, end_p);
+    }
+
+    while (line_p < end_p)
+    {
+        if (dlogger_log_parse_header(line_p, end_p, record_p) == true &&
+            (with_timestamp == false || record_p->timestamp_usec != -1))
+        {
+            return true;
+        }
+
+        line_p = __dlogger_log_next_line(line_p, end_p);
+    }
+
+    return false;
+}
+
+
+static bool __dlogger_log_find_last_header(const char* const begin_p, const char* const end_p, DLogger_log_recordS* const record_p)
+{
+    const char* line_end_p = end_p;
+
+    while (line_end_p > begin_p)
+    {
+        /* New line which ends line before @line_end_p, the last character of line itself is skipped. */
+        const char* const newline_p = memrchr(begin_p, '\n', (size_t)(line_end_p - 1 - begin_p));
+        const char* const line_p = (newline_p == NULL) ? begin_p : newline_p + 1;
+
+        if (dlogger_log_parse_header(line_p, end_p, record_p) == true && record_p->timestamp_usec != -1)
+        {
+            return true;
+        }
+
+        line_end_p = line_p;
+    }
+
+    return false;
+}
+
+
+bool dlogger_log_next_record(const char* const log_begin_p, const char* const begin_p, const char* const end_p,
+                             DLogger_log_recordS* const record_p)
+{
+    if (__dlogger_log_find_header(log_begin_p, begin_p, end_p, false, record_p) == false)
+    {
+        return false;
+    }
+
+    /* Record ends where next record starts. */
+    const char* line_p = __dlogger_log_next_line(record_p->begin_p, end_p);
+    DLogger_log_recordS next_record;
+
+    while (line_p < end_p && dlogger_log_parse_header(line_p, end_p, &next_record) == false)
+    {
+        line_p = __dlogger_log_next_line(line_p, end_p);
+    }
+
+    record_p->end_p = line_p;
+
+    return true;
+}
+
+
+const char* dlogger_log_lower_bound(const char* const begin_p, const char* const end_p, const int64_t timestamp_usec)
+{
+    const char* low_p = begin_p;
+    const char* high_p = end_p;
+    DLogger_log_recordS record;
+
+    /* Invariant: all timestamped records which start before @low_p are older than @timestamp_usec. */
+    while (low_p < high_p)
+    {
+        const char* const middle_p = low_p + (high_p - low_p) / 2;
+
+        if (__dlogger_log_find_header(begin_p, middle_p, high_p, true, &record) == true &&
+            record.timestamp_usec < timestamp_usec)
+        {
+            low_p = record.begin_p + 1;
+        }
+        else
+        {
+            high_p = middle_p;
+        }
+    }
+
+    if (__dlogger_log_find_header(begin_p, low_p, end_p, true, &record) == false)
+    {
+        return end_p;
+    }
+
+    return record.begin_p;
+}
+
+
+bool dlogger_log_is_one_day(const char* const begin_p, const char* const end_p, const int64_t slack_usec)
+{
+    DLogger_log_recordS first_record;
+    DLogger_log_recordS last_record;
+
+    if (__dlogger_log_find_header(begin_p, begin_p, end_p, true, &first_record) == false ||
+        __dlogger_log_find_last_header(begin_p, end_p, &last_record) == false)
+    {
+        return true;
+    }
+
+    return last_record.timestamp_usec + slack_usec >= first_record.timestamp_usec;
+}
+
+
+bool dlogger_log_parse_time(const char* const time_p, int64_t* const timestamp_usec)
+{
+    const char* p = time_p;
+    const char* const end_p = time_p + strlen(time_p);
+    int64_t hours = 0;
+    int64_t minutes = 0;
+    int64_t seconds = 0;
+    int64_t usec = 0;
+
+    if (!__dlogger_log_parse_number(&p, end_p, &hours) || p >= end_p || *p++ != ':' ||
+        !__dlogger_log_parse_number(&p, end_p, &minutes) || p >= end_p || *p++ != ':' ||
+        !__dlogger_log_parse_number(&p, end_p, &seconds))
+    {
+        return false;
+    }
+
+    /* Fraction passed by user is decimal fraction of second (.5 means 500000 usec). */
+    if (p < end_p && *p == '.')
+    {
+        ++p;
+
+        for (int64_t scale = 100000; p < end_p && isdigit((unsigned char)*p); ++p, scale /= 10)
+        {
+            usec += (*p - '0') * scale;
+        }
+    }
+
+    if (p != end_p || hours > 23 || minutes > 59 || seconds > 59)
+    {
+        return false;
+    }
+
+    *timestamp_usec = ((hours * 60 + minutes) * 60 + seconds) * 1000000 + usec;
+
+    return true;
+}
+
+
+int dlogger_log_parse_level(const char* const level_p)
+{
+    for (size_t i = 0; i < sizeof(dlogger_priv_level_strings) / sizeof(dlogger_priv_level_strings[0]); ++i)
+    {
+        if (strcasecmp(level_p, dlogger_priv_level_strings[i]) == 0)
+        {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,113 @@
+#ifndef DLOGGER_LOG_PARSER_H
+#define DLOGGER_LOG_PARSER_H
+
+
+/*
+    This is the header for parser of logs written by DLogger. Used by DLogger tools.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Record starts with line: [LEVEL] [HH:MM:SS.usec] [TID id] [file:line function] message
+    Timestamp and thread id are optional. All next lines which do not start with level (e.g. backtrace)
+    belong to the same record.
+*/
+
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* One record from log. Pointers point into parsed memory. */
+typedef struct DLogger_log_recordS
+{
+    const char* begin_p;        /* first character of record. */
+    const char* end_p;          /* first character after record (start of next record or end of log). */
+
+    int level;                  /* DLogger_levelE. */
+    int64_t timestamp_usec;     /* microseconds since midnight, -1 if record has not timestamp. */
+    long thread_id;             /* thread id, -1 if record has not thread id. */
+
+    const char* location_p;     /* "file:line", NULL if not found. */
+    size_t location_size;
+} DLogger_log_recordS;
+
+
+/*
+ * This function parse first line of record.
+ *
+ * @param[in]  line_p   - pointer to first character of line.
+ * @param[in]  end_p    - end of log.
+ * @param[out] record_p - parsed record, field end_p is not set.
+ *
+ * @return - true if line is first line of record, otherwise false.
+ */
+bool dlogger_log_parse_header(const char* line_p, const char* end_p, DLogger_log_recordS* record_p);
+
+
+/*
+ * This function find first record which starts at @begin_p or later. If @begin_p is in the middle of line,
+ * search starts from next line.
+ *
+ * @param[in]  log_begin_p - first character of log.
+ * @param[in]  begin_p     - position where search starts.
+ * @param[in]  end_p       - end of log.
+ * @param[out] record_p    - found record with all fields.
+ *
+ * @return - true if record has been found, otherwise false.
+ */
+bool dlogger_log_next_record(const char* log_begin_p, const char* begin_p, const char* end_p, DLogger_log_recordS* record_p);
+
+
+/*
+ * This function find first record with timestamp >= @timestamp_usec by binary search. Log must be sorted by time
+ * (records of different threads might be slightly out of order, caller should use some slack), so it must not
+ * cross midnight (see dlogger_log_is_one_day).
+ *
+ * @param[in] begin_p        - first character of log.
+ * @param[in] end_p          - end of log.
+ * @param[in] timestamp_usec - microseconds since midnight.
+ *
+ * @return - pointer to first character of found record, @end_p if there is not such record.
+ */
+const char* dlogger_log_lower_bound(const char* begin_p, const char* end_p, int64_t timestamp_usec);
+
+
+/*
+ * This function check if log does not cross midnight: its last timestamp is not older than the first one.
+ * Timestamps go back after midnight, then log is not sorted by time and binary search cannot be used.
+ *
+ * @param[in] begin_p    - first character of log.
+ * @param[in] end_p      - end of log.
+ * @param[in] slack_usec - records of different threads might be out of order by this time.
+ *
+ * @return - true if log is sorted by time (also without timestamps), false if it crosses midnight.
+ */
+bool dlogger_log_is_one_day(const char* begin_p, const char* end_p, int64_t slack_usec);
+
+
+/*
+ * This function parse time passed by user: HH:MM:SS[.fraction].
+ *
+ * @param[in]  time_p         - null-terminated string.
+ * @param[out] timestamp_usec - microseconds since midnight.
+ *
+ * @return - true on success, otherwise false.
+ */
+bool dlogger_log_parse_time(const char* time_p, int64_t* timestamp_usec);
+
+
+/*
+ * This function parse level name passed by user (case insensitive).
+ *
+ * @param[in] level_p - null-terminated string.
+ *
+ * @return - DLogger_levelE on success, -1 on failure.
+ */
+int dlogger_log_parse_level(const char* level_p);
+
+#endif /* DLOGGER_LOG_PARSER_H */
@@ -0,0 +1,425 @@
+/*
+    This tool merges DLogger log files (e.g. files of threads written with DLOGGER_OPTION_MARK_PER_THREAD_FILE)
+    into one stream ordered by timestamps.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Usage:
+    $dlogger_merge log_file...
+
+    $dlogger_merge 2024:01:31-12:30:00.log 2024:01:31-12:30:00.*.log > merged.log
+
+    Logs must be written with DLOGGER_OPTION_MARK_TIMESTAMP. Each file must be sorted by time, which is true for
+    file of one thread. Files are merged by k-way merge: only current record of each file is compared, so memory
+    does not depend on size of files. Files are mapped by mmap and already merged part is released from memory.
+    Records with the same timestamp keep order of files from command line. Record without timestamp gets timestamp
+    of previous record of the same file. Lines before the first record (list of modules written for
+    DLOGGER_OPTION_MARK_RAW_BACKTRACE) get the first timestamp of file and are written right before its first
+    record, so dlogger_symbolize can resolve merged backtraces. Time going back by more than 12 hours is treated
+    as midnight. All files share one day: file whose first timestamp is more than 12 hours before the latest first
+    timestamp of all files was started after midnight (e.g. file of thread created after midnight).
+*/
+
+
+#include "common/dlogger_log_parser.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+
+
+#define DLOGGER_MERGE_USEC_PER_DAY      ((int64_t)24 * 60 * 60 * 1000000)
+
+/* Already merged part of file is released from memory in chunks of this size. */
+#define DLOGGER_MERGE_RELEASE_SIZE      ((size_t)1 << 24)
+
+
+/* Mapped log file with its current record. */
+typedef struct DLogger_merge_fileS
+{
+    const char* log_p;          /* first character of mapped file. */
+    const char* end_p;          /* end of mapped file. */
+    const char* released_p;     /* part of file before this pointer is released from memory. */
+    size_t file_size;
+    size_t leading_size;        /* lines before the first record (list of modules), 0 when they are written. */
+
+    DLogger_log_recordS record; /* current record, the oldest not written record of file. */
+    int64_t key_usec;           /* timestamp of current record with days passed since the first day of all files. */
+    int64_t day_offset_usec;    /* days passed since the first day of all files. */
+    int64_t first_timestamp_usec; /* the first timestamp in file, -1 if file has no timestamp. */
+    int64_t last_timestamp_usec;
+    size_t index;               /* position on command line, breaks ties. */
+} DLogger_merge_fileS;
+
+
+/*
+ * This function map log file and read its first record.
+ *
+ * @param[in]  path_p - path to log file.
+ * @param[in]  index  - position of file on command line.
+ * @param[out] file_p - mapped file.
+ *
+ * @return - 1 if file has at least one record, 0 if it is empty, -1 on failure.
+ */
+static int __dlogger_merge_open(const char* path_p, size_t index, DLogger_merge_fileS* file_p);
+
+
+/*
+ * This function move file to next record and release merged part of file from memory.
+ *
+ * @param[in/out] file_p - mapped file.
+ *
+ * @return - true if file has next record, otherwise false.
+ */
+static bool __dlogger_merge_next(DLogger_merge_fileS* file_p);
+
+
+/*
+ * This function find the first timestamp of file. Records without timestamp before it are skipped.
+ *
+ * @param[in] file_p - mapped file with its first record.
+ *
+ * @return - microseconds since midnight, -1 if file has no timestamp.
+ */
+static int64_t __dlogger_merge_first_timestamp(const DLogger_merge_fileS* file_p);
+
+
+/*
+ * This function anchor all files to one day, so file started after midnight is sorted after files started
+ * before midnight. Keys of first records are calculated.
+ *
+ * @param[in/out] heap_pp - opened files.
+ * @param[in]     size    - number of opened files.
+ *
+ * @return - void.
+ */
+static void __dlogger_merge_anchor(DLogger_merge_fileS** heap_pp, size_t size);
+
+
+/*
+ * This function calculate key of current record: timestamp extended by passed days.
+ *
+ * @param[in/out] file_p - mapped file.
+ *
+ * @return - void.
+ */
+static void __dlogger_merge_update_key(DLogger_merge_fileS* file_p);
+
+
+/*
+ * This function compare current records of two files.
+ *
+ * @param[in] a_p - first file.
+ * @param[in] b_p - second file.
+ *
+ * @return - true if record of @a_p should be written before record of @b_p.
+ */
+static inline bool __dlogger_merge_is_before(const DLogger_merge_fileS* a_p, const DLogger_merge_fileS* b_p);
+
+
+/*
+ * This function restore heap property by moving element down.
+ *
+ * @param[in/out] heap_pp - binary heap of files, the file with the oldest record is on top.
+ * @param[in]     size    - number of files in heap.
+ * @param[in]     index   - index of moved element.
+ *
+ * @return - void.
+ */
+static void __dlogger_merge_sift_down(DLogger_merge_fileS** heap_pp, size_t size, size_t index);
+
+
+/*
+ * This function print usage of tool.
+ *
+ * @param[in] name_p - name of binary.
+ *
+ * @return - void.
+ */
+static void __dlogger_merge_usage(const char* name_p);
+
+
+static void __dlogger_merge_update_key(DLogger_merge_fileS* const file_p)
+{
+    register const int64_t timestamp_usec = file_p->record.timestamp_usec;
+
+    if (timestamp_usec != -1)
+    {
+        if (file_p->last_timestamp_usec != -1 && timestamp_usec + DLOGGER_MERGE_USEC_PER_DAY / 2 < file_p->last_timestamp_usec)
+        {
+            file_p->day_offset_usec += DLOGGER_MERGE_USEC_PER_DAY;
+        }
+
+        file_p->last_timestamp_usec = timestamp_usec;
+        file_p->key_usec = file_p->day_offset_usec + timestamp_usec;
+    }
+}
+
+
+static int64_t __dlogger_merge_first_timestamp(const DLogger_merge_fileS* const file_p)
+{
+    DLogger_log_recordS record = file_p->record;
+
+    while (record.timestamp_usec == -1)
+    {
+        if (record.end_p >= file_p->end_p ||
+            dlogger_log_next_record(file_p->log_p, record.end_p, file_p->end_p, &record) == false)
+        {
+            return -1;
+        }
+    }
+
+    return record.timestamp_usec;
+}
+
+
+static void __dlogger_merge_anchor(DLogger_merge_fileS** const heap_pp, const size_t size)
+{
+    int64_t latest_first_usec = -1;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (heap_pp[i]->first_timestamp_usec > latest_first_usec)
+        {
+            latest_first_usec = heap_pp[i]->first_timestamp_usec;
+        }
+    }
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        DLogger_merge_fileS* const file_p = heap_pp[i];
+
+        if (file_p->first_timestamp_usec != -1 &&
+            file_p->first_timestamp_usec + DLOGGER_MERGE_USEC_PER_DAY / 2 < latest_first_usec)
+        {
+            file_p->day_offset_usec = DLOGGER_MERGE_USEC_PER_DAY;
+        }
+
+        /* Leading records without timestamp are written with the first record of file. */
+        file_p->key_usec = file_p->day_offset_usec + (file_p->first_timestamp_usec != -1 ? file_p->first_timestamp_usec : 0);
+
+        __dlogger_merge_update_key(file_p);
+    }
+}
+
+
+static int __dlogger_merge_open(const char* const path_p, const size_t index, DLogger_merge_fileS* const file_p)
+{
+    const int fd = open(path_p, O_RDONLY);
+
+    if (fd == -1)
+    {
+        perror("dlogger_merge: cannot open log file");
+        return -1;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) == -1)
+    {
+        perror("dlogger_merge: fstat");
+        close(fd);
+        return -1;
+    }
+
+    const size_t file_size = (size_t)file_stat.st_size;
+
+    if (file_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    /* Mapping stays valid after close, so number of files is not limited by descriptors. */
+    const char* const log_p = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (log_p == MAP_FAILED)
+    {
+        perror("dlogger_merge: mmap");
+        return -1;
+    }
+
+    (void)madvise((void*)(uintptr_t)log_p, file_size, MADV_SEQUENTIAL);
+
+    *file_p = (DLogger_merge_fileS){ .log_p = log_p, .end_p = log_p + file_size, .released_p = log_p,
+                                     .file_size = file_size, .key_usec = 0, .day_offset_usec = 0,
+                                     .last_timestamp_usec = -1, .index = index };
+
+    if (dlogger_log_next_record(log_p, log_p, file_p->end_p, &file_p->record) == false)
+    {
+        munmap((void*)(uintptr_t)log_p, file_size);
+        return 0;
+    }
+
+    file_p->first_timestamp_usec = __dlogger_merge_first_timestamp(file_p);
+    file_p->leading_size = (size_t)(file_p->record.begin_p - log_p);
+
+    return 1;
+}
+
+
+static bool __dlogger_merge_next(DLogger_merge_fileS* const file_p)
+{
+    const char* const position_p = file_p->record.end_p;
+
+    /* Pages are read only once, merged ones are dropped to keep memory bounded for big files. */
+    if ((size_t)(position_p - file_p->released_p) >= DLOGGER_MERGE_RELEASE_SIZE)
+    {
+        const uintptr_t page_mask = (uintptr_t)(sysconf(_SC_PAGESIZE) - 1);
+        const char* const release_end_p = (const char*)((uintptr_t)position_p & ~page_mask);
+
+        (void)madvise((void*)(uintptr_t)file_p->released_p, (size_t)(release_end_p - file_p->released_p), MADV_DONTNEED);
+        file_p->released_p = release_end_p;
+    }
+
+    if (position_p >= file_p->end_p ||
+        dlogger_log_next_record(file_p->log_p, position_p, file_p->end_p, &file_p->record) == false)
+    {
+        munmap((void*)(uintptr_t)file_p->log_p, file_p->file_size);
+        return false;
+    }
+
+    __dlogger_merge_update_key(file_p);
+
+    return true;
+}
+
+
+static inline bool __dlogger_merge_is_before(const DLogger_merge_fileS* const a_p, const DLogger_merge_fileS* const b_p)
+{
+    return a_p->key_usec < b_p->key_usec || (a_p->key_usec == b_p->key_usec && a_p->index < b_p->index);
+}
+
+
+static void __dlogger_merge_sift_down(DLogger_merge_fileS** const heap_pp, const size_t size, size_t index)
+{
+    for (;;)
+    {
+        const size_t left = 2 * index + 1;
+        const size_t right = left + 1;
+        size_t smallest = index;
+
+        if (left < size && __dlogger_merge_is_before(heap_pp[left], heap_pp[smallest]))
+        {
+            smallest = left;
+        }
+
+        if (right < size && __dlogger_merge_is_before(heap_pp[right], heap_pp[smallest]))
+        {
+            smallest = right;
+        }
+
+        if (smallest == index)
+        {
+            return;
+        }
+
+        DLogger_merge_fileS* const tmp_p = heap_pp[index];
+        heap_pp[index] = heap_pp[smallest];
+        heap_pp[smallest] = tmp_p;
+        index = smallest;
+    }
+}
+
+
+static void __dlogger_merge_usage(const char* const name_p)
+{
+    fprintf(stderr, "Usage: %s log_file...\n", name_p);
+}
+
+
+int main(const int argc, char* argv[const])
+{
+    if (argc < 2 || strcmp(argv[1], "-h") == 0)
+    {
+        __dlogger_merge_usage(argv[0]);
+        return 1;
+    }
+
+    const size_t number_of_files = (size_t)(argc - 1);
+
+    DLogger_merge_fileS* const files_p = calloc(number_of_files, sizeof(*files_p));
+    DLogger_merge_fileS** const heap_pp = calloc(number_of_files, sizeof(*heap_pp));
+
+    if (files_p == NULL || heap_pp == NULL)
+    {
+        perror("dlogger_merge: calloc");
+        return 1;
+    }
+
+    size_t heap_size = 0;
+    int ret = 0;
+
+    for (size_t i = 0; i < number_of_files; ++i)
+    {
+        const int opened = __dlogger_merge_open(argv[i + 1], i, &files_p[i]);
+
+        if (opened == -1)
+        {
+            ret = 1;
+        }
+        else if (opened == 1)
+        {
+            heap_pp[heap_size++] = &files_p[i];
+        }
+    }
+
+    __dlogger_merge_anchor(heap_pp, heap_size);
+
+    for (size_t i = heap_size / 2; i-- > 0;)
+    {
+        __dlogger_merge_sift_down(heap_pp, heap_size, i);
+    }
+
+    static char output_buffer[1 << 20];
+    setvbuf(stdout, &output_buffer[0], _IOFBF, sizeof(output_buffer));
+
+    while (heap_size > 0)
+    {
+        DLogger_merge_fileS* const file_p = heap_pp[0];
+        const DLogger_log_recordS* const record_p = &file_p->record;
+
+        /* Lines before the first record of file are not record, they go with the first record. */
+        if (file_p->leading_size > 0)
+        {
+            fwrite(file_p->log_p, 1, file_p->leading_size, stdout);
+            file_p->leading_size = 0;
+        }
+
+        fwrite(record_p->begin_p, 1, (size_t)(record_p->end_p - record_p->begin_p), stdout);
+
+        /* The last record of truncated file does not end with new line, next record must start in new line. */
+        if (record_p->end_p[-1] != '\n')
+        {
+            fputc('\n', stdout);
+        }
+
+        if (__dlogger_merge_next(file_p) == false)
+        {
+            heap_pp[0] = heap_pp[--heap_size];
+        }
+
+        __dlogger_merge_sift_down(heap_pp, heap_size, 0);
+    }
+
+    if (fflush(stdout) == EOF)
+    {
+        perror("dlogger_merge: write");
+        ret = 1;
+    }
+
+    free(heap_pp);
+    free(files_p);
+
+    return ret;
+}
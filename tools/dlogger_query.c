@@ -0,0 +1,441 @@
+/*
+    This tool prints records from DLogger log files which match given filters.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Usage:
+    $dlogger_query [-b HH:MM:SS[.frac]] [-e HH:MM:SS[.frac]] [-l level] [-t tid] [-s file[:line]] [-j threads] log_file...
+
+    -b, -e - time window (inclusive), in log crossing midnight it is applied to each day. Logs must be written
+             with DLOGGER_OPTION_MARK_TIMESTAMP.
+    -l     - print only records with given level or more important (e.g. -l error prints FATAL, CRITICAL and ERROR).
+    -t     - print only records of given thread. Logs must be written with DLOGGER_OPTION_MARK_THREADID.
+    -s     - print only records from given place, suffix of "file:line" or "file" (e.g. -s network.c:42).
+    -j     - number of threads, each thread handles whole files (e.g. rotated logs). Default: 1.
+
+    Files are mapped by mmap. Start of time window is found by binary search over timestamps of records, so
+    only part of file inside time window is scanned. Timestamps go back after midnight, so file whose last timestamp
+    is older than the first one is scanned whole. Records are written in order of files from command line.
+    Multi-line records (e.g. backtraces) are printed as whole.
+*/
+
+
+#define _GNU_SOURCE /* memrchr */
+
+#include "common/dlogger_log_parser.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <threads.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+
+
+/*
+ * Threads write records into log with small delay after timestamp has been taken, so records are not perfectly sorted.
+ * Binary search starts earlier and scanning ends later by this slack. Records are filtered exactly anyway.
+ */
+#define DLOGGER_QUERY_TIME_SLACK_USEC       ((int64_t)1000000)
+
+#define DLOGGER_QUERY_MAX_THREADS           64
+
+
+/* Filters passed by user. Field is ignored when it is -1 or NULL. */
+typedef struct DLogger_query_filtersS
+{
+    int64_t begin_usec;
+    int64_t end_usec;
+    int level;
+    long thread_id;
+    const char* location_p;
+} DLogger_query_filtersS;
+
+
+/* Shared state of all worker threads. */
+typedef struct DLogger_query_jobS
+{
+    const DLogger_query_filtersS* filters_p;
+    char* const* files_pp;
+    size_t number_of_files;
+    atomic_size_t next_file;
+    FILE** outputs_pp;          /* one temporary file per log file, printed by main thread in order. */
+    atomic_bool is_failed;
+} DLogger_query_jobS;
+
+
+/*
+ * This function check if record matches all filters.
+ *
+ * @param[in] filters_p - filters passed by user.
+ * @param[in] record_p  - parsed record.
+ *
+ * @return - true if record should be printed, otherwise false.
+ */
+static bool __dlogger_query_match(const DLogger_query_filtersS* filters_p, const DLogger_log_recordS* record_p);
+
+
+/*
+ * This function check if @location_p ends with @pattern_p. Pattern might skip line, then it is compared with
+ * file part of location.
+ *
+ * @param[in] pattern_p     - null-terminated pattern passed by user.
+ * @param[in] location_p    - "file:line" from record.
+ * @param[in] location_size - size of location.
+ *
+ * @return - true if location matches, otherwise false.
+ */
+static bool __dlogger_query_match_location(const char* pattern_p, const char* location_p, size_t location_size);
+
+
+/*
+ * This function map log file and write matched records into @output_p.
+ *
+ * @param[in] filters_p - filters passed by user.
+ * @param[in] path_p    - path to log file.
+ * @param[in] output_p  - output for matched records.
+ *
+ * @return - 0 on success, -1 on failure.
+ */
+static int __dlogger_query_file(const DLogger_query_filtersS* filters_p, const char* path_p, FILE* output_p);
+
+
+/*
+ * This function is main function of worker thread. Worker takes next file until all files are done.
+ *
+ * @param[in] arg_p - DLogger_query_jobS.
+ *
+ * @return - 0.
+ */
+static int __dlogger_query_worker(void* arg_p);
+
+
+/*
+ * This function print usage of tool.
+ *
+ * @param[in] name_p - name of binary.
+ *
+ * @return - void.
+ */
+static void __dlogger_query_usage(const char* name_p);
+
+
+static bool __dlogger_query_match_location(const char* const pattern_p, const char* const location_p, const size_t location_size)
+{
+    const size_t pattern_size = strlen(pattern_p);
+
+    if (pattern_size <= location_size &&
+        memcmp(&location_p[location_size - pattern_size], pattern_p, pattern_size) == 0)
+    {
+        return true;
+    }
+
+    /* Pattern without line, compare with file only. */
+    const char* const colon_p = memrchr(location_p, ':', location_size);
+
+    if (colon_p == NULL)
+    {
+        return false;
+    }
+
+    const size_t file_size = (size_t)(colon_p - location_p);
+
+    return pattern_size <= file_size && memcmp(&location_p[file_size - pattern_size], pattern_p, pattern_size) == 0;
+}
+
+
+static bool __dlogger_query_match(const DLogger_query_filtersS* const filters_p, const DLogger_log_recordS* const record_p)
+{
+    if (filters_p->level != -1 && record_p->level > filters_p->level)
+    {
+        return false;
+    }
+
+    if (filters_p->begin_usec != -1 && (record_p->timestamp_usec == -1 || record_p->timestamp_usec < filters_p->begin_usec))
+    {
+        return false;
+    }
+
+    if (filters_p->end_usec != -1 && (record_p->timestamp_usec == -1 || record_p->timestamp_usec > filters_p->end_usec))
+    {
+        return false;
+    }
+
+    if (filters_p->thread_id != -1 && record_p->thread_id != filters_p->thread_id)
+    {
+        return false;
+    }
+
+    if (filters_p->location_p != NULL &&
+        (record_p->location_p == NULL ||
+         __dlogger_query_match_location(filters_p->location_p, record_p->location_p, record_p->location_size) == false))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+
+static int __dlogger_query_file(const DLogger_query_filtersS* const filters_p, const char* const path_p, FILE* const output_p)
+{
+    const int fd = open(path_p, O_RDONLY);
+
+    if (fd == -1)
+    {
+        perror("dlogger_query: cannot open log file");
+        return -1;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) == -1)
+    {
+        perror("dlogger_query: fstat");
+        close(fd);
+        return -1;
+    }
+
+    const size_t file_size = (size_t)file_stat.st_size;
+
+    if (file_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    const char* const log_p = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (log_p == MAP_FAILED)
+    {
+        perror("dlogger_query: mmap");
+        return -1;
+    }
+
+    const char* const end_p = log_p + file_size;
+    const char* position_p = log_p;
+
+    /* Log crossing midnight is not sorted by time, then time window is checked for each record of whole file. */
+    const bool is_one_day = dlogger_log_is_one_day(log_p, end_p, DLOGGER_QUERY_TIME_SLACK_USEC);
+
+    if (filters_p->begin_usec != -1 && is_one_day == true)
+    {
+        position_p = dlogger_log_lower_bound(log_p, end_p, filters_p->begin_usec - DLOGGER_QUERY_TIME_SLACK_USEC);
+    }
+
+    /* Rest of file is read once from begin to end, kernel can read ahead. */
+    (void)madvise((void*)((uintptr_t)position_p & ~(uintptr_t)(sysconf(_SC_PAGESIZE) - 1)),
+                  (size_t)(end_p - position_p), MADV_SEQUENTIAL);
+
+    DLogger_log_recordS record;
+
+    while (position_p < end_p && dlogger_log_next_record(log_p, position_p, end_p, &record) == true)
+    {
+        if (filters_p->end_usec != -1 && is_one_day == true &&
+            record.timestamp_usec > filters_p->end_usec + DLOGGER_QUERY_TIME_SLACK_USEC)
+        {
+            break;
+        }
+
+        if (__dlogger_query_match(filters_p, &record) == true)
+        {
+            fwrite(record.begin_p, 1, (size_t)(record.end_p - record.begin_p), output_p);
+        }
+
+        position_p = record.end_p;
+    }
+
+    munmap((void*)(uintptr_t)log_p, file_size);
+
+    return 0;
+}
+
+
+static int __dlogger_query_worker(void* const arg_p)
+{
+    DLogger_query_jobS* const job_p = arg_p;
+
+    for (size_t i = atomic_fetch_add(&job_p->next_file, 1); i < job_p->number_of_files; i = atomic_fetch_add(&job_p->next_file, 1))
+    {
+        if (__dlogger_query_file(job_p->filters_p, job_p->files_pp[i], job_p->outputs_pp[i]) == -1)
+        {
+            atomic_store(&job_p->is_failed, true);
+        }
+    }
+
+    return 0;
+}
+
+
+static void __dlogger_query_usage(const char* const name_p)
+{
+    fprintf(stderr, "Usage: %s [-b HH:MM:SS[.frac]] [-e HH:MM:SS[.frac]] [-l level] [-t tid] [-s file[:line]] [-j threads] "
+                    "log_file...\n", name_p);
+}
+
+
+int main(const int argc, char* argv[const])
+{
+    DLogger_query_filtersS filters = { .begin_usec = -1, .end_usec = -1, .level = -1, .thread_id = -1, .location_p = NULL };
+    long number_of_threads = 1;
+    int option = 0;
+
+    while ((option = getopt(argc, argv, "b:e:l:t:s:j:h")) != -1)
+    {
+        char* end_p = NULL;
+
+        switch (option)
+        {
+            case 'b':
+            {
+                if (dlogger_log_parse_time(optarg, &filters.begin_usec) == false)
+                {
+                    fprintf(stderr, "dlogger_query: wrong time: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'e':
+            {
+                if (dlogger_log_parse_time(optarg, &filters.end_usec) == false)
+                {
+                    fprintf(stderr, "dlogger_query: wrong time: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'l':
+            {
+                filters.level = dlogger_log_parse_level(optarg);
+
+                if (filters.level == -1)
+                {
+                    fprintf(stderr, "dlogger_query: wrong level: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 't':
+            {
+                filters.thread_id = strtol(optarg, &end_p, 10);
+
+                if (*optarg == '\0' || *end_p != '\0' || filters.thread_id < 0)
+                {
+                    fprintf(stderr, "dlogger_query: wrong thread id: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 's':
+            {
+                filters.location_p = optarg;
+                break;
+            }
+            case 'j':
+            {
+                number_of_threads = strtol(optarg, &end_p, 10);
+
+                if (*optarg == '\0' || *end_p != '\0' || number_of_threads < 1 || number_of_threads > DLOGGER_QUERY_MAX_THREADS)
+                {
+                    fprintf(stderr, "dlogger_query: number of threads must be in range [1, %d]\n", DLOGGER_QUERY_MAX_THREADS);
+                    return 1;
+                }
+                break;
+            }
+            default:
+            {
+                __dlogger_query_usage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (optind >= argc)
+    {
+        __dlogger_query_usage(argv[0]);
+        return 1;
+    }
+
+    const size_t number_of_files = (size_t)(argc - optind);
+
+    if ((size_t)number_of_threads > number_of_files)
+    {
+        number_of_threads = (long)number_of_files;
+    }
+
+    FILE** const outputs_pp = calloc(number_of_files, sizeof(*outputs_pp));
+
+    if (outputs_pp == NULL)
+    {
+        perror("dlogger_query: calloc");
+        return 1;
+    }
+
+    /* Single thread writes directly to stdout, otherwise each file has own temporary output to keep order. */
+    for (size_t i = 0; i < number_of_files; ++i)
+    {
+        outputs_pp[i] = (number_of_threads == 1) ? stdout : tmpfile();
+
+        if (outputs_pp[i] == NULL)
+        {
+            perror("dlogger_query: tmpfile");
+            return 1;
+        }
+    }
+
+    DLogger_query_jobS job = { .filters_p = &filters, .files_pp = &argv[optind], .number_of_files = number_of_files,
+                               .outputs_pp = outputs_pp };
+    atomic_init(&job.next_file, 0);
+    atomic_init(&job.is_failed, false);
+
+    thrd_t threads[DLOGGER_QUERY_MAX_THREADS];
+
+    for (long i = 1; i < number_of_threads; ++i)
+    {
+        if (thrd_create(&threads[i], __dlogger_query_worker, &job) != thrd_success)
+        {
+            fprintf(stderr, "dlogger_query: cannot create thread\n");
+            return 1;
+        }
+    }
+
+    /* Main thread is also worker. */
+    __dlogger_query_worker(&job);
+
+    for (long i = 1; i < number_of_threads; ++i)
+    {
+        thrd_join(threads[i], NULL);
+    }
+
+    if (number_of_threads > 1)
+    {
+        char buffer[1 << 16];
+
+        for (size_t i = 0; i < number_of_files; ++i)
+        {
+            size_t read_bytes = 0;
+
+            rewind(outputs_pp[i]);
+
+            while ((read_bytes = fread(&buffer[0], 1, sizeof(buffer), outputs_pp[i])) > 0)
+            {
+                fwrite(&buffer[0], 1, read_bytes, stdout);
+            }
+
+            fclose(outputs_pp[i]);
+        }
+    }
+
+    free(outputs_pp);
+
+    return atomic_load(&job.is_failed) ? 1 : 0;
+}
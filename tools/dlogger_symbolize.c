@@ -0,0 +1,482 @@
+/*
+    This tool resolves raw backtraces saved by DLogger with DLOGGER_OPTION_MARK_RAW_BACKTRACE.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Usage:
+    $dlogger_symbolize [log_file] > symbolized.log
+
+    Log is read from @log_file or from standard input. Lines after "Modules:" describe loaded modules
+    (load bias, address range, build ID, path). Each address after "Raw backtrace:" is replaced by
+    line in the same format like backtrace_symbols: path(symbol+offset) [address]. Symbols are taken
+    from ELF symbol table (.symtab, or .dynsym if binary is stripped), so -rdynamic is not needed.
+*/
+
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <elf.h>
+
+
+/* Function symbol from ELF symbol table. */
+typedef struct DLogger_symbolS
+{
+    uint64_t address;
+    uint64_t size;
+    const char* name_p;
+} DLogger_symbolS;
+
+
+/* Module described in "Modules:" section of log. Symbols are loaded at first use. */
+typedef struct DLogger_moduleS
+{
+    uint64_t load_bias;
+    uint64_t first_address;
+    uint64_t last_address;
+    char build_id[2 * 64 + 1];
+    char path[4096];
+
+    bool is_loaded;          /* has been ELF file already opened? */
+    bool is_usable;          /* ELF file exists, build ID match and symbols are available. */
+    void* file_p;            /* mmap of ELF file, symbol names point into it. */
+    size_t file_size;
+    DLogger_symbolS* symbols_p;
+    size_t number_of_symbols;
+} DLogger_moduleS;
+
+
+typedef struct DLogger_modulesS
+{
+    DLogger_moduleS* modules_p;
+    size_t number_of_modules;
+    size_t capacity;
+} DLogger_modulesS;
+
+
+/*
+ * This function parse one line from "Modules:" section and add module into @modules_p.
+ *
+ * @param[in/out] modules_p - list of modules.
+ * @param[in]     line_p    - line from log.
+ *
+ * @return - true if line describes module, otherwise false.
+ */
+static bool __dlogger_parse_module(DLogger_modulesS* modules_p, const char* line_p);
+
+
+/*
+ * This function release all modules from @modules_p.
+ *
+ * @param[in/out] modules_p - list of modules.
+ *
+ * @return - void.
+ */
+static void __dlogger_clear_modules(DLogger_modulesS* modules_p);
+
+
+/*
+ * This function read build ID from notes of ELF file.
+ *
+ * @param[in]  ehdr_p    - pointer to mapped ELF file.
+ * @param[in]  file_size - size of mapped ELF file.
+ * @param[out] build_id  - build ID as hex string, "-" if not found.
+ *
+ * @return - void.
+ */
+static void __dlogger_read_build_id(const Elf64_Ehdr* ehdr_p, size_t file_size, char build_id[static 2 * 64 + 1]);
+
+
+/*
+ * This function open ELF file of module, check build ID and load function symbols sorted by address.
+ *
+ * @param[in/out] module_p - module to load.
+ *
+ * @return - void. On failure module is marked as not usable.
+ */
+static void __dlogger_load_module(DLogger_moduleS* module_p);
+
+
+/*
+ * This function compare symbols by address, used by qsort.
+ *
+ * @param[in] lhs_p - pointer to first symbol.
+ * @param[in] rhs_p - pointer to second symbol.
+ *
+ * @return - negative, zero or positive value like strcmp.
+ */
+static int __dlogger_compare_symbols(const void* lhs_p, const void* rhs_p);
+
+
+/*
+ * This function print symbolized address in format of backtrace_symbols.
+ *
+ * @param[in/out] modules_p - list of modules, modules are loaded at first use.
+ * @param[in]     address   - return address from raw backtrace.
+ *
+ * @return - void.
+ */
+static void __dlogger_print_symbolized(DLogger_modulesS* modules_p, uint64_t address);
+
+
+static bool __dlogger_parse_module(DLogger_modulesS* const modules_p, const char* const line_p)
+{
+    DLogger_moduleS module = {0};
+
+    if (sscanf(line_p, "%lx %lx-%lx %128s %4095[^\n]", &module.load_bias, &module.first_address, &module.last_address,
+               &module.build_id[0], &module.path[0]) != 5)
+    {
+        return false;
+    }
+
+    if (modules_p->number_of_modules == modules_p->capacity)
+    {
+        register const size_t new_capacity = (modules_p->capacity == 0) ? 16 : 2 * modules_p->capacity;
+        DLogger_moduleS* const new_modules_p = realloc(modules_p->modules_p, new_capacity * sizeof(*new_modules_p));
+
+        if (new_modules_p == NULL)
+        {
+            perror("dlogger_symbolize: realloc error");
+            return false;
+        }
+
+        modules_p->modules_p = new_modules_p;
+        modules_p->capacity = new_capacity;
+    }
+
+    modules_p->modules_p[modules_p->number_of_modules++] = module;
+
+    return true;
+}
+
+
+static void __dlogger_clear_modules(DLogger_modulesS* const modules_p)
+{
+    for (size_t i = 0; i < modules_p->number_of_modules; ++i)
+    {
+        DLogger_moduleS* const module_p = &modules_p->modules_p[i];
+
+        if (module_p->file_p != NULL)
+        {
+            munmap(module_p->file_p, module_p->file_size);
+        }
+
+        free(module_p->symbols_p);
+    }
+
+    modules_p->number_of_modules = 0;
+}
+
+
+static void __dlogger_read_build_id(const Elf64_Ehdr* const ehdr_p, const size_t file_size, char build_id[const static 2 * 64 + 1])
+{
+    const unsigned char* const file_p = (const unsigned char*)ehdr_p;
+
+    build_id[0] = '-';
+    build_id[1] = '\0';
+
+    for (size_t i = 0; i < ehdr_p->e_phnum; ++i)
+    {
+        const Elf64_Phdr* const phdr_p = (const Elf64_Phdr*)(const void*)(file_p + ehdr_p->e_phoff + i * ehdr_p->e_phentsize);
+
+        if (phdr_p->p_type != PT_NOTE || phdr_p->p_offset + phdr_p->p_filesz > file_size)
+        {
+            continue;
+        }
+
+        /* Notes are aligned to 4 bytes, build ID is note with name "GNU" and type NT_GNU_BUILD_ID. */
+        const unsigned char* note_p = file_p + phdr_p->p_offset;
+        const unsigned char* const note_end_p = note_p + phdr_p->p_filesz;
+
+        while (note_p + sizeof(Elf64_Nhdr) <= note_end_p)
+        {
+            const Elf64_Nhdr* const nhdr_p = (const Elf64_Nhdr*)(const void*)note_p;
+            const unsigned char* const name_p = note_p + sizeof(*nhdr_p);
+            const unsigned char* const desc_p = name_p + ((nhdr_p->n_namesz + 3) & ~3U);
+
+            if (nhdr_p->n_type == NT_GNU_BUILD_ID && nhdr_p->n_namesz == 4 && memcmp(name_p, "GNU", 4) == 0)
+            {
+                for (size_t j = 0; j < nhdr_p->n_descsz && j < 64; ++j)
+                {
+                    snprintf(&build_id[2 * j], 2 * 64 + 1 - 2 * j, "%02x", desc_p[j]);
+                }
+
+                return;
+            }
+
+            note_p = desc_p + ((nhdr_p->n_descsz + 3) & ~3U);
+        }
+    }
+}
+
+
+static int __dlogger_compare_symbols(const void* const lhs_p, const void* const rhs_p)
+{
+    const DLogger_symbolS* const lhs_symbol_p = lhs_p;
+    const DLogger_symbolS* const rhs_symbol_p = rhs_p;
+
+    return (lhs_symbol_p->address > rhs_symbol_p->address) - (lhs_symbol_p->address < rhs_symbol_p->address);
+}
+
+
+static void __dlogger_load_module(DLogger_moduleS* const module_p)
+{
+    module_p->is_loaded = true;
+
+    register const int fd = open(&module_p->path[0], O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1)
+    {
+        return;
+    }
+
+    struct stat file_stat = {0};
+
+    if (fstat(fd, &file_stat) == -1 || (size_t)file_stat.st_size < sizeof(Elf64_Ehdr))
+    {
+        close(fd);
+        return;
+    }
+
+    module_p->file_size = (size_t)file_stat.st_size;
+    void* const file_p = mmap(NULL, module_p->file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (file_p == MAP_FAILED)
+    {
+        perror("dlogger_symbolize: mmap error");
+        return;
+    }
+
+    module_p->file_p = file_p;
+
+    const Elf64_Ehdr* const ehdr_p = file_p;
+
+    if (memcmp(&ehdr_p->e_ident[0], ELFMAG, SELFMAG) != 0 || ehdr_p->e_ident[EI_CLASS] != ELFCLASS64 ||
+        ehdr_p->e_shoff + (size_t)ehdr_p->e_shnum * ehdr_p->e_shentsize > module_p->file_size ||
+        ehdr_p->e_phoff + (size_t)ehdr_p->e_phnum * ehdr_p->e_phentsize > module_p->file_size)
+    {
+        fprintf(stderr, "dlogger_symbolize: %s is not supported ELF64 file\n", &module_p->path[0]);
+        return;
+    }
+
+    char build_id[2 * 64 + 1];
+    __dlogger_read_build_id(ehdr_p, module_p->file_size, &build_id[0]);
+
+    if (strcmp(&build_id[0], &module_p->build_id[0]) != 0)
+    {
+        fprintf(stderr, "dlogger_symbolize: build ID of %s (%s) does not match log (%s)\n",
+                &module_p->path[0], &build_id[0], &module_p->build_id[0]);
+        return;
+    }
+
+    const unsigned char* const bytes_p = file_p;
+    const Elf64_Shdr* const shdrs_p = (const Elf64_Shdr*)(const void*)(bytes_p + ehdr_p->e_shoff);
+    const Elf64_Shdr* symtab_p = NULL;
+
+    /* Prefer full symbol table, stripped binaries have only dynamic symbols. */
+    for (size_t i = 0; i < ehdr_p->e_shnum; ++i)
+    {
+        if (shdrs_p[i].sh_type == SHT_SYMTAB || (shdrs_p[i].sh_type == SHT_DYNSYM && symtab_p == NULL))
+        {
+            symtab_p = &shdrs_p[i];
+        }
+    }
+
+    if (symtab_p == NULL || symtab_p->sh_link >= ehdr_p->e_shnum ||
+        symtab_p->sh_offset + symtab_p->sh_size > module_p->file_size ||
+        shdrs_p[symtab_p->sh_link].sh_offset + shdrs_p[symtab_p->sh_link].sh_size > module_p->file_size)
+    {
+        return;
+    }
+
+    const Elf64_Sym* const syms_p = (const Elf64_Sym*)(const void*)(bytes_p + symtab_p->sh_offset);
+    const char* const strtab_p = (const char*)(bytes_p + shdrs_p[symtab_p->sh_link].sh_offset);
+    register const size_t strtab_size = shdrs_p[symtab_p->sh_link].sh_size;
+    register const size_t number_of_syms = symtab_p->sh_size / sizeof(Elf64_Sym);
+
+    module_p->symbols_p = calloc(number_of_syms + 1, sizeof(*module_p->symbols_p));
+
+    if (module_p->symbols_p == NULL)
+    {
+        perror("dlogger_symbolize: calloc error");
+        return;
+    }
+
+    for (size_t i = 0; i < number_of_syms; ++i)
+    {
+        if (ELF64_ST_TYPE(syms_p[i].st_info) != STT_FUNC || syms_p[i].st_value == 0 || syms_p[i].st_name >= strtab_size)
+        {
+            continue;
+        }
+
+        module_p->symbols_p[module_p->number_of_symbols++] = (DLogger_symbolS){
+            .address = syms_p[i].st_value,
+            .size = syms_p[i].st_size,
+            .name_p = &strtab_p[syms_p[i].st_name],
+        };
+    }
+
+    qsort(module_p->symbols_p, module_p->number_of_symbols, sizeof(*module_p->symbols_p), __dlogger_compare_symbols);
+
+    module_p->is_usable = true;
+}
+
+
+static void __dlogger_print_symbolized(DLogger_modulesS* const modules_p, const uint64_t address)
+{
+    DLogger_moduleS* module_p = NULL;
+
+    for (size_t i = 0; i < modules_p->number_of_modules; ++i)
+    {
+        if (address >= modules_p->modules_p[i].first_address && address < modules_p->modules_p[i].last_address)
+        {
+            module_p = &modules_p->modules_p[i];
+        }
+    }
+
+    if (module_p == NULL)
+    {
+        printf("?? [%#lx]\n", address);
+        return;
+    }
+
+    if (module_p->is_loaded == false)
+    {
+        __dlogger_load_module(module_p);
+    }
+
+    register const uint64_t offset = address - module_p->load_bias;
+
+    if (module_p->is_usable == false || module_p->number_of_symbols == 0)
+    {
+        printf("%s(+%#lx) [%#lx]\n", &module_p->path[0], offset, address);
+        return;
+    }
+
+    /* Return address points after call instruction, so use previous byte to find caller for tail of function. */
+    register const uint64_t lookup_address = offset - 1;
+
+    register size_t low = 0;
+    register size_t high = module_p->number_of_symbols;
+
+    /* Find last symbol with address <= lookup_address. */
+    while (low < high)
+    {
+        register const size_t middle = low + (high - low) / 2;
+
+        if (module_p->symbols_p[middle].address <= lookup_address)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (low == 0)
+    {
+        printf("%s(+%#lx) [%#lx]\n", &module_p->path[0], offset, address);
+        return;
+    }
+
+    const DLogger_symbolS* const symbol_p = &module_p->symbols_p[low - 1];
+
+    if (symbol_p->size != 0 && lookup_address >= symbol_p->address + symbol_p->size)
+    {
+        printf("%s(+%#lx) [%#lx]\n", &module_p->path[0], offset, address);
+        return;
+    }
+
+    printf("%s(%s+%#lx) [%#lx]\n", &module_p->path[0], symbol_p->name_p, offset - symbol_p->address, address);
+}
+
+
+int main(const int argc, char* argv[const])
+{
+    FILE* input_p = stdin;
+
+    if (argc > 2)
+    {
+        fprintf(stderr, "Usage: %s [log_file]\n", argv[0]);
+        return 1;
+    }
+
+    if (argc == 2)
+    {
+        input_p = fopen(argv[1], "r");
+
+        if (input_p == NULL)
+        {
+            perror("dlogger_symbolize: cannot open log file");
+            return 1;
+        }
+    }
+
+    enum { SECTION_NONE, SECTION_MODULES, SECTION_RAW_BACKTRACE } section = SECTION_NONE;
+
+    DLogger_modulesS modules = {0};
+    char* line_p = NULL;
+    size_t line_capacity = 0;
+    ssize_t line_length = 0;
+
+    while ((line_length = getline(&line_p, &line_capacity, input_p)) != -1)
+    {
+        if (strcmp(line_p, "Modules:\n") == 0)
+        {
+            /* New run of application, previous modules are not valid anymore. */
+            __dlogger_clear_modules(&modules);
+            section = SECTION_MODULES;
+            fputs(line_p, stdout);
+            continue;
+        }
+
+        if (strcmp(line_p, "Raw backtrace:\n") == 0)
+        {
+            section = SECTION_RAW_BACKTRACE;
+            fputs("Backtrace:\n", stdout);
+            continue;
+        }
+
+        if (section == SECTION_MODULES && __dlogger_parse_module(&modules, line_p) == true)
+        {
+            fputs(line_p, stdout);
+            continue;
+        }
+
+        uint64_t address = 0;
+        char rest = '\0';
+
+        if (section == SECTION_RAW_BACKTRACE && sscanf(line_p, "0x%lx%c", &address, &rest) == 2 && rest == '\n')
+        {
+            __dlogger_print_symbolized(&modules, address);
+            continue;
+        }
+
+        section = SECTION_NONE;
+        fputs(line_p, stdout);
+    }
+
+    free(line_p);
+    __dlogger_clear_modules(&modules);
+    free(modules.modules_p);
+
+    if (input_p != stdin)
+    {
+        fclose(input_p);
+    }
+
+    return 0;
+}
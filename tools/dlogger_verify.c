@@ -0,0 +1,317 @@
+/*
+    This tool validates DLogger log files written with DLOGGER_OPTION_MARK_FRAMED.
+
+
+    Author: Kamil Kielbasa
+    Email: kamilkielbasa64@gmail.com
+    License: GPL3
+
+
+    Usage:
+    $dlogger_verify [-p] [-t] log_file_or_directory...
+
+    -p - print text of valid records to stdout (e.g. for dlogger_query or dlogger_merge). Summary goes to stderr.
+    -t - truncate torn tail of file (incomplete or corrupted frames after last valid frame).
+
+    For each file summary is printed: number of valid frames, corrupted regions in the middle of file and torn
+    tail. Directory is validated file by file (not recursively). Files are mapped by mmap and validated
+    sequentially, CRC32C uses instruction of CPU if available. Corrupted frame is skipped by search of next
+    frame with correct header. Exit status is 0 only if all files are valid.
+*/
+
+
+#include <dlogger/dlogger_frame.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdio.h>
+#include <fcntl.h>
+
+
+/* Options passed by user. */
+typedef struct DLogger_verify_optionsS
+{
+    bool is_printing;    /* print payloads of valid frames. */
+    bool is_truncating;  /* truncate torn tail. */
+} DLogger_verify_optionsS;
+
+
+/* Result of validation of one file. */
+typedef struct DLogger_verify_resultS
+{
+    size_t number_of_frames;
+    uint64_t last_sequence;
+    size_t corrupted_regions;
+    size_t corrupted_bytes;
+    size_t valid_size;         /* offset of end of last valid frame. */
+    size_t torn_bytes;         /* size of data after last valid frame. */
+} DLogger_verify_resultS;
+
+
+/*
+ * This function validate frames of mapped file.
+ *
+ * @param[in]  log_p     - first byte of file.
+ * @param[in]  size      - size of file.
+ * @param[in]  options_p - options passed by user.
+ * @param[out] result_p  - result of validation.
+ *
+ * @return - void.
+ */
+static void __dlogger_verify_frames(const char* log_p, size_t size, const DLogger_verify_optionsS* options_p,
+                                    DLogger_verify_resultS* result_p);
+
+
+/*
+ * This function validate one file and print summary.
+ *
+ * @param[in] path_p    - path to log file.
+ * @param[in] options_p - options passed by user.
+ *
+ * @return - 0 if file is valid, 1 if file is corrupted or cannot be read.
+ */
+static int __dlogger_verify_file(const char* path_p, const DLogger_verify_optionsS* options_p);
+
+
+/*
+ * This function validate all regular files of directory in alphabetical order.
+ *
+ * @param[in] path_p    - path to directory.
+ * @param[in] options_p - options passed by user.
+ *
+ * @return - 0 if all files are valid, otherwise 1.
+ */
+static int __dlogger_verify_directory(const char* path_p, const DLogger_verify_optionsS* options_p);
+
+
+/*
+ * This function print usage of tool.
+ *
+ * @param[in] name_p - name of binary.
+ *
+ * @return - void.
+ */
+static void __dlogger_verify_usage(const char* name_p);
+
+
+static void __dlogger_verify_frames(const char* const log_p, const size_t size, const DLogger_verify_optionsS* const options_p,
+                                    DLogger_verify_resultS* const result_p)
+{
+    const char* const end_p = log_p + size;
+    const char* position_p = log_p;
+
+    for (;;)
+    {
+        DLogger_frame_headerS header;
+        const char* payload_p = NULL;
+
+        register const DLogger_frame_statusE status = dlogger_frame_read(position_p, end_p, &header, &payload_p);
+
+        if (status == DLOGGER_FRAME_VALID)
+        {
+            if (options_p->is_printing == true)
+            {
+                fwrite(payload_p, 1, header.length, stdout);
+            }
+
+            ++result_p->number_of_frames;
+            result_p->last_sequence = header.sequence;
+
+            position_p = payload_p + header.length;
+            result_p->valid_size = (size_t)(position_p - log_p);
+            continue;
+        }
+
+        if (status == DLOGGER_FRAME_CORRUPTED)
+        {
+            const char* const next_p = dlogger_frame_resync(position_p + 1, end_p);
+
+            /* Valid frame after corrupted one means damage in the middle, not torn tail. */
+            if (next_p != end_p)
+            {
+                ++result_p->corrupted_regions;
+                result_p->corrupted_bytes += (size_t)(next_p - position_p);
+                position_p = next_p;
+                continue;
+            }
+        }
+
+        result_p->torn_bytes = (size_t)(end_p - position_p);
+        return;
+    }
+}
+
+
+static int __dlogger_verify_file(const char* const path_p, const DLogger_verify_optionsS* const options_p)
+{
+    const int fd = open(path_p, options_p->is_truncating == true ? O_RDWR : O_RDONLY);
+
+    if (fd == -1)
+    {
+        perror("dlogger_verify: cannot open log file");
+        return 1;
+    }
+
+    struct stat file_stat;
+
+    if (fstat(fd, &file_stat) == -1)
+    {
+        perror("dlogger_verify: fstat");
+        close(fd);
+        return 1;
+    }
+
+    const size_t file_size = (size_t)file_stat.st_size;
+    DLogger_verify_resultS result = {0};
+
+    if (file_size > 0)
+    {
+        const char* const log_p = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (log_p == MAP_FAILED)
+        {
+            perror("dlogger_verify: mmap");
+            close(fd);
+            return 1;
+        }
+
+        (void)madvise((void*)(uintptr_t)log_p, file_size, MADV_SEQUENTIAL);
+
+        __dlogger_verify_frames(log_p, file_size, options_p, &result);
+
+        munmap((void*)(uintptr_t)log_p, file_size);
+    }
+
+    FILE* const summary_p = (options_p->is_printing == true) ? stderr : stdout;
+
+    fprintf(summary_p, "%s: %zu frames, last sequence %" PRIu64 ", %zu corrupted regions (%zu bytes), torn tail %zu bytes",
+            path_p, result.number_of_frames, result.last_sequence, result.corrupted_regions, result.corrupted_bytes,
+            result.torn_bytes);
+
+    if (result.torn_bytes > 0 && options_p->is_truncating == true)
+    {
+        if (ftruncate(fd, (off_t)result.valid_size) == -1)
+        {
+            fputc('\n', summary_p);
+            perror("dlogger_verify: cannot truncate file");
+            close(fd);
+            return 1;
+        }
+
+        fprintf(summary_p, " (truncated)");
+        result.torn_bytes = 0;
+    }
+
+    fputc('\n', summary_p);
+    close(fd);
+
+    return (result.corrupted_regions > 0 || result.torn_bytes > 0) ? 1 : 0;
+}
+
+
+static int __dlogger_verify_directory(const char* const path_p, const DLogger_verify_optionsS* const options_p)
+{
+    struct dirent** entries_pp = NULL;
+    const int number_of_entries = scandir(path_p, &entries_pp, NULL, alphasort);
+
+    if (number_of_entries == -1)
+    {
+        perror("dlogger_verify: cannot read directory");
+        return 1;
+    }
+
+    int ret = 0;
+
+    for (int i = 0; i < number_of_entries; ++i)
+    {
+        char file_path[PATH_MAX];
+        struct stat file_stat;
+
+        if (snprintf(&file_path[0], sizeof(file_path), "%s/%s", path_p, entries_pp[i]->d_name) < (int)sizeof(file_path) &&
+            stat(&file_path[0], &file_stat) == 0 && S_ISREG(file_stat.st_mode))
+        {
+            ret |= __dlogger_verify_file(&file_path[0], options_p);
+        }
+
+        free(entries_pp[i]);
+    }
+
+    free(entries_pp);
+
+    return ret;
+}
+
+
+static void __dlogger_verify_usage(const char* const name_p)
+{
+    fprintf(stderr, "Usage: %s [-p] [-t] log_file_or_directory...\n", name_p);
+}
+
+
+int main(const int argc, char* argv[const])
+{
+    DLogger_verify_optionsS options = { .is_printing = false, .is_truncating = false };
+    int option = 0;
+
+    while ((option = getopt(argc, argv, "pth")) != -1)
+    {
+        switch (option)
+        {
+            case 'p':
+            {
+                options.is_printing = true;
+                break;
+            }
+            case 't':
+            {
+                options.is_truncating = true;
+                break;
+            }
+            default:
+            {
+                __dlogger_verify_usage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+    if (optind >= argc)
+    {
+        __dlogger_verify_usage(argv[0]);
+        return 1;
+    }
+
+    static char output_buffer[1 << 20];
+    setvbuf(stdout, &output_buffer[0], _IOFBF, sizeof(output_buffer));
+
+    int ret = 0;
+
+    for (int i = optind; i < argc; ++i)
+    {
+        struct stat path_stat;
+
+        if (stat(argv[i], &path_stat) == 0 && S_ISDIR(path_stat.st_mode))
+        {
+            ret |= __dlogger_verify_directory(argv[i], &options);
+        }
+        else
+        {
+            ret |= __dlogger_verify_file(argv[i], &options);
+        }
+    }
+
+    if (fflush(stdout) == EOF)
+    {
+        perror("dlogger_verify: write");
+        ret = 1;
+    }
+
+    return ret;
+}